@@ -0,0 +1,519 @@
+/*
+ *  su_bson.cpp
+ *  sutils
+ *
+ *  Created by Sandy Martel on 2026/10/18.
+ *  Copyright (c) 2026年 Sandy Martel. All rights reserved.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software for any
+ * purpose is hereby granted without fee. The sotware is provided "AS-IS" and
+ * without warranty of any kind, express, implied or otherwise.
+ */
+
+#include "su_bson.h"
+#include "su_endian.h"
+#include <ciso646>
+#include <cstring>
+#include <charconv>
+#include <limits>
+
+namespace {
+
+const int max_depth = 200;
+
+enum : uint8_t
+{
+	kDouble = 0x01,
+	kString = 0x02,
+	kDocument = 0x03,
+	kArray = 0x04,
+	kBinary = 0x05,
+	kUndefined = 0x06,
+	kObjectId = 0x07,
+	kBool = 0x08,
+	kDateTime = 0x09,
+	kNull = 0x0A,
+	kRegex = 0x0B,
+	kDBPointer = 0x0C,
+	kCode = 0x0D,
+	kSymbol = 0x0E,
+	kCodeWithScope = 0x0F,
+	kInt32 = 0x10,
+	kTimestamp = 0x11,
+	kInt64 = 0x12,
+	kDecimal128 = 0x13,
+	kMinKey = 0xFF,
+	kMaxKey = 0x7F
+};
+
+template<typename T>
+T get( const char *i_ptr )
+{
+	T v;
+	std::memcpy( &v, i_ptr, sizeof( T ) );
+	return su::little_to_native( v );
+}
+
+/* value_size(type, ptr, end)
+ *
+ * Size of the value of type starting at ptr, using its length prefix when it
+ * has one, npos if it goes past end or is invalid.
+ */
+size_t value_size( uint8_t i_type, const char *i_ptr, const char *i_end )
+{
+	const size_t npos = std::string::npos;
+	size_t avail = i_end - i_ptr;
+	size_t size = npos;
+	auto prefixed = [&]( size_t i_extra, int32_t i_min ) {
+		if ( avail < 4 )
+			return npos;
+		auto len = get<int32_t>( i_ptr );
+		return len < i_min ? npos : 4 + i_extra + size_t( len );
+	};
+	auto cstring = [&]( const char *p ) {
+		auto z = static_cast<const char *>( std::memchr( p, 0, i_end - p ) );
+		return z == nullptr ? nullptr : z + 1;
+	};
+	switch ( i_type )
+	{
+		case kUndefined:
+		case kNull:
+		case kMinKey:
+		case kMaxKey:
+			size = 0;
+			break;
+		case kBool:
+			size = 1;
+			break;
+		case kInt32:
+			size = 4;
+			break;
+		case kDouble:
+		case kDateTime:
+		case kTimestamp:
+		case kInt64:
+			size = 8;
+			break;
+		case kObjectId:
+			size = 12;
+			break;
+		case kDecimal128:
+			size = 16;
+			break;
+		case kString:
+		case kCode:
+		case kSymbol:
+			size = prefixed( 0, 1 );
+			break;
+		case kDBPointer:
+			size = prefixed( 12, 1 );
+			break;
+		case kBinary:
+			size = prefixed( 1, 0 );
+			break;
+		case kDocument:
+		case kArray:
+		case kCodeWithScope:
+			size = prefixed( 0, 5 );
+			if ( size != npos )
+				size -= 4; // the length counts itself
+			break;
+		case kRegex:
+		{
+			auto p = cstring( i_ptr );
+			if ( p != nullptr )
+				p = cstring( p );
+			if ( p != nullptr )
+				size = p - i_ptr;
+			break;
+		}
+	}
+	return size <= avail ? size : npos;
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Writing
+ */
+
+class Writer
+{
+public:
+	Writer( std::string &o_buffer ) : _out( o_buffer ) {}
+
+	void write_document( const su::Json::object &i_items );
+
+private:
+	std::string &_out;
+
+	template<typename T>
+	void put( T i_value )
+	{
+		i_value = su::native_to_little( i_value );
+		_out.append( reinterpret_cast<const char *>( &i_value ), sizeof( T ) );
+	}
+
+	size_t start_document();
+	void end_document( size_t i_start );
+	void write_array( const su::Json::array &i_items );
+	void write_element( const std::string_view &i_key, const su::Json &i_json );
+};
+
+size_t Writer::start_document()
+{
+	auto start = _out.size();
+	_out.append( 4, '\0' );
+	return start;
+}
+
+void Writer::end_document( size_t i_start )
+{
+	_out.push_back( '\0' );
+	auto len = su::native_to_little(
+	    static_cast<int32_t>( _out.size() - i_start ) );
+	std::memcpy( &_out[i_start], &len, 4 );
+}
+
+void Writer::write_document( const su::Json::object &i_items )
+{
+	auto start = start_document();
+	for ( auto &it : i_items )
+		write_element( it.first, it.second );
+	end_document( start );
+}
+
+void Writer::write_array( const su::Json::array &i_items )
+{
+	auto start = start_document();
+	char key[24];
+	for ( size_t i = 0; i < i_items.size(); ++i )
+	{
+		auto res = std::to_chars( key, key + sizeof( key ), i );
+		write_element( std::string_view( key, res.ptr - key ), i_items[i] );
+	}
+	end_document( start );
+}
+
+void Writer::write_element( const std::string_view &i_key,
+                            const su::Json &i_json )
+{
+	auto typePos = _out.size();
+	_out.push_back( '\0' );
+	_out.append( i_key.substr( 0, i_key.find( '\0' ) ) );
+	_out.push_back( '\0' );
+
+	uint8_t type = kNull;
+	switch ( i_json.type() )
+	{
+		case su::Json::Type::NUL:
+			break;
+		case su::Json::Type::BOOL:
+			type = kBool;
+			_out.push_back( i_json.bool_value() ? 1 : 0 );
+			break;
+		case su::Json::Type::NUMBER:
+			if ( i_json.is_double() )
+			{
+				type = kDouble;
+				put( i_json.number_value() );
+			}
+			else if ( i_json.is_int() )
+			{
+				type = kInt32;
+				put( i_json.int_value() );
+			}
+			else
+			{
+				type = kInt64;
+				put( i_json.int64_value() );
+			}
+			break;
+		case su::Json::Type::STRING:
+		{
+			type = kString;
+			const auto &s = i_json.string_view();
+			put( static_cast<int32_t>( s.size() + 1 ) );
+			_out.append( s );
+			_out.push_back( '\0' );
+			break;
+		}
+		case su::Json::Type::ARRAY:
+			type = kArray;
+			write_array( i_json.array_items() );
+			break;
+		case su::Json::Type::OBJECT:
+			type = kDocument;
+			write_document( i_json.object_items() );
+			break;
+	}
+	_out[typePos] = static_cast<char>( type );
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Reading
+ */
+
+class Reader
+{
+public:
+	Reader( const char *i_data, size_t i_size, std::string &o_err ) :
+	    _ptr( i_data ),
+	    _end( i_data + i_size ),
+	    _err( o_err )
+	{
+	}
+
+	su::Json read_value( uint8_t i_type, int i_depth );
+	bool at_end() const { return _ptr == _end; }
+	bool failed() const { return _failed; }
+
+	su::Json fail( std::string &&i_msg )
+	{
+		if ( not _failed )
+			_err = std::move( i_msg );
+		_failed = true;
+		return su::Json();
+	}
+
+private:
+	const char *_ptr;
+	const char *_end;
+	std::string &_err;
+	bool _failed = false;
+
+	bool has( size_t i_size )
+	{
+		if ( static_cast<size_t>( _end - _ptr ) >= i_size )
+			return true;
+		fail( "unexpected end of input" );
+		return false;
+	}
+	template<typename T>
+	T next()
+	{
+		auto v = get<T>( _ptr );
+		_ptr += sizeof( T );
+		return v;
+	}
+
+	su::Json read_int( int64_t i_value );
+	su::Json read_string( int32_t i_min, int32_t i_trailing );
+	su::Json read_document( bool i_array, int i_depth );
+};
+
+su::Json Reader::read_value( uint8_t i_type, int i_depth )
+{
+	switch ( i_type )
+	{
+		case kDouble:
+			return has( 8 ) ? su::Json( next<double>() ) : su::Json();
+		case kString:
+		case kCode:
+		case kSymbol:
+			return read_string( 1, 1 );
+		case kDocument:
+			return read_document( false, i_depth );
+		case kArray:
+			return read_document( true, i_depth );
+		case kBinary:
+		{
+			if ( not has( 5 ) )
+				return su::Json();
+			auto len = next<int32_t>();
+			++_ptr; // subtype
+			if ( len < 0 or not has( size_t( len ) ) )
+				return fail( "invalid binary length" );
+			su::Json s( std::string( _ptr, len ) );
+			_ptr += len;
+			return s;
+		}
+		case kUndefined:
+		case kNull:
+			return su::Json();
+		case kObjectId:
+		{
+			if ( not has( 12 ) )
+				return su::Json();
+			static const char kHex[] = "0123456789abcdef";
+			std::string hex( 24, '0' );
+			for ( int i = 0; i < 12; ++i )
+			{
+				auto b = static_cast<uint8_t>( *_ptr++ );
+				hex[2 * i] = kHex[b >> 4];
+				hex[2 * i + 1] = kHex[b & 0x0f];
+			}
+			return hex;
+		}
+		case kBool:
+			return has( 1 ) ? su::Json( *_ptr++ != 0 ) : su::Json();
+		case kInt32:
+			return has( 4 ) ? su::Json( next<int32_t>() ) : su::Json();
+		case kDateTime:
+		case kInt64:
+			return has( 8 ) ? read_int( next<int64_t>() ) : su::Json();
+		case kTimestamp:
+			return has( 8 ) ? read_int( int64_t( next<uint64_t>() ) )
+			                : su::Json();
+		default:
+			return fail( "unsupported element type " +
+			             std::to_string( i_type ) );
+	}
+}
+
+su::Json Reader::read_int( int64_t i_value )
+{
+	if ( i_value >= std::numeric_limits<int32_t>::min() and
+	     i_value <= std::numeric_limits<int32_t>::max() )
+		return static_cast<int32_t>( i_value );
+	return i_value;
+}
+
+su::Json Reader::read_string( int32_t i_min, int32_t i_trailing )
+{
+	if ( not has( 4 ) )
+		return su::Json();
+	auto len = next<int32_t>();
+	if ( len < i_min or not has( size_t( len ) ) or
+	     ( i_trailing and _ptr[len - 1] != '\0' ) )
+		return fail( "invalid string length" );
+	su::Json s( std::string( _ptr, len - i_trailing ) );
+	_ptr += len;
+	return s;
+}
+
+su::Json Reader::read_document( bool i_array, int i_depth )
+{
+	if ( i_depth > max_depth )
+		return fail( "exceeded maximum nesting depth" );
+	if ( not has( 4 ) )
+		return su::Json();
+	auto len = next<int32_t>();
+	if ( len < 5 or not has( size_t( len ) - 4 ) or _ptr[len - 5] != '\0' )
+		return fail( "invalid document length" );
+
+	// elements are read up to the terminating nul
+	auto parentEnd = _end;
+	_end = _ptr + len - 5;
+
+	su::Json::array arrayItems;
+	su::Json::object objectItems;
+	while ( _ptr < _end and not _failed )
+	{
+		auto type = static_cast<uint8_t>( *_ptr++ );
+		auto key = static_cast<const char *>(
+		    std::memchr( _ptr, 0, _end - _ptr ) );
+		if ( key == nullptr )
+		{
+			fail( "invalid element name" );
+			break;
+		}
+		std::swap( key, _ptr );
+		size_t keyLen = _ptr++ - key;
+
+		auto value = read_value( type, i_depth + 1 );
+		if ( i_array )
+			arrayItems.push_back( std::move( value ) );
+		else if ( objectItems.empty() or
+		          objectItems.storage().back().first <
+		              std::string_view( key, keyLen ) )
+			objectItems.storage().emplace_back( std::string( key, keyLen ),
+			                                    std::move( value ) );
+		else
+			objectItems[std::string( key, keyLen )] = std::move( value );
+	}
+	if ( _failed )
+		return su::Json();
+	_end = parentEnd;
+	++_ptr; // terminating nul
+	if ( i_array )
+		return arrayItems;
+	return objectItems;
+}
+
+}
+
+namespace su {
+namespace bson {
+
+void write( const Json &i_json, std::string &o_buffer )
+{
+	o_buffer.clear();
+	if ( i_json.is_object() )
+	{
+		Writer writer( o_buffer );
+		writer.write_document( i_json.object_items() );
+	}
+}
+
+std::string write( const Json &i_json )
+{
+	std::string result;
+	write( i_json, result );
+	return result;
+}
+
+Json read( const std::string_view &i_data, std::string &o_err )
+{
+	Reader reader( i_data.data(), i_data.size(), o_err );
+	auto result = reader.read_value( kDocument, 0 );
+	if ( reader.failed() )
+		return Json();
+	if ( not reader.at_end() )
+		return reader.fail( "unexpected trailing data" );
+	return result;
+}
+
+Json read( const std::string_view &i_data )
+{
+	std::string err;
+	return read( i_data, err );
+}
+
+Json find( const std::string_view &i_data, const std::string_view &i_path )
+{
+	const char *ptr = i_data.data();
+	const char *end = ptr + i_data.size();
+	uint8_t type = kDocument;
+	size_t size = value_size( type, ptr, end );
+	if ( size == std::string::npos )
+		return Json();
+
+	std::string_view path( i_path );
+	while ( not path.empty() )
+	{
+		auto dot = path.find( '.' );
+		auto name = path.substr( 0, dot );
+		path = dot == std::string_view::npos ? std::string_view()
+		                                     : path.substr( dot + 1 );
+		if ( type != kDocument and type != kArray )
+			return Json();
+
+		// walk the elements of the document at ptr, skipping over values
+		const char *docEnd = ptr + size - 1;
+		ptr += 4;
+		for ( ;; )
+		{
+			if ( ptr >= docEnd )
+				return Json();
+			type = static_cast<uint8_t>( *ptr++ );
+			auto key = ptr;
+			ptr = static_cast<const char *>(
+			    std::memchr( ptr, 0, docEnd - ptr ) );
+			if ( ptr == nullptr )
+				return Json();
+			bool found = name == std::string_view( key, ptr - key );
+			size = value_size( type, ++ptr, docEnd );
+			if ( size == std::string::npos )
+				return Json();
+			if ( found )
+				break;
+			ptr += size;
+		}
+	}
+
+	std::string err;
+	Reader reader( ptr, size, err );
+	return reader.read_value( type, 0 );
+}
+
+}
+}
@@ -0,0 +1,55 @@
+/*
+ *  su_bson.h
+ *  sutils
+ *
+ *  Created by Sandy Martel on 2026/10/18.
+ *  Copyright (c) 2026年 Sandy Martel. All rights reserved.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software for any
+ * purpose is hereby granted without fee. The sotware is provided "AS-IS" and
+ * without warranty of any kind, express, implied or otherwise.
+ */
+
+#ifndef H_SU_BSON
+#define H_SU_BSON
+
+#include "su_json.h"
+
+namespace su {
+namespace bson {
+
+/*!
+   @brief Serialize to BSON, http://bsonspec.org
+
+   A BSON document is an object, anything else gives an empty result. Keys
+   are C strings in BSON, they are cut at the first nul character.
+   o_buffer is cleared first, its capacity is kept for re-use.
+*/
+void write( const Json &i_json, std::string &o_buffer );
+std::string write( const Json &i_json );
+
+/*!
+   @brief Deserialize a BSON document.
+
+   Binary data is read as a string, ObjectId as its 24 characters hex string
+   and dates and timestamps as 64 bits integers. On error, return Json() and
+   assign an error message to o_err.
+*/
+Json read( const std::string_view &i_data, std::string &o_err );
+Json read( const std::string_view &i_data );
+
+/*!
+   @brief Decode only the value at i_path in a BSON document.
+
+   i_path is a dot separated list of keys, array elements are found by their
+   index, "a.0.b". Each level is walked using the embedded lengths to jump
+   over the siblings, without decoding them, so the cost depends on the path
+   and not on the size of the document. Return Json() if not found or if the
+   document is invalid.
+*/
+Json find( const std::string_view &i_data, const std::string_view &i_path );
+
+}
+}
+
+#endif
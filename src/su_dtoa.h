@@ -0,0 +1,51 @@
+/*
+ *  su_dtoa.h
+ *  sutils
+ *
+ *  Created by Sandy Martel on 2026/10/18.
+ *  Copyright (c) 2026年 Sandy Martel. All rights reserved.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software for any
+ * purpose is hereby granted without fee. The sotware is provided "AS-IS" and
+ * without warranty of any kind, express, implied or otherwise.
+ */
+
+#ifndef H_SU_DTOA
+#define H_SU_DTOA
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace su {
+
+//! Size of the largest output of dtoa(), "-0.0000012345678901234567" or
+//! "-1.2345678901234567e-308".
+constexpr size_t kDtoaBufferSize = 25;
+
+/*!
+   @brief Shortest round-trip formatting of a double.
+
+   Write the fewest decimal digits that read back to exactly i_value,
+   correctly rounded when several are as short (Ryu, Ulf Adams 2018). The
+   notation is the one of json and javascript: integral values keep a
+   ".0", the exponent form is used from 1e21 and below 1e-6 ("1e21",
+   "1.5e-7"). Nan and infinities are written "nan", "inf" and "-inf".
+
+   o_buffer must have room for kDtoaBufferSize chars, return the end of the
+   output, it is not nul terminated.
+*/
+char *dtoa( double i_value, char *o_buffer );
+std::string dtoa( double i_value );
+
+/*!
+   @brief The shortest decimal of a finite, non-negative double.
+
+   i_value == o_digits * 10^o_exponent once read back, o_digits has at
+   most 17 digits and no trailing zeros.
+*/
+void dtoa_decimal( double i_value, uint64_t &o_digits, int &o_exponent );
+
+}
+
+#endif
@@ -22,7 +22,8 @@ enum class endian
 {
     little = 0,
     big    = 1,
-#if defined(_WIN32) || defined(__LITTLE_ENDIAN__)
+#if defined(_WIN32) || defined(__LITTLE_ENDIAN__) || \
+	( defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ )
     native = little
 #else
     native = big
@@ -0,0 +1,684 @@
+/*
+ *  su_flatjson.cpp
+ *  sutils
+ *
+ *  Created by Sandy Martel on 2026/10/18.
+ *  Copyright (c) 2026年 Sandy Martel. All rights reserved.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software for any
+ * purpose is hereby granted without fee. The sotware is provided "AS-IS" and
+ * without warranty of any kind, express, implied or otherwise.
+ */
+
+#include "su_flatjson.h"
+#include "su_endian.h"
+#include <ciso646>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+/*
+	Layout, all integers little endian:
+
+	header:  "SUFJ" u32 version, root slot
+	slot:    u32 tag, u32 payload, the payload is the value itself for
+	         null, bool and int32, an offset from the start of the buffer
+	         for the others
+	int64:   8 bytes, 8 aligned
+	double:  8 bytes, 8 aligned
+	string:  u32 size, bytes, nul, 4 aligned
+	array:   u32 count, u32 0, slot[count], 8 aligned
+	object:  u32 count, u32 0, u32 key offsets[count] sorted, padding to 8,
+	         slot values[count], 8 aligned
+*/
+
+namespace {
+
+const int max_depth = 200;
+const uint32_t version = 1;
+const size_t header_size = 16;
+const size_t slot_size = 8;
+
+enum Tag : uint32_t
+{
+	kNull = 0,
+	kBool,
+	kInt32,
+	kInt64,
+	kDouble,
+	kString,
+	kArray,
+	kObject
+};
+
+inline size_t align8( size_t i_size ) { return ( i_size + 7 ) & ~size_t( 7 ); }
+
+template<typename T>
+inline T load( const uint8_t *i_ptr )
+{
+	T v;
+	std::memcpy( &v, i_ptr, sizeof( T ) );
+	return su::little_to_native( v );
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Writing
+ */
+
+struct Slot
+{
+	uint32_t tag = kNull;
+	uint32_t payload = 0;
+};
+
+class Writer
+{
+public:
+	Writer( std::vector<uint8_t> &o_buffer ) : _out( o_buffer ) {}
+
+	void write( const su::Json &i_json );
+	// offsets are 32 bits, the buffer cannot grow past 4 GB
+	bool overflow() const { return _overflow; }
+
+private:
+	std::vector<uint8_t> &_out;
+	std::unordered_map<std::string_view, uint32_t> _strings;
+	bool _overflow = false;
+
+	uint32_t align( size_t i_alignment )
+	{
+		_out.resize( ( _out.size() + i_alignment - 1 ) & ~( i_alignment - 1 ) );
+		return to_u32( _out.size() );
+	}
+	uint32_t to_u32( size_t i_value )
+	{
+		if ( i_value > std::numeric_limits<uint32_t>::max() )
+			_overflow = true;
+		return static_cast<uint32_t>( i_value );
+	}
+	template<typename T>
+	void put( T i_value )
+	{
+		i_value = su::native_to_little( i_value );
+		auto pos = _out.size();
+		_out.resize( pos + sizeof( T ) );
+		std::memcpy( _out.data() + pos, &i_value, sizeof( T ) );
+	}
+	void put( const Slot &i_slot )
+	{
+		put( i_slot.tag );
+		put( i_slot.payload );
+	}
+
+	Slot write_value( const su::Json &i_json );
+	uint32_t write_string( const std::string_view &i_value );
+};
+
+void Writer::write( const su::Json &i_json )
+{
+	_out.resize( header_size );
+	std::memcpy( _out.data(), "SUFJ", 4 );
+	auto v = su::native_to_little( version );
+	std::memcpy( _out.data() + 4, &v, 4 );
+	auto root = write_value( i_json );
+	auto tag = su::native_to_little( root.tag );
+	auto payload = su::native_to_little( root.payload );
+	std::memcpy( _out.data() + 8, &tag, 4 );
+	std::memcpy( _out.data() + 12, &payload, 4 );
+}
+
+// children first, a container record is written once the offsets of all its
+// items are known
+Slot Writer::write_value( const su::Json &i_json )
+{
+	Slot slot;
+	switch ( i_json.type() )
+	{
+		case su::Json::Type::NUL:
+			break;
+		case su::Json::Type::BOOL:
+			slot.tag = kBool;
+			slot.payload = i_json.bool_value() ? 1 : 0;
+			break;
+		case su::Json::Type::NUMBER:
+			if ( i_json.is_double() )
+			{
+				slot.tag = kDouble;
+				slot.payload = align( 8 );
+				put( i_json.number_value() );
+			}
+			else
+			{
+				auto v = i_json.int64_value();
+				if ( v >= std::numeric_limits<int32_t>::min() and
+				     v <= std::numeric_limits<int32_t>::max() )
+				{
+					slot.tag = kInt32;
+					slot.payload = static_cast<uint32_t>( v );
+				}
+				else
+				{
+					slot.tag = kInt64;
+					slot.payload = align( 8 );
+					put( v );
+				}
+			}
+			break;
+		case su::Json::Type::STRING:
+			slot.tag = kString;
+			slot.payload = write_string( i_json.string_view() );
+			break;
+		case su::Json::Type::ARRAY:
+		{
+			const auto &items = i_json.array_items();
+			std::vector<Slot> slots;
+			slots.reserve( items.size() );
+			for ( auto &it : items )
+				slots.push_back( write_value( it ) );
+			slot.tag = kArray;
+			slot.payload = align( 8 );
+			put( to_u32( slots.size() ) );
+			put( uint32_t( 0 ) );
+			for ( auto &it : slots )
+				put( it );
+			break;
+		}
+		case su::Json::Type::OBJECT:
+		{
+			const auto &items = i_json.object_items();
+			std::vector<uint32_t> keys;
+			std::vector<Slot> slots;
+			keys.reserve( items.size() );
+			slots.reserve( items.size() );
+			// object items are already sorted by key
+			for ( auto &it : items )
+			{
+				keys.push_back( write_string( it.first ) );
+				slots.push_back( write_value( it.second ) );
+			}
+			slot.tag = kObject;
+			slot.payload = align( 8 );
+			put( to_u32( slots.size() ) );
+			put( uint32_t( 0 ) );
+			for ( auto it : keys )
+				put( it );
+			align( 8 );
+			for ( auto &it : slots )
+				put( it );
+			break;
+		}
+	}
+	return slot;
+}
+
+uint32_t Writer::write_string( const std::string_view &i_value )
+{
+	auto it = _strings.find( i_value );
+	if ( it != _strings.end() )
+		return it->second;
+	auto offset = align( 4 );
+	put( to_u32( i_value.size() ) );
+	_out.insert( _out.end(), i_value.begin(), i_value.end() );
+	_out.push_back( 0 );
+	_strings.emplace( i_value, offset );
+	return offset;
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Reading
+ */
+
+// bounds checked access to a record
+inline const uint8_t *at( const uint8_t *i_data,
+                          size_t i_size,
+                          uint64_t i_offset,
+                          uint64_t i_length )
+{
+	if ( i_offset > i_size or i_length > i_size - i_offset )
+		return nullptr;
+	return i_data + i_offset;
+}
+
+// a string record
+inline bool string_at( const uint8_t *i_data,
+                       size_t i_size,
+                       uint32_t i_offset,
+                       std::string_view &o_value )
+{
+	auto p = at( i_data, i_size, i_offset, 4 );
+	if ( p == nullptr )
+		return false;
+	auto len = load<uint32_t>( p );
+	p = at( i_data, i_size, uint64_t( i_offset ) + 4, len );
+	if ( p == nullptr )
+		return false;
+	o_value = std::string_view( reinterpret_cast<const char *>( p ), len );
+	return true;
+}
+
+// an array or object record, return the first entry after the count
+inline const uint8_t *container( const uint8_t *i_data,
+                                 size_t i_size,
+                                 uint32_t i_tag,
+                                 uint32_t i_offset,
+                                 size_t &o_count )
+{
+	auto p = at( i_data, i_size, i_offset, 8 );
+	if ( p == nullptr )
+		return nullptr;
+	uint64_t count = load<uint32_t>( p );
+	uint64_t length = count * slot_size;
+	if ( i_tag == kObject )
+		length += align8( count * 4 );
+	if ( at( i_data, i_size, i_offset, 8 + length ) == nullptr )
+		return nullptr;
+	o_count = count;
+	return p + 8;
+}
+
+class Reader
+{
+public:
+	Reader( const uint8_t *i_data, size_t i_size, std::string &o_err ) :
+	    _data( i_data ),
+	    _size( i_size ),
+	    _err( o_err ),
+	    _slotBudget( i_size / slot_size ),
+	    _stringBudget( i_size ),
+	    _keyBudget( i_size )
+	{
+	}
+
+	su::Json read( uint32_t i_tag, uint32_t i_payload, int i_depth );
+	bool failed() const { return _failed; }
+
+	su::Json fail( std::string &&i_msg )
+	{
+		if ( not _failed )
+			_err = std::move( i_msg );
+		_failed = true;
+		return su::Json();
+	}
+
+private:
+	const uint8_t *_data;
+	size_t _size;
+	std::string &_err;
+	bool _failed = false;
+
+	// Offsets can point many times to the same record. A buffer from
+	// write() has each slot and each long string once, decoding more than
+	// the buffer holds means the records are reused to blow up the output.
+	size_t _slotBudget;
+	size_t _stringBudget;
+	// keys are copied for each object, like the slots, long ones are counted
+	size_t _keyBudget;
+	// long strings, by offset, shared like write() does
+	std::unordered_map<uint32_t, su::Json> _strings;
+
+	bool spend_slots( size_t i_count )
+	{
+		if ( i_count > _slotBudget )
+		{
+			fail( "too many values for the buffer size" );
+			return false;
+		}
+		_slotBudget -= i_count;
+		return true;
+	}
+	su::Json read_string( uint32_t i_offset );
+	su::Json read_array( uint32_t i_offset, int i_depth );
+	su::Json read_object( uint32_t i_offset, int i_depth );
+};
+
+su::Json Reader::read( uint32_t i_tag, uint32_t i_payload, int i_depth )
+{
+	switch ( i_tag )
+	{
+		case kNull:
+			return su::Json();
+		case kBool:
+			return i_payload != 0;
+		case kInt32:
+			return static_cast<int32_t>( i_payload );
+		case kInt64:
+		{
+			auto p = at( _data, _size, i_payload, 8 );
+			if ( p == nullptr )
+				return fail( "invalid offset" );
+			auto v = load<int64_t>( p );
+			if ( v >= std::numeric_limits<int32_t>::min() and
+			     v <= std::numeric_limits<int32_t>::max() )
+				return static_cast<int32_t>( v );
+			return v;
+		}
+		case kDouble:
+		{
+			auto p = at( _data, _size, i_payload, 8 );
+			if ( p == nullptr )
+				return fail( "invalid offset" );
+			return load<double>( p );
+		}
+		case kString:
+			return read_string( i_payload );
+		case kArray:
+		case kObject:
+			// offsets can make cycles, the depth limit stops them
+			if ( i_depth >= max_depth )
+				return fail( "exceeded maximum nesting depth" );
+			return i_tag == kArray ? read_array( i_payload, i_depth )
+			                       : read_object( i_payload, i_depth );
+		default:
+			return fail( "invalid tag " + std::to_string( i_tag ) );
+	}
+}
+
+su::Json Reader::read_string( uint32_t i_offset )
+{
+	auto it = _strings.find( i_offset );
+	if ( it != _strings.end() )
+		return it->second;
+	std::string_view s;
+	if ( not string_at( _data, _size, i_offset, s ) )
+		return fail( "invalid offset" );
+	su::Json result( s );
+	// short ones are stored inline, they cost no more than their slot
+	if ( s.size() > 14 )
+	{
+		if ( s.size() > _stringBudget )
+			return fail( "too many strings for the buffer size" );
+		_stringBudget -= s.size();
+		_strings.emplace( i_offset, result );
+	}
+	return result;
+}
+
+su::Json Reader::read_array( uint32_t i_offset, int i_depth )
+{
+	size_t count = 0;
+	auto p = container( _data, _size, kArray, i_offset, count );
+	if ( p == nullptr )
+		return fail( "invalid offset" );
+	if ( not spend_slots( count ) )
+		return su::Json();
+	su::Json::array items;
+	items.reserve( count );
+	for ( size_t i = 0; i < count and not _failed; ++i, p += slot_size )
+		items.push_back(
+		    read( load<uint32_t>( p ), load<uint32_t>( p + 4 ), i_depth + 1 ) );
+	return _failed ? su::Json() : su::Json( std::move( items ) );
+}
+
+su::Json Reader::read_object( uint32_t i_offset, int i_depth )
+{
+	size_t count = 0;
+	auto keys = container( _data, _size, kObject, i_offset, count );
+	if ( keys == nullptr )
+		return fail( "invalid offset" );
+	if ( not spend_slots( count ) )
+		return su::Json();
+	auto values = keys + align8( count * 4 );
+	su::Json::object items;
+	items.reserve( count );
+	for ( size_t i = 0; i < count and not _failed; ++i )
+	{
+		std::string_view key;
+		if ( not string_at( _data, _size, load<uint32_t>( keys + i * 4 ), key ) )
+			return fail( "invalid offset" );
+		if ( key.size() > 14 )
+		{
+			if ( key.size() > _keyBudget )
+				return fail( "too many keys for the buffer size" );
+			_keyBudget -= key.size();
+		}
+		// keys are written sorted and once, append without searching
+		if ( not items.empty() and not( items.storage().back().first < key ) )
+			return fail( "object keys are not sorted" );
+		auto p = values + i * slot_size;
+		auto value =
+		    read( load<uint32_t>( p ), load<uint32_t>( p + 4 ), i_depth + 1 );
+		items.storage().emplace_back( std::string( key ), std::move( value ) );
+	}
+	return _failed ? su::Json() : su::Json( std::move( items ) );
+}
+
+bool valid_header( const uint8_t *i_data, size_t i_size )
+{
+	return i_size >= header_size and std::memcmp( i_data, "SUFJ", 4 ) == 0 and
+	       load<uint32_t>( i_data + 4 ) == version;
+}
+
+}
+
+namespace su {
+namespace flat {
+
+void write( const Json &i_json, std::vector<uint8_t> &o_buffer )
+{
+	o_buffer.clear();
+	Writer writer( o_buffer );
+	writer.write( i_json );
+	if ( writer.overflow() )
+		o_buffer.clear();
+}
+
+std::vector<uint8_t> write( const Json &i_json )
+{
+	std::vector<uint8_t> result;
+	write( i_json, result );
+	return result;
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * View
+ */
+
+View::View( const uint8_t *i_data, size_t i_size, const uint8_t *i_slot ) :
+    _data( i_data ),
+    _size( i_size ),
+    _tag( load<uint32_t>( i_slot ) ),
+    _payload( load<uint32_t>( i_slot + 4 ) )
+{
+}
+
+Json::Type View::type() const
+{
+	switch ( _tag )
+	{
+		case kBool:
+			return Json::Type::BOOL;
+		case kInt32:
+		case kInt64:
+		case kDouble:
+			return Json::Type::NUMBER;
+		case kString:
+			return Json::Type::STRING;
+		case kArray:
+			return Json::Type::ARRAY;
+		case kObject:
+			return Json::Type::OBJECT;
+		default:
+			return Json::Type::NUL;
+	}
+}
+
+double View::number_value() const
+{
+	switch ( _tag )
+	{
+		case kInt32:
+			return static_cast<int32_t>( _payload );
+		case kInt64:
+			return static_cast<double>( int64_value() );
+		case kDouble:
+			if ( auto p = at( _data, _size, _payload, 8 ) )
+				return load<double>( p );
+			break;
+		default:
+			break;
+	}
+	return 0;
+}
+
+int32_t View::int_value() const
+{
+	switch ( _tag )
+	{
+		case kInt32:
+			return static_cast<int32_t>( _payload );
+		case kInt64:
+			return static_cast<int32_t>( int64_value() );
+		case kDouble:
+			return static_cast<int32_t>( number_value() );
+		default:
+			return 0;
+	}
+}
+
+int64_t View::int64_value() const
+{
+	switch ( _tag )
+	{
+		case kInt32:
+			return static_cast<int32_t>( _payload );
+		case kInt64:
+			if ( auto p = at( _data, _size, _payload, 8 ) )
+				return load<int64_t>( p );
+			return 0;
+		case kDouble:
+			return static_cast<int64_t>( number_value() );
+		default:
+			return 0;
+	}
+}
+
+bool View::bool_value() const { return _tag == kBool and _payload != 0; }
+
+std::string_view View::string_value() const
+{
+	std::string_view s;
+	if ( _tag == kString )
+		string_at( _data, _size, _payload, s );
+	return s;
+}
+
+View View::operator[]( size_t i ) const
+{
+	size_t count = 0;
+	const uint8_t *p = nullptr;
+	if ( _tag == kArray )
+		p = container( _data, _size, _tag, _payload, count );
+	if ( p == nullptr or i >= count )
+		return View();
+	return View( _data, _size, p + i * slot_size );
+}
+
+View View::operator[]( const std::string_view &key ) const
+{
+	size_t count = 0;
+	const uint8_t *keys = nullptr;
+	if ( _tag == kObject )
+		keys = container( _data, _size, _tag, _payload, count );
+	if ( keys == nullptr )
+		return View();
+	size_t first = 0, last = count;
+	while ( first < last )
+	{
+		auto mid = first + ( last - first ) / 2;
+		std::string_view k;
+		if ( not string_at( _data, _size, load<uint32_t>( keys + mid * 4 ), k ) )
+			return View();
+		auto c = k.compare( key );
+		if ( c == 0 )
+			return View(
+			    _data, _size, keys + align8( count * 4 ) + mid * slot_size );
+		if ( c < 0 )
+			first = mid + 1;
+		else
+			last = mid;
+	}
+	return View();
+}
+
+size_t View::size() const
+{
+	size_t count = 0;
+	if ( _tag == kArray or _tag == kObject )
+		container( _data, _size, _tag, _payload, count );
+	return count;
+}
+
+void View::for_each_item( const std::function<bool( const View & )> &i_cb ) const
+{
+	size_t count = 0;
+	const uint8_t *p = nullptr;
+	if ( _tag == kArray )
+		p = container( _data, _size, _tag, _payload, count );
+	else if ( _tag == kObject )
+	{
+		p = container( _data, _size, _tag, _payload, count );
+		if ( p != nullptr )
+			p += align8( count * 4 );
+	}
+	for ( size_t i = 0; p != nullptr and i < count; ++i, p += slot_size )
+	{
+		if ( not i_cb( View( _data, _size, p ) ) )
+			break;
+	}
+}
+
+void View::for_each_member(
+    const std::function<bool( const std::string_view &, const View & )> &i_cb )
+    const
+{
+	size_t count = 0;
+	const uint8_t *keys = nullptr;
+	if ( _tag == kObject )
+		keys = container( _data, _size, _tag, _payload, count );
+	if ( keys == nullptr )
+		return;
+	auto values = keys + align8( count * 4 );
+	for ( size_t i = 0; i < count; ++i )
+	{
+		std::string_view k;
+		string_at( _data, _size, load<uint32_t>( keys + i * 4 ), k );
+		if ( not i_cb( k, View( _data, _size, values + i * slot_size ) ) )
+			break;
+	}
+}
+
+Json View::to_json() const
+{
+	std::string err;
+	Reader reader( _data, _size, err );
+	auto result = reader.read( _tag, _payload, 0 );
+	return reader.failed() ? Json() : result;
+}
+
+View root( const uint8_t *i_data, size_t i_size )
+{
+	if ( not valid_header( i_data, i_size ) )
+		return View();
+	return View( i_data, i_size, i_data + 8 );
+}
+
+Json read( const uint8_t *i_data, size_t i_size, std::string &o_err )
+{
+	Reader reader( i_data, i_size, o_err );
+	if ( not valid_header( i_data, i_size ) )
+		return reader.fail( "not a flat Json buffer" );
+	auto result =
+	    reader.read( load<uint32_t>( i_data + 8 ), load<uint32_t>( i_data + 12 ), 0 );
+	if ( reader.failed() )
+		return Json();
+	return result;
+}
+
+Json read( const uint8_t *i_data, size_t i_size )
+{
+	std::string err;
+	return read( i_data, i_size, err );
+}
+
+}
+}
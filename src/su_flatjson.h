@@ -0,0 +1,112 @@
+/*
+ *  su_flatjson.h
+ *  sutils
+ *
+ *  Created by Sandy Martel on 2026/10/18.
+ *  Copyright (c) 2026年 Sandy Martel. All rights reserved.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software for any
+ * purpose is hereby granted without fee. The sotware is provided "AS-IS" and
+ * without warranty of any kind, express, implied or otherwise.
+ */
+
+#ifndef H_SU_FLATJSON
+#define H_SU_FLATJSON
+
+#include "su_json.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace su {
+namespace flat {
+
+/*!
+   @brief Serialize to a flat, offset based, binary layout.
+
+   The layout is meant to be used in place, straight from a memory mapped
+   file: all integers are little endian, numbers are 8 bytes aligned, arrays
+   are tables of fixed size slots and objects have their keys sorted in a
+   table of their own. Identical strings are stored once. Offsets are 32
+   bits, a value that would need more than 4 GB gives an empty result.
+   o_buffer is cleared first, its capacity is kept for re-use.
+*/
+void write( const Json &i_json, std::vector<uint8_t> &o_buffer );
+std::vector<uint8_t> write( const Json &i_json );
+
+/*!
+   @brief A value in a flat buffer, used in place.
+
+   Every access is bounds checked against the buffer, an invalid offset gives
+   a null view. The buffer must outlive the views.
+*/
+class View final
+{
+public:
+	View() = default;
+
+	Json::Type type() const;
+	bool is_null() const { return type() == Json::Type::NUL; }
+	bool is_number() const { return type() == Json::Type::NUMBER; }
+	bool is_bool() const { return type() == Json::Type::BOOL; }
+	bool is_string() const { return type() == Json::Type::STRING; }
+	bool is_array() const { return type() == Json::Type::ARRAY; }
+	bool is_object() const { return type() == Json::Type::OBJECT; }
+
+	// 0 / false / "" if not of the right type.
+	double number_value() const;
+	int32_t int_value() const;
+	int64_t int64_value() const;
+	bool bool_value() const;
+	// Points into the buffer.
+	std::string_view string_value() const;
+
+	// Return the view of array[i] if this is an array, a null view otherwise,
+	// in constant time.
+	View operator[]( size_t i ) const;
+	// Return the view of obj[key] if this is an object, a null view otherwise,
+	// with a binary search on the keys.
+	View operator[]( const std::string_view &key ) const;
+
+	// Number of items of an array or object, 0 otherwise.
+	size_t size() const;
+
+	// Visit the items of an array or an object, stop when the callback
+	// returns false.
+	void for_each_item( const std::function<bool( const View & )> &i_cb ) const;
+	void for_each_member(
+	    const std::function<bool( const std::string_view &, const View & )>
+	        &i_cb ) const;
+
+	// Deserialize this value.
+	Json to_json() const;
+
+private:
+	friend View root( const uint8_t *i_data, size_t i_size );
+
+	View( const uint8_t *i_data, size_t i_size, const uint8_t *i_slot );
+
+	const uint8_t *_data = nullptr;
+	size_t _size = 0;
+	uint32_t _tag = 0;
+	uint32_t _payload = 0;
+};
+
+// The root value, a null view if i_data is not a flat buffer.
+View root( const uint8_t *i_data, size_t i_size );
+
+/*!
+   @brief Deserialize a flat buffer.
+
+   On error, return Json() and assign an error message to o_err. Records
+   reached through several offsets are an error once more values, or more
+   long keys, would be decoded than the buffer holds, identical strings are
+   shared. The keys of an object must be sorted, like write() does.
+*/
+Json read( const uint8_t *i_data, size_t i_size, std::string &o_err );
+Json read( const uint8_t *i_data, size_t i_size );
+
+}
+}
+
+#endif
@@ -12,10 +12,12 @@
 
 #include "su_format.h"
 #include "su_stackarray.h"
+#include "su_dtoa.h"
 #include <vector>
 #include <cassert>
 #include <algorithm>
 #include <cctype>
+#include <cmath>
 
 namespace su {
 
@@ -237,7 +239,7 @@ std::string FormatArg::to_string() const
 		case arg_type::kUnsignedLongLong: return std::to_string( u._unsignedlonglong );
 		case arg_type::kSize: return std::to_string( u._size_t );
 		case arg_type::kPtrDiff: return std::to_string( u._ptrdiff_t );
-		case arg_type::kDouble: return std::to_string( u._double );
+		case arg_type::kDouble: return su::dtoa( u._double );
 		case arg_type::kChar: return std::string( 1, u._char );
 		case arg_type::kPtr: return std::string( "xx" );
         case arg_type::kString: return std::string{ u._string };
@@ -799,9 +801,15 @@ void format_impl::appendFormattedArg( const su::details::FormatSpec &i_formatSpe
 		case 'n':
 			assert( false );
 			break;
+		case '@':
+			if ( arg.is_double() )
+			{
+				formatDouble( arg.cast<double>(), i_formatSpec, width, prec );
+				break;
+			}
+			[[fallthrough]];
 		case 'c':
 		case 's':
-		case '@':
 		{
 			// only width, prec and kLeftAdjustFlag are relevant
 			auto s = arg.to_string();
@@ -954,6 +962,44 @@ void format_impl::formatInteger( T i_arg, const su::details::FormatSpec &i_forma
 
 void format_impl::formatDouble( double i_arg, const su::details::FormatSpec &i_formatSpec, int width, int prec )
 {
+	if ( i_formatSpec.type == '@' )
+	{
+		// shortest representation that reads back the same, only width and
+		// the flags are relevant
+		char buffer[su::kDtoaBufferSize + 1];
+		char *ptr = buffer;
+		if ( not std::signbit( i_arg ) )
+		{
+			if ( i_formatSpec.flags&kPlusFlag )
+				*ptr++ = '+';
+			else if ( i_formatSpec.flags&kSpaceFlag )
+				*ptr++ = ' ';
+		}
+		auto end = su::dtoa( i_arg, ptr );
+		int len = int(end - buffer);
+		if ( width <= len )
+			result.append( buffer, len );
+		else if ( i_formatSpec.flags&kLeftAdjustFlag )
+		{
+			result.append( buffer, len );
+			result.append( width - len, ' ' );
+		}
+		else if ( i_formatSpec.flags&kZeroFlag and std::isfinite( i_arg ) )
+		{
+			// zeros after the sign
+			size_t sign = ( buffer[0] == '-' or ptr != buffer ) ? 1 : 0;
+			result.append( buffer, sign );
+			result.append( width - len, '0' );
+			result.append( buffer + sign, len - sign );
+		}
+		else
+		{
+			result.append( width - len, ' ' );
+			result.append( buffer, len );
+		}
+		return;
+	}
+
 	char format[32];
 	char *ptr = format;
 	*ptr++ = '%';
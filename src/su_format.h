@@ -60,6 +60,7 @@ public:
 	
 	// to deal with strings and others
 	std::string to_string() const;
+	bool is_double() const { return _which == arg_type::kDouble; }
 	
 private:
 	struct any_base
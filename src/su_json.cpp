@@ -1,13 +1,47 @@
 #include "su_json.h"
+#include "su_always_inline.h"
+#include "su_dtoa.h"
+#include "su_endian.h"
+#include "su_filepath.h"
+#include "su_job.h"
+#include "su_jobdispatcher.h"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <utility>
 #include <cstring>
 #include <cctype>
+#include <cstddef>
+#include <charconv>
+#include <limits>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <unordered_map>
+#include <cerrno>
+
+#if UPLATFORM_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #if defined( _MSC_VER )
 #	include <intrin.h>
 #endif
+#if defined( __AVX2__ )
+#	include <immintrin.h>
+#	define SU_JSON_AVX2 1
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || \
+    ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#	include <emmintrin.h>
+#	define SU_JSON_SSE2 1
+#endif
 
 static_assert( sizeof( su::Json ) <= 16, "" );
 
@@ -193,30 +227,6 @@ struct DiyFp
 #endif
 	}
 
-	DiyFp NormalizeBoundary() const
-	{
-		DiyFp res = *this;
-		while ( !( res.f & ( kDpHiddenBit << 1 ) ) )
-		{
-			res.f <<= 1;
-			res.e--;
-		}
-		res.f <<= ( kDiySignificandSize - kDpSignificandSize - 2 );
-		res.e = res.e - ( kDiySignificandSize - kDpSignificandSize - 2 );
-		return res;
-	}
-
-	void NormalizedBoundaries( DiyFp *minus, DiyFp *plus ) const
-	{
-		DiyFp pl = DiyFp( ( f << 1 ) + 1, e - 1 ).NormalizeBoundary();
-		DiyFp mi = ( f == kDpHiddenBit ) ? DiyFp( ( f << 2 ) - 1, e - 2 ) :
-		                                   DiyFp( ( f << 1 ) - 1, e - 1 );
-		mi.f <<= mi.e - pl.e;
-		mi.e = pl.e;
-		*plus = pl;
-		*minus = mi;
-	}
-
 	double ToDouble() const
 	{
 		union
@@ -248,157 +258,6 @@ struct DiyFp
 	int e;
 };
 
-inline unsigned CountDecimalDigit32( uint32_t n )
-{
-	// Simple pure C++ implementation was faster than __builtin_clz version in
-	// this situation.
-	if ( n < 10 )
-		return 1;
-	if ( n < 100 )
-		return 2;
-	if ( n < 1000 )
-		return 3;
-	if ( n < 10000 )
-		return 4;
-	if ( n < 100000 )
-		return 5;
-	if ( n < 1000000 )
-		return 6;
-	if ( n < 10000000 )
-		return 7;
-	if ( n < 100000000 )
-		return 8;
-	// Will not reach 10 digits in DigitGen()
-	// if (n < 1000000000) return 9;
-	// return 10;
-	return 9;
-}
-
-inline void GrisuRound( char *buffer,
-                        int len,
-                        uint64_t delta,
-                        uint64_t rest,
-                        uint64_t ten_kappa,
-                        uint64_t wp_w )
-{
-	while ( rest < wp_w && delta - rest >= ten_kappa &&
-	        ( rest + ten_kappa < wp_w || /// closer
-	          wp_w - rest > rest + ten_kappa - wp_w ) )
-	{
-		buffer[len - 1]--;
-		rest += ten_kappa;
-	}
-}
-
-inline void DigitGen( const DiyFp &W,
-                      const DiyFp &Mp,
-                      uint64_t delta,
-                      char *buffer,
-                      int *len,
-                      int *K )
-{
-	static const uint32_t kPow10[] = {1,
-	                                  10,
-	                                  100,
-	                                  1000,
-	                                  10000,
-	                                  100000,
-	                                  1000000,
-	                                  10000000,
-	                                  100000000,
-	                                  1000000000};
-	const DiyFp one( uint64_t( 1 ) << -Mp.e, Mp.e );
-	const DiyFp wp_w = Mp - W;
-	uint32_t p1 = static_cast<uint32_t>( Mp.f >> -one.e );
-	uint64_t p2 = Mp.f & ( one.f - 1 );
-	unsigned kappa = CountDecimalDigit32( p1 ); // kappa in [0, 9]
-	*len = 0;
-
-	while ( kappa > 0 )
-	{
-		uint32_t d = 0;
-		switch ( kappa )
-		{
-			case 9:
-				d = p1 / 100000000;
-				p1 %= 100000000;
-				break;
-			case 8:
-				d = p1 / 10000000;
-				p1 %= 10000000;
-				break;
-			case 7:
-				d = p1 / 1000000;
-				p1 %= 1000000;
-				break;
-			case 6:
-				d = p1 / 100000;
-				p1 %= 100000;
-				break;
-			case 5:
-				d = p1 / 10000;
-				p1 %= 10000;
-				break;
-			case 4:
-				d = p1 / 1000;
-				p1 %= 1000;
-				break;
-			case 3:
-				d = p1 / 100;
-				p1 %= 100;
-				break;
-			case 2:
-				d = p1 / 10;
-				p1 %= 10;
-				break;
-			case 1:
-				d = p1;
-				p1 = 0;
-				break;
-			default:;
-		}
-		if ( d || *len )
-			buffer[( *len )++] =
-			    static_cast<char>( '0' + static_cast<char>( d ) );
-		kappa--;
-		uint64_t tmp = ( static_cast<uint64_t>( p1 ) << -one.e ) + p2;
-		if ( tmp <= delta )
-		{
-			*K += kappa;
-			GrisuRound( buffer,
-			            *len,
-			            delta,
-			            tmp,
-			            static_cast<uint64_t>( kPow10[kappa] ) << -one.e,
-			            wp_w.f );
-			return;
-		}
-	}
-
-	// kappa = 0
-	for ( ;; )
-	{
-		p2 *= 10;
-		delta *= 10;
-		char d = static_cast<char>( p2 >> -one.e );
-		if ( d || *len )
-			buffer[( *len )++] = static_cast<char>( '0' + d );
-		p2 &= one.f - 1;
-		kappa--;
-		if ( p2 < delta )
-		{
-			*K += kappa;
-			GrisuRound( buffer,
-			            *len,
-			            delta,
-			            p2,
-			            one.f,
-			            wp_w.f * kPow10[-static_cast<int>( kappa )] );
-			return;
-		}
-	}
-}
-
 inline DiyFp GetCachedPowerByIndex( size_t index )
 {
 	// 10^-348, 10^-340, ..., 10^340
@@ -503,37 +362,6 @@ inline DiyFp GetCachedPowerByIndex( size_t index )
 	return DiyFp( kCachedPowers_F[index], kCachedPowers_E[index] );
 }
 
-inline DiyFp GetCachedPower( int e, int *K )
-{
-	// int k = static_cast<int>(ceil((-61 - e) * 0.30102999566398114)) + 374;
-	double dk = ( -61 - e ) * 0.30102999566398114 +
-	            347; // dk must be positive, so can do ceiling in positive
-	int k = static_cast<int>( dk );
-	if ( dk - k > 0.0 )
-		k++;
-
-	unsigned index = static_cast<unsigned>( ( k >> 3 ) + 1 );
-	*K = -( -348 + static_cast<int>(
-	                   index << 3 ) ); // decimal exponent no need lookup table
-
-	return GetCachedPowerByIndex( index );
-}
-
-inline void Grisu2( double value, char *buffer, int *length, int *K )
-{
-	const DiyFp v( value );
-	DiyFp w_m, w_p;
-	v.NormalizedBoundaries( &w_m, &w_p );
-
-	const DiyFp c_mk = GetCachedPower( w_p.e, K );
-	const DiyFp W = v.Normalize() * c_mk;
-	DiyFp Wp = w_p * c_mk;
-	DiyFp Wm = w_m * c_mk;
-	Wm.f++;
-	Wp.f--;
-	DigitGen( W, Wp, Wp.f - Wm.f, buffer, length, K );
-}
-
 inline const char *GetDigitsLut()
 {
 	static const char cDigitsLut[200] = {
@@ -555,84 +383,6 @@ inline const char *GetDigitsLut()
 	return cDigitsLut;
 }
 
-inline char *WriteExponent( int K, char *buffer )
-{
-	if ( K < 0 )
-	{
-		*buffer++ = '-';
-		K = -K;
-	}
-
-	if ( K >= 100 )
-	{
-		*buffer++ = static_cast<char>( '0' + static_cast<char>( K / 100 ) );
-		K %= 100;
-		const char *d = GetDigitsLut() + K * 2;
-		*buffer++ = d[0];
-		*buffer++ = d[1];
-	}
-	else if ( K >= 10 )
-	{
-		const char *d = GetDigitsLut() + K * 2;
-		*buffer++ = d[0];
-		*buffer++ = d[1];
-	}
-	else
-		*buffer++ = static_cast<char>( '0' + static_cast<char>( K ) );
-
-	return buffer;
-}
-
-inline char *Prettify( char *buffer, int length, int k )
-{
-	const int kk = length + k; // 10^(kk-1) <= v < 10^kk
-
-	if ( length <= kk && kk <= 21 )
-	{
-		// 1234e7 -> 12340000000
-		for ( int i = length; i < kk; i++ )
-			buffer[i] = '0';
-		buffer[kk] = '.';
-		buffer[kk + 1] = '0';
-		return &buffer[kk + 2];
-	}
-	else if ( 0 < kk && kk <= 21 )
-	{
-		// 1234e-2 -> 12.34
-		std::memmove(
-		    &buffer[kk + 1], &buffer[kk], static_cast<size_t>( length - kk ) );
-		buffer[kk] = '.';
-		return &buffer[length + 1];
-	}
-	else if ( -6 < kk && kk <= 0 )
-	{
-		// 1234e-6 -> 0.001234
-		const int offset = 2 - kk;
-		std::memmove(
-		    &buffer[offset], &buffer[0], static_cast<size_t>( length ) );
-		buffer[0] = '0';
-		buffer[1] = '.';
-		for ( int i = 2; i < offset; i++ )
-			buffer[i] = '0';
-		return &buffer[length + offset];
-	}
-	else if ( length == 1 )
-	{
-		// 1e30
-		buffer[1] = 'e';
-		return WriteExponent( kk - 1, &buffer[2] );
-	}
-	else
-	{
-		// 1234e30 -> 1.234e33
-		std::memmove(
-		    &buffer[2], &buffer[1], static_cast<size_t>( length - 1 ) );
-		buffer[1] = '.';
-		buffer[length + 1] = 'e';
-		return WriteExponent( kk - 1, &buffer[0 + length + 2] );
-	}
-}
-
 template<typename N, int B = sizeof( N ), bool S = std::is_signed_v<N>>
 struct numtoa_impl
 {
@@ -942,27 +692,7 @@ struct numtoa_impl<double>
 {
 	static char *impl( double value, char *buffer )
 	{
-		Double d( value );
-		if ( d.IsZero() )
-		{
-			if ( d.Sign() )
-				*buffer++ = '-'; // -0.0, Issue #289
-			buffer[0] = '0';
-			buffer[1] = '.';
-			buffer[2] = '0';
-			return &buffer[3];
-		}
-		else
-		{
-			if ( value < 0 )
-			{
-				*buffer++ = '-';
-				value = -value;
-			}
-			int length, K;
-			Grisu2( value, buffer, &length, &K );
-			return Prettify( buffer, length, K );
-		}
+		return su::dtoa( value, buffer );
 	}
 };
 
@@ -1282,9 +1012,7 @@ public:
 
 		if ( interShift == 0 )
 		{
-			std::memmove( &digits_[count_ - 1 + offset],
-			              &digits_[count_ - 1],
-			              count_ * sizeof( Type ) );
+			std::memmove( digits_ + offset, digits_, count_ * sizeof( Type ) );
 			count_ += offset;
 		}
 		else
@@ -1575,28 +1303,14 @@ inline double StrtodBigInteger( double approx,
 		return a.NextPositiveDouble();
 }
 
-inline double StrtodFullPrecision( double d,
-                                   int p,
-                                   const char *decimals,
+// Digits to double, when all else failed. decimals has no leading zeros.
+inline double StrtodFullPrecision( const char *decimals,
                                    size_t length,
                                    size_t decimalPosition,
                                    int exp )
 {
-	assert( d >= 0.0 );
 	assert( length >= 1 );
 
-	double result;
-	if ( StrtodFast( d, p, &result ) )
-		return result;
-
-	// Trim leading zeros
-	while ( *decimals == '0' && length > 1 )
-	{
-		length--;
-		decimals++;
-		decimalPosition--;
-	}
-
 	// Trim trailing zeros
 	while ( decimals[length - 1] == '0' && length > 1 )
 	{
@@ -1604,6 +1318,8 @@ inline double StrtodFullPrecision( double d,
 		decimalPosition--;
 		exp++;
 	}
+	if ( length == 1 && decimals[0] == '0' )
+		return 0.0;
 
 	// Trim right-most digits
 	const int kMaxDecimalDigit = 780;
@@ -1619,6 +1335,7 @@ inline double StrtodFullPrecision( double d,
 	if ( int( length ) + exp < -324 )
 		return 0.0;
 
+	double result;
 	if ( StrtodDiyFp( decimals, length, decimalPosition, exp, &result ) )
 		return result;
 
@@ -1627,6 +1344,498 @@ inline double StrtodFullPrecision( double d,
 	return StrtodBigInteger( result, decimals, length, decimalPosition, exp );
 }
 
+/* * * * * * * * * * * * * * * * * * * *
+ * Eisel-Lemire
+ *
+ *  Daniel Lemire, "Number Parsing at a Gigabyte per Second", from fast_float
+ *  (https://github.com/fastfloat/fast_float). w * 10^q is computed with a
+ *  128 bits approximation of 5^q, exact for all but a few inputs that are
+ *  detected and left to StrtodFullPrecision.
+ */
+
+const int kSmallestPowerOfFive = -342;
+const int kLargestPowerOfFive = 308;
+
+// 5^q for q in [-342, 308], normalized and truncated to 128 bits, high
+// 64 bits first
+const uint64_t kPowerOfFive128[] = {
+	0xeef453d6923bd65a, 0x113faa2906a13b3f, 0x9558b4661b6565f8, 0x4ac7ca59a424c507,
+	0xbaaee17fa23ebf76, 0x5d79bcf00d2df649, 0xe95a99df8ace6f53, 0xf4d82c2c107973dc,
+	0x91d8a02bb6c10594, 0x79071b9b8a4be869, 0xb64ec836a47146f9, 0x9748e2826cdee284,
+	0xe3e27a444d8d98b7, 0xfd1b1b2308169b25, 0x8e6d8c6ab0787f72, 0xfe30f0f5e50e20f7,
+	0xb208ef855c969f4f, 0xbdbd2d335e51a935, 0xde8b2b66b3bc4723, 0xad2c788035e61382,
+	0x8b16fb203055ac76, 0x4c3bcb5021afcc31, 0xaddcb9e83c6b1793, 0xdf4abe242a1bbf3d,
+	0xd953e8624b85dd78, 0xd71d6dad34a2af0d, 0x87d4713d6f33aa6b, 0x8672648c40e5ad68,
+	0xa9c98d8ccb009506, 0x680efdaf511f18c2, 0xd43bf0effdc0ba48, 0x0212bd1b2566def2,
+	0x84a57695fe98746d, 0x014bb630f7604b57, 0xa5ced43b7e3e9188, 0x419ea3bd35385e2d,
+	0xcf42894a5dce35ea, 0x52064cac828675b9, 0x818995ce7aa0e1b2, 0x7343efebd1940993,
+	0xa1ebfb4219491a1f, 0x1014ebe6c5f90bf8, 0xca66fa129f9b60a6, 0xd41a26e077774ef6,
+	0xfd00b897478238d0, 0x8920b098955522b4, 0x9e20735e8cb16382, 0x55b46e5f5d5535b0,
+	0xc5a890362fddbc62, 0xeb2189f734aa831d, 0xf712b443bbd52b7b, 0xa5e9ec7501d523e4,
+	0x9a6bb0aa55653b2d, 0x47b233c92125366e, 0xc1069cd4eabe89f8, 0x999ec0bb696e840a,
+	0xf148440a256e2c76, 0xc00670ea43ca250d, 0x96cd2a865764dbca, 0x380406926a5e5728,
+	0xbc807527ed3e12bc, 0xc605083704f5ecf2, 0xeba09271e88d976b, 0xf7864a44c633682e,
+	0x93445b8731587ea3, 0x7ab3ee6afbe0211d, 0xb8157268fdae9e4c, 0x5960ea05bad82964,
+	0xe61acf033d1a45df, 0x6fb92487298e33bd, 0x8fd0c16206306bab, 0xa5d3b6d479f8e056,
+	0xb3c4f1ba87bc8696, 0x8f48a4899877186c, 0xe0b62e2929aba83c, 0x331acdabfe94de87,
+	0x8c71dcd9ba0b4925, 0x9ff0c08b7f1d0b14, 0xaf8e5410288e1b6f, 0x07ecf0ae5ee44dd9,
+	0xdb71e91432b1a24a, 0xc9e82cd9f69d6150, 0x892731ac9faf056e, 0xbe311c083a225cd2,
+	0xab70fe17c79ac6ca, 0x6dbd630a48aaf406, 0xd64d3d9db981787d, 0x092cbbccdad5b108,
+	0x85f0468293f0eb4e, 0x25bbf56008c58ea5, 0xa76c582338ed2621, 0xaf2af2b80af6f24e,
+	0xd1476e2c07286faa, 0x1af5af660db4aee1, 0x82cca4db847945ca, 0x50d98d9fc890ed4d,
+	0xa37fce126597973c, 0xe50ff107bab528a0, 0xcc5fc196fefd7d0c, 0x1e53ed49a96272c8,
+	0xff77b1fcbebcdc4f, 0x25e8e89c13bb0f7a, 0x9faacf3df73609b1, 0x77b191618c54e9ac,
+	0xc795830d75038c1d, 0xd59df5b9ef6a2417, 0xf97ae3d0d2446f25, 0x4b0573286b44ad1d,
+	0x9becce62836ac577, 0x4ee367f9430aec32, 0xc2e801fb244576d5, 0x229c41f793cda73f,
+	0xf3a20279ed56d48a, 0x6b43527578c1110f, 0x9845418c345644d6, 0x830a13896b78aaa9,
+	0xbe5691ef416bd60c, 0x23cc986bc656d553, 0xedec366b11c6cb8f, 0x2cbfbe86b7ec8aa8,
+	0x94b3a202eb1c3f39, 0x7bf7d71432f3d6a9, 0xb9e08a83a5e34f07, 0xdaf5ccd93fb0cc53,
+	0xe858ad248f5c22c9, 0xd1b3400f8f9cff68, 0x91376c36d99995be, 0x23100809b9c21fa1,
+	0xb58547448ffffb2d, 0xabd40a0c2832a78a, 0xe2e69915b3fff9f9, 0x16c90c8f323f516c,
+	0x8dd01fad907ffc3b, 0xae3da7d97f6792e3, 0xb1442798f49ffb4a, 0x99cd11cfdf41779c,
+	0xdd95317f31c7fa1d, 0x40405643d711d583, 0x8a7d3eef7f1cfc52, 0x482835ea666b2572,
+	0xad1c8eab5ee43b66, 0xda3243650005eecf, 0xd863b256369d4a40, 0x90bed43e40076a82,
+	0x873e4f75e2224e68, 0x5a7744a6e804a291, 0xa90de3535aaae202, 0x711515d0a205cb36,
+	0xd3515c2831559a83, 0x0d5a5b44ca873e03, 0x8412d9991ed58091, 0xe858790afe9486c2,
+	0xa5178fff668ae0b6, 0x626e974dbe39a872, 0xce5d73ff402d98e3, 0xfb0a3d212dc8128f,
+	0x80fa687f881c7f8e, 0x7ce66634bc9d0b99, 0xa139029f6a239f72, 0x1c1fffc1ebc44e80,
+	0xc987434744ac874e, 0xa327ffb266b56220, 0xfbe9141915d7a922, 0x4bf1ff9f0062baa8,
+	0x9d71ac8fada6c9b5, 0x6f773fc3603db4a9, 0xc4ce17b399107c22, 0xcb550fb4384d21d3,
+	0xf6019da07f549b2b, 0x7e2a53a146606a48, 0x99c102844f94e0fb, 0x2eda7444cbfc426d,
+	0xc0314325637a1939, 0xfa911155fefb5308, 0xf03d93eebc589f88, 0x793555ab7eba27ca,
+	0x96267c7535b763b5, 0x4bc1558b2f3458de, 0xbbb01b9283253ca2, 0x9eb1aaedfb016f16,
+	0xea9c227723ee8bcb, 0x465e15a979c1cadc, 0x92a1958a7675175f, 0x0bfacd89ec191ec9,
+	0xb749faed14125d36, 0xcef980ec671f667b, 0xe51c79a85916f484, 0x82b7e12780e7401a,
+	0x8f31cc0937ae58d2, 0xd1b2ecb8b0908810, 0xb2fe3f0b8599ef07, 0x861fa7e6dcb4aa15,
+	0xdfbdcece67006ac9, 0x67a791e093e1d49a, 0x8bd6a141006042bd, 0xe0c8bb2c5c6d24e0,
+	0xaecc49914078536d, 0x58fae9f773886e18, 0xda7f5bf590966848, 0xaf39a475506a899e,
+	0x888f99797a5e012d, 0x6d8406c952429603, 0xaab37fd7d8f58178, 0xc8e5087ba6d33b83,
+	0xd5605fcdcf32e1d6, 0xfb1e4a9a90880a64, 0x855c3be0a17fcd26, 0x5cf2eea09a55067f,
+	0xa6b34ad8c9dfc06f, 0xf42faa48c0ea481e, 0xd0601d8efc57b08b, 0xf13b94daf124da26,
+	0x823c12795db6ce57, 0x76c53d08d6b70858, 0xa2cb1717b52481ed, 0x54768c4b0c64ca6e,
+	0xcb7ddcdda26da268, 0xa9942f5dcf7dfd09, 0xfe5d54150b090b02, 0xd3f93b35435d7c4c,
+	0x9efa548d26e5a6e1, 0xc47bc5014a1a6daf, 0xc6b8e9b0709f109a, 0x359ab6419ca1091b,
+	0xf867241c8cc6d4c0, 0xc30163d203c94b62, 0x9b407691d7fc44f8, 0x79e0de63425dcf1d,
+	0xc21094364dfb5636, 0x985915fc12f542e4, 0xf294b943e17a2bc4, 0x3e6f5b7b17b2939d,
+	0x979cf3ca6cec5b5a, 0xa705992ceecf9c42, 0xbd8430bd08277231, 0x50c6ff782a838353,
+	0xece53cec4a314ebd, 0xa4f8bf5635246428, 0x940f4613ae5ed136, 0x871b7795e136be99,
+	0xb913179899f68584, 0x28e2557b59846e3f, 0xe757dd7ec07426e5, 0x331aeada2fe589cf,
+	0x9096ea6f3848984f, 0x3ff0d2c85def7621, 0xb4bca50b065abe63, 0x0fed077a756b53a9,
+	0xe1ebce4dc7f16dfb, 0xd3e8495912c62894, 0x8d3360f09cf6e4bd, 0x64712dd7abbbd95c,
+	0xb080392cc4349dec, 0xbd8d794d96aacfb3, 0xdca04777f541c567, 0xecf0d7a0fc5583a0,
+	0x89e42caaf9491b60, 0xf41686c49db57244, 0xac5d37d5b79b6239, 0x311c2875c522ced5,
+	0xd77485cb25823ac7, 0x7d633293366b828b, 0x86a8d39ef77164bc, 0xae5dff9c02033197,
+	0xa8530886b54dbdeb, 0xd9f57f830283fdfc, 0xd267caa862a12d66, 0xd072df63c324fd7b,
+	0x8380dea93da4bc60, 0x4247cb9e59f71e6d, 0xa46116538d0deb78, 0x52d9be85f074e608,
+	0xcd795be870516656, 0x67902e276c921f8b, 0x806bd9714632dff6, 0x00ba1cd8a3db53b6,
+	0xa086cfcd97bf97f3, 0x80e8a40eccd228a4, 0xc8a883c0fdaf7df0, 0x6122cd128006b2cd,
+	0xfad2a4b13d1b5d6c, 0x796b805720085f81, 0x9cc3a6eec6311a63, 0xcbe3303674053bb0,
+	0xc3f490aa77bd60fc, 0xbedbfc4411068a9c, 0xf4f1b4d515acb93b, 0xee92fb5515482d44,
+	0x991711052d8bf3c5, 0x751bdd152d4d1c4a, 0xbf5cd54678eef0b6, 0xd262d45a78a0635d,
+	0xef340a98172aace4, 0x86fb897116c87c34, 0x9580869f0e7aac0e, 0xd45d35e6ae3d4da0,
+	0xbae0a846d2195712, 0x8974836059cca109, 0xe998d258869facd7, 0x2bd1a438703fc94b,
+	0x91ff83775423cc06, 0x7b6306a34627ddcf, 0xb67f6455292cbf08, 0x1a3bc84c17b1d542,
+	0xe41f3d6a7377eeca, 0x20caba5f1d9e4a93, 0x8e938662882af53e, 0x547eb47b7282ee9c,
+	0xb23867fb2a35b28d, 0xe99e619a4f23aa43, 0xdec681f9f4c31f31, 0x6405fa00e2ec94d4,
+	0x8b3c113c38f9f37e, 0xde83bc408dd3dd04, 0xae0b158b4738705e, 0x9624ab50b148d445,
+	0xd98ddaee19068c76, 0x3badd624dd9b0957, 0x87f8a8d4cfa417c9, 0xe54ca5d70a80e5d6,
+	0xa9f6d30a038d1dbc, 0x5e9fcf4ccd211f4c, 0xd47487cc8470652b, 0x7647c3200069671f,
+	0x84c8d4dfd2c63f3b, 0x29ecd9f40041e073, 0xa5fb0a17c777cf09, 0xf468107100525890,
+	0xcf79cc9db955c2cc, 0x7182148d4066eeb4, 0x81ac1fe293d599bf, 0xc6f14cd848405530,
+	0xa21727db38cb002f, 0xb8ada00e5a506a7c, 0xca9cf1d206fdc03b, 0xa6d90811f0e4851c,
+	0xfd442e4688bd304a, 0x908f4a166d1da663, 0x9e4a9cec15763e2e, 0x9a598e4e043287fe,
+	0xc5dd44271ad3cdba, 0x40eff1e1853f29fd, 0xf7549530e188c128, 0xd12bee59e68ef47c,
+	0x9a94dd3e8cf578b9, 0x82bb74f8301958ce, 0xc13a148e3032d6e7, 0xe36a52363c1faf01,
+	0xf18899b1bc3f8ca1, 0xdc44e6c3cb279ac1, 0x96f5600f15a7b7e5, 0x29ab103a5ef8c0b9,
+	0xbcb2b812db11a5de, 0x7415d448f6b6f0e7, 0xebdf661791d60f56, 0x111b495b3464ad21,
+	0x936b9fcebb25c995, 0xcab10dd900beec34, 0xb84687c269ef3bfb, 0x3d5d514f40eea742,
+	0xe65829b3046b0afa, 0x0cb4a5a3112a5112, 0x8ff71a0fe2c2e6dc, 0x47f0e785eaba72ab,
+	0xb3f4e093db73a093, 0x59ed216765690f56, 0xe0f218b8d25088b8, 0x306869c13ec3532c,
+	0x8c974f7383725573, 0x1e414218c73a13fb, 0xafbd2350644eeacf, 0xe5d1929ef90898fa,
+	0xdbac6c247d62a583, 0xdf45f746b74abf39, 0x894bc396ce5da772, 0x6b8bba8c328eb783,
+	0xab9eb47c81f5114f, 0x066ea92f3f326564, 0xd686619ba27255a2, 0xc80a537b0efefebd,
+	0x8613fd0145877585, 0xbd06742ce95f5f36, 0xa798fc4196e952e7, 0x2c48113823b73704,
+	0xd17f3b51fca3a7a0, 0xf75a15862ca504c5, 0x82ef85133de648c4, 0x9a984d73dbe722fb,
+	0xa3ab66580d5fdaf5, 0xc13e60d0d2e0ebba, 0xcc963fee10b7d1b3, 0x318df905079926a8,
+	0xffbbcfe994e5c61f, 0xfdf17746497f7052, 0x9fd561f1fd0f9bd3, 0xfeb6ea8bedefa633,
+	0xc7caba6e7c5382c8, 0xfe64a52ee96b8fc0, 0xf9bd690a1b68637b, 0x3dfdce7aa3c673b0,
+	0x9c1661a651213e2d, 0x06bea10ca65c084e, 0xc31bfa0fe5698db8, 0x486e494fcff30a62,
+	0xf3e2f893dec3f126, 0x5a89dba3c3efccfa, 0x986ddb5c6b3a76b7, 0xf89629465a75e01c,
+	0xbe89523386091465, 0xf6bbb397f1135823, 0xee2ba6c0678b597f, 0x746aa07ded582e2c,
+	0x94db483840b717ef, 0xa8c2a44eb4571cdc, 0xba121a4650e4ddeb, 0x92f34d62616ce413,
+	0xe896a0d7e51e1566, 0x77b020baf9c81d17, 0x915e2486ef32cd60, 0x0ace1474dc1d122e,
+	0xb5b5ada8aaff80b8, 0x0d819992132456ba, 0xe3231912d5bf60e6, 0x10e1fff697ed6c69,
+	0x8df5efabc5979c8f, 0xca8d3ffa1ef463c1, 0xb1736b96b6fd83b3, 0xbd308ff8a6b17cb2,
+	0xddd0467c64bce4a0, 0xac7cb3f6d05ddbde, 0x8aa22c0dbef60ee4, 0x6bcdf07a423aa96b,
+	0xad4ab7112eb3929d, 0x86c16c98d2c953c6, 0xd89d64d57a607744, 0xe871c7bf077ba8b7,
+	0x87625f056c7c4a8b, 0x11471cd764ad4972, 0xa93af6c6c79b5d2d, 0xd598e40d3dd89bcf,
+	0xd389b47879823479, 0x4aff1d108d4ec2c3, 0x843610cb4bf160cb, 0xcedf722a585139ba,
+	0xa54394fe1eedb8fe, 0xc2974eb4ee658828, 0xce947a3da6a9273e, 0x733d226229feea32,
+	0x811ccc668829b887, 0x0806357d5a3f525f, 0xa163ff802a3426a8, 0xca07c2dcb0cf26f7,
+	0xc9bcff6034c13052, 0xfc89b393dd02f0b5, 0xfc2c3f3841f17c67, 0xbbac2078d443ace2,
+	0x9d9ba7832936edc0, 0xd54b944b84aa4c0d, 0xc5029163f384a931, 0x0a9e795e65d4df11,
+	0xf64335bcf065d37d, 0x4d4617b5ff4a16d5, 0x99ea0196163fa42e, 0x504bced1bf8e4e45,
+	0xc06481fb9bcf8d39, 0xe45ec2862f71e1d6, 0xf07da27a82c37088, 0x5d767327bb4e5a4c,
+	0x964e858c91ba2655, 0x3a6a07f8d510f86f, 0xbbe226efb628afea, 0x890489f70a55368b,
+	0xeadab0aba3b2dbe5, 0x2b45ac74ccea842e, 0x92c8ae6b464fc96f, 0x3b0b8bc90012929d,
+	0xb77ada0617e3bbcb, 0x09ce6ebb40173744, 0xe55990879ddcaabd, 0xcc420a6a101d0515,
+	0x8f57fa54c2a9eab6, 0x9fa946824a12232d, 0xb32df8e9f3546564, 0x47939822dc96abf9,
+	0xdff9772470297ebd, 0x59787e2b93bc56f7, 0x8bfbea76c619ef36, 0x57eb4edb3c55b65a,
+	0xaefae51477a06b03, 0xede622920b6b23f1, 0xdab99e59958885c4, 0xe95fab368e45eced,
+	0x88b402f7fd75539b, 0x11dbcb0218ebb414, 0xaae103b5fcd2a881, 0xd652bdc29f26a119,
+	0xd59944a37c0752a2, 0x4be76d3346f0495f, 0x857fcae62d8493a5, 0x6f70a4400c562ddb,
+	0xa6dfbd9fb8e5b88e, 0xcb4ccd500f6bb952, 0xd097ad07a71f26b2, 0x7e2000a41346a7a7,
+	0x825ecc24c873782f, 0x8ed400668c0c28c8, 0xa2f67f2dfa90563b, 0x728900802f0f32fa,
+	0xcbb41ef979346bca, 0x4f2b40a03ad2ffb9, 0xfea126b7d78186bc, 0xe2f610c84987bfa8,
+	0x9f24b832e6b0f436, 0x0dd9ca7d2df4d7c9, 0xc6ede63fa05d3143, 0x91503d1c79720dbb,
+	0xf8a95fcf88747d94, 0x75a44c6397ce912a, 0x9b69dbe1b548ce7c, 0xc986afbe3ee11aba,
+	0xc24452da229b021b, 0xfbe85badce996168, 0xf2d56790ab41c2a2, 0xfae27299423fb9c3,
+	0x97c560ba6b0919a5, 0xdccd879fc967d41a, 0xbdb6b8e905cb600f, 0x5400e987bbc1c920,
+	0xed246723473e3813, 0x290123e9aab23b68, 0x9436c0760c86e30b, 0xf9a0b6720aaf6521,
+	0xb94470938fa89bce, 0xf808e40e8d5b3e69, 0xe7958cb87392c2c2, 0xb60b1d1230b20e04,
+	0x90bd77f3483bb9b9, 0xb1c6f22b5e6f48c2, 0xb4ecd5f01a4aa828, 0x1e38aeb6360b1af3,
+	0xe2280b6c20dd5232, 0x25c6da63c38de1b0, 0x8d590723948a535f, 0x579c487e5a38ad0e,
+	0xb0af48ec79ace837, 0x2d835a9df0c6d851, 0xdcdb1b2798182244, 0xf8e431456cf88e65,
+	0x8a08f0f8bf0f156b, 0x1b8e9ecb641b58ff, 0xac8b2d36eed2dac5, 0xe272467e3d222f3f,
+	0xd7adf884aa879177, 0x5b0ed81dcc6abb0f, 0x86ccbb52ea94baea, 0x98e947129fc2b4e9,
+	0xa87fea27a539e9a5, 0x3f2398d747b36224, 0xd29fe4b18e88640e, 0x8eec7f0d19a03aad,
+	0x83a3eeeef9153e89, 0x1953cf68300424ac, 0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7,
+	0xcdb02555653131b6, 0x3792f412cb06794d, 0x808e17555f3ebf11, 0xe2bbd88bbee40bd0,
+	0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4, 0xc8de047564d20a8b, 0xf245825a5a445275,
+	0xfb158592be068d2e, 0xeed6e2f0f0d56712, 0x9ced737bb6c4183d, 0x55464dd69685606b,
+	0xc428d05aa4751e4c, 0xaa97e14c3c26b886, 0xf53304714d9265df, 0xd53dd99f4b3066a8,
+	0x993fe2c6d07b7fab, 0xe546a8038efe4029, 0xbf8fdb78849a5f96, 0xde98520472bdd033,
+	0xef73d256a5c0f77c, 0x963e66858f6d4440, 0x95a8637627989aad, 0xdde7001379a44aa8,
+	0xbb127c53b17ec159, 0x5560c018580d5d52, 0xe9d71b689dde71af, 0xaab8f01e6e10b4a6,
+	0x9226712162ab070d, 0xcab3961304ca70e8, 0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22,
+	0xe45c10c42a2b3b05, 0x8cb89a7db77c506a, 0x8eb98a7a9a5b04e3, 0x77f3608e92adb242,
+	0xb267ed1940f1c61c, 0x55f038b237591ed3, 0xdf01e85f912e37a3, 0x6b6c46dec52f6688,
+	0x8b61313bbabce2c6, 0x2323ac4b3b3da015, 0xae397d8aa96c1b77, 0xabec975e0a0d081a,
+	0xd9c7dced53c72255, 0x96e7bd358c904a21, 0x881cea14545c7575, 0x7e50d64177da2e54,
+	0xaa242499697392d2, 0xdde50bd1d5d0b9e9, 0xd4ad2dbfc3d07787, 0x955e4ec64b44e864,
+	0x84ec3c97da624ab4, 0xbd5af13bef0b113e, 0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e,
+	0xcfb11ead453994ba, 0x67de18eda5814af2, 0x81ceb32c4b43fcf4, 0x80eacf948770ced7,
+	0xa2425ff75e14fc31, 0xa1258379a94d028d, 0xcad2f7f5359a3b3e, 0x096ee45813a04330,
+	0xfd87b5f28300ca0d, 0x8bca9d6e188853fc, 0x9e74d1b791e07e48, 0x775ea264cf55347e,
+	0xc612062576589dda, 0x95364afe032a819e, 0xf79687aed3eec551, 0x3a83ddbd83f52205,
+	0x9abe14cd44753b52, 0xc4926a9672793543, 0xc16d9a0095928a27, 0x75b7053c0f178294,
+	0xf1c90080baf72cb1, 0x5324c68b12dd6339, 0x971da05074da7bee, 0xd3f6fc16ebca5e04,
+	0xbce5086492111aea, 0x88f4bb1ca6bcf585, 0xec1e4a7db69561a5, 0x2b31e9e3d06c32e6,
+	0x9392ee8e921d5d07, 0x3aff322e62439fd0, 0xb877aa3236a4b449, 0x09befeb9fad487c3,
+	0xe69594bec44de15b, 0x4c2ebe687989a9b4, 0x901d7cf73ab0acd9, 0x0f9d37014bf60a11,
+	0xb424dc35095cd80f, 0x538484c19ef38c95, 0xe12e13424bb40e13, 0x2865a5f206b06fba,
+	0x8cbccc096f5088cb, 0xf93f87b7442e45d4, 0xafebff0bcb24aafe, 0xf78f69a51539d749,
+	0xdbe6fecebdedd5be, 0xb573440e5a884d1c, 0x89705f4136b4a597, 0x31680a88f8953031,
+	0xabcc77118461cefc, 0xfdc20d2b36ba7c3e, 0xd6bf94d5e57a42bc, 0x3d32907604691b4d,
+	0x8637bd05af6c69b5, 0xa63f9a49c2c1b110, 0xa7c5ac471b478423, 0x0fcf80dc33721d54,
+	0xd1b71758e219652b, 0xd3c36113404ea4a9, 0x83126e978d4fdf3b, 0x645a1cac083126ea,
+	0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a4, 0xcccccccccccccccc, 0xcccccccccccccccd,
+	0x8000000000000000, 0x0000000000000000, 0xa000000000000000, 0x0000000000000000,
+	0xc800000000000000, 0x0000000000000000, 0xfa00000000000000, 0x0000000000000000,
+	0x9c40000000000000, 0x0000000000000000, 0xc350000000000000, 0x0000000000000000,
+	0xf424000000000000, 0x0000000000000000, 0x9896800000000000, 0x0000000000000000,
+	0xbebc200000000000, 0x0000000000000000, 0xee6b280000000000, 0x0000000000000000,
+	0x9502f90000000000, 0x0000000000000000, 0xba43b74000000000, 0x0000000000000000,
+	0xe8d4a51000000000, 0x0000000000000000, 0x9184e72a00000000, 0x0000000000000000,
+	0xb5e620f480000000, 0x0000000000000000, 0xe35fa931a0000000, 0x0000000000000000,
+	0x8e1bc9bf04000000, 0x0000000000000000, 0xb1a2bc2ec5000000, 0x0000000000000000,
+	0xde0b6b3a76400000, 0x0000000000000000, 0x8ac7230489e80000, 0x0000000000000000,
+	0xad78ebc5ac620000, 0x0000000000000000, 0xd8d726b7177a8000, 0x0000000000000000,
+	0x878678326eac9000, 0x0000000000000000, 0xa968163f0a57b400, 0x0000000000000000,
+	0xd3c21bcecceda100, 0x0000000000000000, 0x84595161401484a0, 0x0000000000000000,
+	0xa56fa5b99019a5c8, 0x0000000000000000, 0xcecb8f27f4200f3a, 0x0000000000000000,
+	0x813f3978f8940984, 0x4000000000000000, 0xa18f07d736b90be5, 0x5000000000000000,
+	0xc9f2c9cd04674ede, 0xa400000000000000, 0xfc6f7c4045812296, 0x4d00000000000000,
+	0x9dc5ada82b70b59d, 0xf020000000000000, 0xc5371912364ce305, 0x6c28000000000000,
+	0xf684df56c3e01bc6, 0xc732000000000000, 0x9a130b963a6c115c, 0x3c7f400000000000,
+	0xc097ce7bc90715b3, 0x4b9f100000000000, 0xf0bdc21abb48db20, 0x1e86d40000000000,
+	0x96769950b50d88f4, 0x1314448000000000, 0xbc143fa4e250eb31, 0x17d955a000000000,
+	0xeb194f8e1ae525fd, 0x5dcfab0800000000, 0x92efd1b8d0cf37be, 0x5aa1cae500000000,
+	0xb7abc627050305ad, 0xf14a3d9e40000000, 0xe596b7b0c643c719, 0x6d9ccd05d0000000,
+	0x8f7e32ce7bea5c6f, 0xe4820023a2000000, 0xb35dbf821ae4f38b, 0xdda2802c8a800000,
+	0xe0352f62a19e306e, 0xd50b2037ad200000, 0x8c213d9da502de45, 0x4526f422cc340000,
+	0xaf298d050e4395d6, 0x9670b12b7f410000, 0xdaf3f04651d47b4c, 0x3c0cdd765f114000,
+	0x88d8762bf324cd0f, 0xa5880a69fb6ac800, 0xab0e93b6efee0053, 0x8eea0d047a457a00,
+	0xd5d238a4abe98068, 0x72a4904598d6d880, 0x85a36366eb71f041, 0x47a6da2b7f864750,
+	0xa70c3c40a64e6c51, 0x999090b65f67d924, 0xd0cf4b50cfe20765, 0xfff4b4e3f741cf6d,
+	0x82818f1281ed449f, 0xbff8f10e7a8921a4, 0xa321f2d7226895c7, 0xaff72d52192b6a0d,
+	0xcbea6f8ceb02bb39, 0x9bf4f8a69f764490, 0xfee50b7025c36a08, 0x02f236d04753d5b4,
+	0x9f4f2726179a2245, 0x01d762422c946590, 0xc722f0ef9d80aad6, 0x424d3ad2b7b97ef5,
+	0xf8ebad2b84e0d58b, 0xd2e0898765a7deb2, 0x9b934c3b330c8577, 0x63cc55f49f88eb2f,
+	0xc2781f49ffcfa6d5, 0x3cbf6b71c76b25fb, 0xf316271c7fc3908a, 0x8bef464e3945ef7a,
+	0x97edd871cfda3a56, 0x97758bf0e3cbb5ac, 0xbde94e8e43d0c8ec, 0x3d52eeed1cbea317,
+	0xed63a231d4c4fb27, 0x4ca7aaa863ee4bdd, 0x945e455f24fb1cf8, 0x8fe8caa93e74ef6a,
+	0xb975d6b6ee39e436, 0xb3e2fd538e122b44, 0xe7d34c64a9c85d44, 0x60dbbca87196b616,
+	0x90e40fbeea1d3a4a, 0xbc8955e946fe31cd, 0xb51d13aea4a488dd, 0x6babab6398bdbe41,
+	0xe264589a4dcdab14, 0xc696963c7eed2dd1, 0x8d7eb76070a08aec, 0xfc1e1de5cf543ca2,
+	0xb0de65388cc8ada8, 0x3b25a55f43294bcb, 0xdd15fe86affad912, 0x49ef0eb713f39ebe,
+	0x8a2dbf142dfcc7ab, 0x6e3569326c784337, 0xacb92ed9397bf996, 0x49c2c37f07965404,
+	0xd7e77a8f87daf7fb, 0xdc33745ec97be906, 0x86f0ac99b4e8dafd, 0x69a028bb3ded71a3,
+	0xa8acd7c0222311bc, 0xc40832ea0d68ce0c, 0xd2d80db02aabd62b, 0xf50a3fa490c30190,
+	0x83c7088e1aab65db, 0x792667c6da79e0fa, 0xa4b8cab1a1563f52, 0x577001b891185938,
+	0xcde6fd5e09abcf26, 0xed4c0226b55e6f86, 0x80b05e5ac60b6178, 0x544f8158315b05b4,
+	0xa0dc75f1778e39d6, 0x696361ae3db1c721, 0xc913936dd571c84c, 0x03bc3a19cd1e38e9,
+	0xfb5878494ace3a5f, 0x04ab48a04065c723, 0x9d174b2dcec0e47b, 0x62eb0d64283f9c76,
+	0xc45d1df942711d9a, 0x3ba5d0bd324f8394, 0xf5746577930d6500, 0xca8f44ec7ee36479,
+	0x9968bf6abbe85f20, 0x7e998b13cf4e1ecb, 0xbfc2ef456ae276e8, 0x9e3fedd8c321a67e,
+	0xefb3ab16c59b14a2, 0xc5cfe94ef3ea101e, 0x95d04aee3b80ece5, 0xbba1f1d158724a12,
+	0xbb445da9ca61281f, 0x2a8a6e45ae8edc97, 0xea1575143cf97226, 0xf52d09d71a3293bd,
+	0x924d692ca61be758, 0x593c2626705f9c56, 0xb6e0c377cfa2e12e, 0x6f8b2fb00c77836c,
+	0xe498f455c38b997a, 0x0b6dfb9c0f956447, 0x8edf98b59a373fec, 0x4724bd4189bd5eac,
+	0xb2977ee300c50fe7, 0x58edec91ec2cb657, 0xdf3d5e9bc0f653e1, 0x2f2967b66737e3ed,
+	0x8b865b215899f46c, 0xbd79e0d20082ee74, 0xae67f1e9aec07187, 0xecd8590680a3aa11,
+	0xda01ee641a708de9, 0xe80e6f4820cc9495, 0x884134fe908658b2, 0x3109058d147fdcdd,
+	0xaa51823e34a7eede, 0xbd4b46f0599fd415, 0xd4e5e2cdc1d1ea96, 0x6c9e18ac7007c91a,
+	0x850fadc09923329e, 0x03e2cf6bc604ddb0, 0xa6539930bf6bff45, 0x84db8346b786151c,
+	0xcfe87f7cef46ff16, 0xe612641865679a63, 0x81f14fae158c5f6e, 0x4fcb7e8f3f60c07e,
+	0xa26da3999aef7749, 0xe3be5e330f38f09d, 0xcb090c8001ab551c, 0x5cadf5bfd3072cc5,
+	0xfdcb4fa002162a63, 0x73d9732fc7c8f7f6, 0x9e9f11c4014dda7e, 0x2867e7fddcdd9afa,
+	0xc646d63501a1511d, 0xb281e1fd541501b8, 0xf7d88bc24209a565, 0x1f225a7ca91a4226,
+	0x9ae757596946075f, 0x3375788de9b06958, 0xc1a12d2fc3978937, 0x0052d6b1641c83ae,
+	0xf209787bb47d6b84, 0xc0678c5dbd23a49a, 0x9745eb4d50ce6332, 0xf840b7ba963646e0,
+	0xbd176620a501fbff, 0xb650e5a93bc3d898, 0xec5d3fa8ce427aff, 0xa3e51f138ab4cebe,
+	0x93ba47c980e98cdf, 0xc66f336c36b10137, 0xb8a8d9bbe123f017, 0xb80b0047445d4184,
+	0xe6d3102ad96cec1d, 0xa60dc059157491e5, 0x9043ea1ac7e41392, 0x87c89837ad68db2f,
+	0xb454e4a179dd1877, 0x29babe4598c311fb, 0xe16a1dc9d8545e94, 0xf4296dd6fef3d67a,
+	0x8ce2529e2734bb1d, 0x1899e4a65f58660c, 0xb01ae745b101e9e4, 0x5ec05dcff72e7f8f,
+	0xdc21a1171d42645d, 0x76707543f4fa1f73, 0x899504ae72497eba, 0x6a06494a791c53a8,
+	0xabfa45da0edbde69, 0x0487db9d17636892, 0xd6f8d7509292d603, 0x45a9d2845d3c42b6,
+	0x865b86925b9bc5c2, 0x0b8a2392ba45a9b2, 0xa7f26836f282b732, 0x8e6cac7768d7141e,
+	0xd1ef0244af2364ff, 0x3207d795430cd926, 0x8335616aed761f1f, 0x7f44e6bd49e807b8,
+	0xa402b9c5a8d3a6e7, 0x5f16206c9c6209a6, 0xcd036837130890a1, 0x36dba887c37a8c0f,
+	0x802221226be55a64, 0xc2494954da2c9789, 0xa02aa96b06deb0fd, 0xf2db9baa10b7bd6c,
+	0xc83553c5c8965d3d, 0x6f92829494e5acc7, 0xfa42a8b73abbf48c, 0xcb772339ba1f17f9,
+	0x9c69a97284b578d7, 0xff2a760414536efb, 0xc38413cf25e2d70d, 0xfef5138519684aba,
+	0xf46518c2ef5b8cd1, 0x7eb258665fc25d69, 0x98bf2f79d5993802, 0xef2f773ffbd97a61,
+	0xbeeefb584aff8603, 0xaafb550ffacfd8fa, 0xeeaaba2e5dbf6784, 0x95ba2a53f983cf38,
+	0x952ab45cfa97a0b2, 0xdd945a747bf26183, 0xba756174393d88df, 0x94f971119aeef9e4,
+	0xe912b9d1478ceb17, 0x7a37cd5601aab85d, 0x91abb422ccb812ee, 0xac62e055c10ab33a,
+	0xb616a12b7fe617aa, 0x577b986b314d6009, 0xe39c49765fdf9d94, 0xed5a7e85fda0b80b,
+	0x8e41ade9fbebc27d, 0x14588f13be847307, 0xb1d219647ae6b31c, 0x596eb2d8ae258fc8,
+	0xde469fbd99a05fe3, 0x6fca5f8ed9aef3bb, 0x8aec23d680043bee, 0x25de7bb9480d5854,
+	0xada72ccc20054ae9, 0xaf561aa79a10ae6a, 0xd910f7ff28069da4, 0x1b2ba1518094da04,
+	0x87aa9aff79042286, 0x90fb44d2f05d0842, 0xa99541bf57452b28, 0x353a1607ac744a53,
+	0xd3fa922f2d1675f2, 0x42889b8997915ce8, 0x847c9b5d7c2e09b7, 0x69956135febada11,
+	0xa59bc234db398c25, 0x43fab9837e699095, 0xcf02b2c21207ef2e, 0x94f967e45e03f4bb,
+	0x8161afb94b44f57d, 0x1d1be0eebac278f5, 0xa1ba1ba79e1632dc, 0x6462d92a69731732,
+	0xca28a291859bbf93, 0x7d7b8f7503cfdcfe, 0xfcb2cb35e702af78, 0x5cda735244c3d43e,
+	0x9defbf01b061adab, 0x3a0888136afa64a7, 0xc56baec21c7a1916, 0x088aaa1845b8fdd0,
+	0xf6c69a72a3989f5b, 0x8aad549e57273d45, 0x9a3c2087a63f6399, 0x36ac54e2f678864b,
+	0xc0cb28a98fcf3c7f, 0x84576a1bb416a7dd, 0xf0fdf2d3f3c30b9f, 0x656d44a2a11c51d5,
+	0x969eb7c47859e743, 0x9f644ae5a4b1b325, 0xbc4665b596706114, 0x873d5d9f0dde1fee,
+	0xeb57ff22fc0c7959, 0xa90cb506d155a7ea, 0x9316ff75dd87cbd8, 0x09a7f12442d588f2,
+	0xb7dcbf5354e9bece, 0x0c11ed6d538aeb2f, 0xe5d3ef282a242e81, 0x8f1668c8a86da5fa,
+	0x8fa475791a569d10, 0xf96e017d694487bc, 0xb38d92d760ec4455, 0x37c981dcc395a9ac,
+	0xe070f78d3927556a, 0x85bbe253f47b1417, 0x8c469ab843b89562, 0x93956d7478ccec8e,
+	0xaf58416654a6babb, 0x387ac8d1970027b2, 0xdb2e51bfe9d0696a, 0x06997b05fcc0319e,
+	0x88fcf317f22241e2, 0x441fece3bdf81f03, 0xab3c2fddeeaad25a, 0xd527e81cad7626c3,
+	0xd60b3bd56a5586f1, 0x8a71e223d8d3b074, 0x85c7056562757456, 0xf6872d5667844e49,
+	0xa738c6bebb12d16c, 0xb428f8ac016561db, 0xd106f86e69d785c7, 0xe13336d701beba52,
+	0x82a45b450226b39c, 0xecc0024661173473, 0xa34d721642b06084, 0x27f002d7f95d0190,
+	0xcc20ce9bd35c78a5, 0x31ec038df7b441f4, 0xff290242c83396ce, 0x7e67047175a15271,
+	0x9f79a169bd203e41, 0x0f0062c6e984d386, 0xc75809c42c684dd1, 0x52c07b78a3e60868,
+	0xf92e0c3537826145, 0xa7709a56ccdf8a82, 0x9bbcc7a142b17ccb, 0x88a66076400bb691,
+	0xc2abf989935ddbfe, 0x6acff893d00ea435, 0xf356f7ebf83552fe, 0x0583f6b8c4124d43,
+	0x98165af37b2153de, 0xc3727a337a8b704a, 0xbe1bf1b059e9a8d6, 0x744f18c0592e4c5c,
+	0xeda2ee1c7064130c, 0x1162def06f79df73, 0x9485d4d1c63e8be7, 0x8addcb5645ac2ba8,
+	0xb9a74a0637ce2ee1, 0x6d953e2bd7173692, 0xe8111c87c5c1ba99, 0xc8fa8db6ccdd0437,
+	0x910ab1d4db9914a0, 0x1d9c9892400a22a2, 0xb54d5e4a127f59c8, 0x2503beb6d00cab4b,
+	0xe2a0b5dc971f303a, 0x2e44ae64840fd61d, 0x8da471a9de737e24, 0x5ceaecfed289e5d2,
+	0xb10d8e1456105dad, 0x7425a83e872c5f47, 0xdd50f1996b947518, 0xd12f124e28f77719,
+	0x8a5296ffe33cc92f, 0x82bd6b70d99aaa6f, 0xace73cbfdc0bfb7b, 0x636cc64d1001550b,
+	0xd8210befd30efa5a, 0x3c47f7e05401aa4e, 0x8714a775e3e95c78, 0x65acfaec34810a71,
+	0xa8d9d1535ce3b396, 0x7f1839a741a14d0d, 0xd31045a8341ca07c, 0x1ede48111209a050,
+	0x83ea2b892091e44d, 0x934aed0aab460432, 0xa4e4b66b68b65d60, 0xf81da84d5617853f,
+	0xce1de40642e3f4b9, 0x36251260ab9d668e, 0x80d2ae83e9ce78f3, 0xc1d72b7c6b426019,
+	0xa1075a24e4421730, 0xb24cf65b8612f81f, 0xc94930ae1d529cfc, 0xdee033f26797b627,
+	0xfb9b7cd9a4a7443c, 0x169840ef017da3b1, 0x9d412e0806e88aa5, 0x8e1f289560ee864e,
+	0xc491798a08a2ad4e, 0xf1a6f2bab92a27e2, 0xf5b5d7ec8acb58a2, 0xae10af696774b1db,
+	0x9991a6f3d6bf1765, 0xacca6da1e0a8ef29, 0xbff610b0cc6edd3f, 0x17fd090a58d32af3,
+	0xeff394dcff8a948e, 0xddfc4b4cef07f5b0, 0x95f83d0a1fb69cd9, 0x4abdaf101564f98e,
+	0xbb764c4ca7a4440f, 0x9d6d1ad41abe37f1, 0xea53df5fd18d5513, 0x84c86189216dc5ed,
+	0x92746b9be2f8552c, 0x32fd3cf5b4e49bb4, 0xb7118682dbb66a77, 0x3fbc8c33221dc2a1,
+	0xe4d5e82392a40515, 0x0fabaf3feaa5334a, 0x8f05b1163ba6832d, 0x29cb4d87f2a7400e,
+	0xb2c71d5bca9023f8, 0x743e20e9ef511012, 0xdf78e4b2bd342cf6, 0x914da9246b255416,
+	0x8bab8eefb6409c1a, 0x1ad089b6c2f7548e, 0xae9672aba3d0c320, 0xa184ac2473b529b1,
+	0xda3c0f568cc4f3e8, 0xc9e5d72d90a2741e, 0x8865899617fb1871, 0x7e2fa67c7a658892,
+	0xaa7eebfb9df9de8d, 0xddbb901b98feeab7, 0xd51ea6fa85785631, 0x552a74227f3ea565,
+	0x8533285c936b35de, 0xd53a88958f87275f, 0xa67ff273b8460356, 0x8a892abaf368f137,
+	0xd01fef10a657842c, 0x2d2b7569b0432d85, 0x8213f56a67f6b29b, 0x9c3b29620e29fc73,
+	0xa298f2c501f45f42, 0x8349f3ba91b47b8f, 0xcb3f2f7642717713, 0x241c70a936219a73,
+	0xfe0efb53d30dd4d7, 0xed238cd383aa0110, 0x9ec95d1463e8a506, 0xf4363804324a40aa,
+	0xc67bb4597ce2ce48, 0xb143c6053edcd0d5, 0xf81aa16fdc1b81da, 0xdd94b7868e94050a,
+	0x9b10a4e5e9913128, 0xca7cf2b4191c8326, 0xc1d4ce1f63f57d72, 0xfd1c2f611f63a3f0,
+	0xf24a01a73cf2dccf, 0xbc633b39673c8cec, 0x976e41088617ca01, 0xd5be0503e085d813,
+	0xbd49d14aa79dbc82, 0x4b2d8644d8a74e18, 0xec9c459d51852ba2, 0xddf8e7d60ed1219e,
+	0x93e1ab8252f33b45, 0xcabb90e5c942b503, 0xb8da1662e7b00a17, 0x3d6a751f3b936243,
+	0xe7109bfba19c0c9d, 0x0cc512670a783ad4, 0x906a617d450187e2, 0x27fb2b80668b24c5,
+	0xb484f9dc9641e9da, 0xb1f9f660802dedf6, 0xe1a63853bbd26451, 0x5e7873f8a0396973,
+	0x8d07e33455637eb2, 0xdb0b487b6423e1e8, 0xb049dc016abc5e5f, 0x91ce1a9a3d2cda62,
+	0xdc5c5301c56b75f7, 0x7641a140cc7810fb, 0x89b9b3e11b6329ba, 0xa9e904c87fcb0a9d,
+	0xac2820d9623bf429, 0x546345fa9fbdcd44, 0xd732290fbacaf133, 0xa97c177947ad4095,
+	0x867f59a9d4bed6c0, 0x49ed8eabcccc485d, 0xa81f301449ee8c70, 0x5c68f256bfff5a74,
+	0xd226fc195c6a2f8c, 0x73832eec6fff3111, 0x83585d8fd9c25db7, 0xc831fd53c5ff7eab,
+	0xa42e74f3d032f525, 0xba3e7ca8b77f5e55, 0xcd3a1230c43fb26f, 0x28ce1bd2e55f35eb,
+	0x80444b5e7aa7cf85, 0x7980d163cf5b81b3, 0xa0555e361951c366, 0xd7e105bcc332621f,
+	0xc86ab5c39fa63440, 0x8dd9472bf3fefaa7, 0xfa856334878fc150, 0xb14f98f6f0feb951,
+	0x9c935e00d4b9d8d2, 0x6ed1bf9a569f33d3, 0xc3b8358109e84f07, 0x0a862f80ec4700c8,
+	0xf4a642e14c6262c8, 0xcd27bb612758c0fa, 0x98e7e9cccfbd7dbd, 0x8038d51cb897789c,
+	0xbf21e44003acdd2c, 0xe0470a63e6bd56c3, 0xeeea5d5004981478, 0x1858ccfce06cac74,
+	0x95527a5202df0ccb, 0x0f37801e0c43ebc8, 0xbaa718e68396cffd, 0xd30560258f54e6ba,
+	0xe950df20247c83fd, 0x47c6b82ef32a2069, 0x91d28b7416cdd27e, 0x4cdc331d57fa5441,
+	0xb6472e511c81471d, 0xe0133fe4adf8e952, 0xe3d8f9e563a198e5, 0x58180fddd97723a6,
+	0x8e679c2f5e44ff8f, 0x570f09eaa7ea7648
+};
+
+struct Uint128
+{
+	uint64_t low;
+	uint64_t high;
+};
+
+inline Uint128 FullMultiplication( uint64_t a, uint64_t b )
+{
+#if defined( __SIZEOF_INT128__ )
+	__extension__ typedef unsigned __int128 uint128;
+	uint128 p = static_cast<uint128>( a ) * b;
+	return { static_cast<uint64_t>( p ), static_cast<uint64_t>( p >> 64 ) };
+#elif defined( _MSC_VER ) && defined( _M_AMD64 )
+	Uint128 r;
+	r.low = _umul128( a, b, &r.high );
+	return r;
+#else
+	const uint64_t M32 = 0xFFFFFFFF;
+	uint64_t ad = ( a >> 32 ) * ( b & M32 );
+	uint64_t bd = ( a & M32 ) * ( b & M32 );
+	uint64_t adbc = ad + ( a & M32 ) * ( b >> 32 );
+	uint64_t carry = adbc < ad ? uint64_t( 1 ) << 32 : 0;
+	uint64_t low = bd + ( adbc << 32 );
+	return { low,
+	         ( a >> 32 ) * ( b >> 32 ) + ( adbc >> 32 ) + carry +
+	             ( low < bd ? 1 : 0 ) };
+#endif
+}
+
+inline int LeadingZeroes( uint64_t v )
+{
+	assert( v != 0 );
+#if defined( _MSC_VER ) && defined( _M_AMD64 )
+	unsigned long index;
+	_BitScanReverse64( &index, v );
+	return 63 - static_cast<int>( index );
+#elif defined( __GNUC__ )
+	return __builtin_clzll( v );
+#else
+	int n = 0;
+	while ( not( v & ( uint64_t( 1 ) << 63 ) ) )
+	{
+		v <<= 1;
+		++n;
+	}
+	return n;
+#endif
+}
+
+// w * 10^q as a double, false if the result could not be decided.
+inline bool StrtodEiselLemire( uint64_t w, int q, double *result )
+{
+	const int kMantissaBits = 52;
+	if ( w == 0 or q < kSmallestPowerOfFive )
+	{
+		*result = 0.0;
+		return true;
+	}
+	if ( q > kLargestPowerOfFive )
+	{
+		*result = std::numeric_limits<double>::infinity();
+		return true;
+	}
+
+	int lz = LeadingZeroes( w );
+	w <<= lz;
+
+	// the product, to the precision needed
+	auto index = 2 * ( q - kSmallestPowerOfFive );
+	auto product = FullMultiplication( w, kPowerOfFive128[index] );
+	const uint64_t precisionMask = ~uint64_t( 0 ) >> ( kMantissaBits + 3 );
+	if ( ( product.high & precisionMask ) == precisionMask )
+	{
+		auto second = FullMultiplication( w, kPowerOfFive128[index + 1] );
+		product.low += second.high;
+		if ( second.high > product.low )
+			product.high++;
+	}
+	// the truncated 5^q is not precise enough to tell
+	if ( product.low == ~uint64_t( 0 ) and ( q < -27 or q > 55 ) )
+		return false;
+
+	int upperbit = static_cast<int>( product.high >> 63 );
+	uint64_t mantissa = product.high >> ( upperbit + 64 - kMantissaBits - 3 );
+	int power2 = ( ( ( 152170 + 65536 ) * q ) >> 16 ) + 63 + upperbit - lz + 1023;
+	if ( power2 <= 0 )
+	{
+		// subnormal
+		if ( -power2 + 1 >= 64 )
+		{
+			*result = 0.0;
+			return true;
+		}
+		mantissa >>= -power2 + 1;
+		mantissa += ( mantissa & 1 );
+		mantissa >>= 1;
+		power2 = mantissa < ( uint64_t( 1 ) << kMantissaBits ) ? 0 : 1;
+		*result = Double( mantissa | ( uint64_t( power2 ) << kMantissaBits ) )
+		              .Value();
+		return true;
+	}
+
+	// exactly halfway between two doubles, round to even
+	if ( product.low <= 1 and q >= -4 and q <= 23 and ( mantissa & 3 ) == 1 and
+	     ( mantissa << ( upperbit + 64 - kMantissaBits - 3 ) ) == product.high )
+		mantissa &= ~uint64_t( 1 );
+
+	mantissa += ( mantissa & 1 );
+	mantissa >>= 1;
+	if ( mantissa >= ( uint64_t( 2 ) << kMantissaBits ) )
+	{
+		mantissa = uint64_t( 1 ) << kMantissaBits;
+		power2++;
+	}
+	mantissa &= ~( uint64_t( 1 ) << kMantissaBits );
+	if ( power2 >= 0x7FF )
+	{
+		*result = std::numeric_limits<double>::infinity();
+		return true;
+	}
+	*result =
+	    Double( mantissa | ( uint64_t( power2 ) << kMantissaBits ) ).Value();
+	return true;
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * SWAR digits
+ *
+ *  8 ascii digits at a time, loaded little endian in a 64 bits integer.
+ */
+
+inline bool IsEightDigits( uint64_t v )
+{
+	return ( ( v & 0xF0F0F0F0F0F0F0F0 ) |
+	         ( ( ( v + 0x0606060606060606 ) & 0xF0F0F0F0F0F0F0F0 ) >> 4 ) ) ==
+	       0x3333333333333333;
+}
+
+inline uint32_t ParseEightDigits( uint64_t v )
+{
+	const uint64_t mask = 0x000000FF000000FF;
+	const uint64_t mul1 = 0x000F424000000064; // 100 + (1000000ULL << 32)
+	const uint64_t mul2 = 0x0000271000000001; // 1 + (10000ULL << 32)
+	v -= 0x3030303030303030;
+	v = ( v * 10 ) + ( v >> 8 );
+	v = ( ( ( v & mask ) * mul1 ) + ( ( ( v >> 16 ) & mask ) * mul2 ) ) >> 32;
+	return static_cast<uint32_t>( v );
+}
+
 // end -----
 
 /* * * * * * * * * * * * * * * * * * * *
@@ -1651,14 +1860,178 @@ const su::Json &static_null()
 	return json_null;
 }
 
-void dump( const std::string &value, std::string &out )
+/* * * * * * * * * * * * * * * * * * * *
+ * Outputs for dump
+ *
+ *  All with the append() calls of std::string used by the writer.
+ */
+
+// Count the characters only, for dump_size()
+struct SizeOutput
+{
+	size_t size = 0;
+	void append( const char *, size_t i_len ) { size += i_len; }
+	void append( size_t i_count, char ) { size += i_count; }
+};
+
+// Write through a fixed size buffer, flushed as it fills.
+class BufferedOutput
+{
+public:
+	BufferedOutput( const std::function<bool( const char *, size_t )> &i_write ) :
+	    _write( i_write )
+	{
+	}
+
+	void append( const char *i_str, size_t i_len )
+	{
+		if ( i_len > sizeof( _buffer ) - _size )
+		{
+			flush();
+			if ( i_len >= sizeof( _buffer ) )
+			{
+				write( i_str, i_len );
+				return;
+			}
+		}
+		std::memcpy( _buffer + _size, i_str, i_len );
+		_size += i_len;
+	}
+	void append( size_t i_count, char i_c )
+	{
+		while ( i_count-- > 0 )
+		{
+			if ( _size == sizeof( _buffer ) )
+				flush();
+			_buffer[_size++] = i_c;
+		}
+	}
+	bool flush()
+	{
+		if ( _size > 0 )
+			write( _buffer, _size );
+		_size = 0;
+		return _ok;
+	}
+
+private:
+	const std::function<bool( const char *, size_t )> &_write;
+	char _buffer[16 * 1024];
+	size_t _size = 0;
+	bool _ok = true;
+
+	void write( const char *i_str, size_t i_len )
+	{
+		// stop writing after the first error
+		if ( _ok )
+			_ok = _write( i_str, i_len );
+	}
+};
+
+/* * * * * * * * * * * * * * * * * * * *
+ * String scanning
+ *
+ *  Strings are copied by runs of characters that need no attention, their
+ *  end is found 16 or 32 bytes at a time: the next quote, backslash or
+ *  control character, and when dumping the next 0xe2, the lead byte of the
+ *  escaped U+2028 and U+2029.
+ */
+
+inline int countTrailingZeros( uint64_t v )
+{
+#if defined( _MSC_VER ) && defined( _M_AMD64 )
+	unsigned long index;
+	_BitScanForward64( &index, v );
+	return static_cast<int>( index );
+#elif defined( __GNUC__ ) && __GNUC__ >= 4
+	return __builtin_ctzll( v );
+#else
+	int n = 0;
+	while ( ( v & 1 ) == 0 )
+	{
+		v >>= 1;
+		++n;
+	}
+	return n;
+#endif
+}
+
+inline bool is_plain_char( uint8_t c, bool dump )
+{
+	return c >= 0x20 and c != '"' and c != '\\' and ( not dump or c != 0xe2 );
+}
+
+/* skip_plain_chars<DUMP>(p, end)
+ *
+ * Return the first character from p that is not plain, end if none.
+ */
+template<bool DUMP>
+inline const char *skip_plain_chars( const char *p, const char *end )
+{
+#if SU_JSON_AVX2
+	while ( end - p >= 32 )
+	{
+		auto v = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( p ) );
+		// v <= 0x1f, unsigned
+		auto special = _mm256_cmpeq_epi8(
+		    _mm256_max_epu8( v, _mm256_set1_epi8( 0x1f ) ), _mm256_set1_epi8( 0x1f ) );
+		special = _mm256_or_si256(
+		    special,
+		    _mm256_or_si256( _mm256_cmpeq_epi8( v, _mm256_set1_epi8( '"' ) ),
+		                     _mm256_cmpeq_epi8( v, _mm256_set1_epi8( '\\' ) ) ) );
+		if constexpr ( DUMP )
+			special = _mm256_or_si256(
+			    special,
+			    _mm256_cmpeq_epi8( v, _mm256_set1_epi8( static_cast<char>( 0xe2 ) ) ) );
+		auto mask = static_cast<uint32_t>( _mm256_movemask_epi8( special ) );
+		if ( mask != 0 )
+			return p + countTrailingZeros( mask );
+		p += 32;
+	}
+#elif SU_JSON_SSE2
+	while ( end - p >= 16 )
+	{
+		auto v = _mm_loadu_si128( reinterpret_cast<const __m128i *>( p ) );
+		// v <= 0x1f, unsigned
+		auto special = _mm_cmpeq_epi8( _mm_max_epu8( v, _mm_set1_epi8( 0x1f ) ),
+		                               _mm_set1_epi8( 0x1f ) );
+		special = _mm_or_si128(
+		    special, _mm_or_si128( _mm_cmpeq_epi8( v, _mm_set1_epi8( '"' ) ),
+		                           _mm_cmpeq_epi8( v, _mm_set1_epi8( '\\' ) ) ) );
+		if constexpr ( DUMP )
+			special = _mm_or_si128(
+			    special, _mm_cmpeq_epi8( v, _mm_set1_epi8( static_cast<char>( 0xe2 ) ) ) );
+		auto mask = static_cast<uint32_t>( _mm_movemask_epi8( special ) );
+		if ( mask != 0 )
+			return p + countTrailingZeros( mask );
+		p += 16;
+	}
+#endif
+	while ( p != end and is_plain_char( static_cast<uint8_t>( *p ), DUMP ) )
+		++p;
+	return p;
+}
+
+template<typename OUT>
+void dump( const std::string_view &value, OUT &out )
 {
-	if ( out.capacity() < (out.size() + (value.size() * 2)) )
-		out.reserve( out.size() + (value.size() * 2) );
+	if constexpr ( std::is_same_v<OUT, std::string> )
+	{
+		if ( out.capacity() < (out.size() + (value.size() * 2)) )
+			out.reserve( out.size() + (value.size() * 2) );
+	}
 
 	out.append( 1, '"' );
-	for ( auto ch = value.begin(); ch != value.end(); ++ch )
+	auto ch = value.data();
+	auto end = ch + value.size();
+	for ( ;; )
 	{
+		auto run = skip_plain_chars<true>( ch, end );
+		if ( run != ch )
+			out.append( ch, run - ch );
+		ch = run;
+		if ( ch == end )
+			break;
 		switch ( *ch )
 		{
 			case '\\':
@@ -1689,14 +2062,14 @@ void dump( const std::string &value, std::string &out )
 					auto l = snprintf( buf, sizeof buf, "\\u%04x", *ch );
 					out.append( buf, l );
 				}
-				else if ( static_cast<uint8_t>( *ch ) == 0xe2 and
+				else if ( end - ch >= 3 and
 				          static_cast<uint8_t>( *( ch + 1 ) ) == 0x80 and
 				          static_cast<uint8_t>( *( ch + 2 ) ) == 0xa8 )
 				{
 					out.append( "\\u2028", 6 );
 					ch += 2;
 				}
-				else if ( static_cast<uint8_t>( *ch ) == 0xe2 and
+				else if ( end - ch >= 3 and
 				          static_cast<uint8_t>( *( ch + 1 ) ) == 0x80 and
 				          static_cast<uint8_t>( *( ch + 2 ) ) == 0xa9 )
 				{
@@ -1705,20 +2078,24 @@ void dump( const std::string &value, std::string &out )
 				}
 				else
 				{
+					// 0xe2, lead byte of another character
 					out.append( 1, *ch );
 				}
 				break;
 		}
+		++ch;
 	}
 	out.append( 1, '"' );
 }
 
-inline bool isPtr( su::Json::Type type )
+template<typename OUT>
+void dump_newline( OUT &out, int i_depth )
 {
-	return type == su::Json::Type::STRING or type == su::Json::Type::ARRAY or
-	       type == su::Json::Type::OBJECT;
+	out.append( 1, '\n' );
+	out.append( 2 * i_depth, ' ' );
 }
 
+
 template<typename T, int SIZE = sizeof( T )>
 struct num_traits
 {
@@ -1739,1618 +2116,4290 @@ struct num_traits<T, 8>
 	inline static int64_t convert( T v ) { return static_cast<int64_t>( v ); }
 };
 
-}
-
-namespace su {
-
-namespace details {
+/* * * * * * * * * * * * * * * * * * * *
+ * Structural index
+ *
+ *  A pass over the input, 64 bytes at a time, marking every token start outside
+ *  of strings in a bitmap: structural characters, opening quotes and the first
+ *  character of scalars. It is built lazily, a window at a time, from where
+ *  the parser first meets a run of whitespace and is only used to jump over
+ *  it, the parser still reads the tokens themselves byte by byte. Lazy views
+ *  also use it to skip containers.
+ */
 
-struct JsonValue
+struct BlockMasks
 {
-	virtual ~JsonValue() = default;
-
-	mutable size_t refCount{1};
-	void inc() const { ++refCount; }
-	void dec() const
-	{
-		--refCount;
-		if ( refCount == 0 )
-			delete this;
-	}
+	uint64_t quote;
+	uint64_t backslash;
+	uint64_t whitespace;
+	uint64_t structural;
 };
 
-struct JsonString : JsonValue
+#if SU_JSON_AVX2
+inline uint64_t classify32( __m256i v, __m256i c )
 {
-	std::string value;
-	JsonString( const std::string &i_value ) : value( i_value ) {}
-	JsonString( std::string &&i_value ) : value( std::move( i_value ) ) {}
-};
-struct JsonArray : JsonValue
+	return static_cast<uint32_t>(
+	    _mm256_movemask_epi8( _mm256_cmpeq_epi8( v, c ) ) );
+}
+inline BlockMasks classify( const char *p )
 {
-	Json::array value;
-	JsonArray( const Json::array &i_value ) : value( i_value ) {}
-	JsonArray( Json::array &&i_value ) : value( std::move( i_value ) ) {}
-};
-struct JsonObject : JsonValue
+	BlockMasks m{};
+	for ( int i = 0; i < 64; i += 32 )
+	{
+		auto v = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( p + i ) );
+		// '[' | 0x20 == '{' and ']' | 0x20 == '}'
+		auto lower = _mm256_or_si256( v, _mm256_set1_epi8( 0x20 ) );
+		auto ws = _mm256_or_si256(
+		    _mm256_or_si256( _mm256_cmpeq_epi8( v, _mm256_set1_epi8( ' ' ) ),
+		                     _mm256_cmpeq_epi8( v, _mm256_set1_epi8( '\t' ) ) ),
+		    _mm256_or_si256( _mm256_cmpeq_epi8( v, _mm256_set1_epi8( '\n' ) ),
+		                     _mm256_cmpeq_epi8( v, _mm256_set1_epi8( '\r' ) ) ) );
+		auto st = _mm256_or_si256(
+		    _mm256_or_si256(
+		        _mm256_cmpeq_epi8( lower, _mm256_set1_epi8( '{' ) ),
+		        _mm256_cmpeq_epi8( lower, _mm256_set1_epi8( '}' ) ) ),
+		    _mm256_or_si256( _mm256_cmpeq_epi8( v, _mm256_set1_epi8( ':' ) ),
+		                     _mm256_cmpeq_epi8( v, _mm256_set1_epi8( ',' ) ) ) );
+		m.quote |= classify32( v, _mm256_set1_epi8( '"' ) ) << i;
+		m.backslash |= classify32( v, _mm256_set1_epi8( '\\' ) ) << i;
+		m.whitespace |=
+		    uint64_t( static_cast<uint32_t>( _mm256_movemask_epi8( ws ) ) ) << i;
+		m.structural |=
+		    uint64_t( static_cast<uint32_t>( _mm256_movemask_epi8( st ) ) ) << i;
+	}
+	return m;
+}
+#elif SU_JSON_SSE2
+inline uint64_t classify16( __m128i v, char c )
 {
-	Json::object value;
-	JsonObject( const Json::object &i_value ) : value( i_value ) {}
-	JsonObject( Json::object &&i_value ) : value( std::move( i_value ) ) {}
-};
-
+	return static_cast<uint32_t>(
+	    _mm_movemask_epi8( _mm_cmpeq_epi8( v, _mm_set1_epi8( c ) ) ) );
 }
-
-Json::~Json()
+inline BlockMasks classify( const char *p )
 {
-	if ( isPtr( _type ) )
-		_data.p->dec();
+	BlockMasks m{};
+	for ( int i = 0; i < 64; i += 16 )
+	{
+		auto v = _mm_loadu_si128( reinterpret_cast<const __m128i *>( p + i ) );
+		// '[' | 0x20 == '{' and ']' | 0x20 == '}'
+		auto lower = _mm_or_si128( v, _mm_set1_epi8( 0x20 ) );
+		m.quote |= classify16( v, '"' ) << i;
+		m.backslash |= classify16( v, '\\' ) << i;
+		m.whitespace |= ( classify16( v, ' ' ) | classify16( v, '\t' ) |
+		                  classify16( v, '\n' ) | classify16( v, '\r' ) )
+		                << i;
+		m.structural |= ( classify16( lower, '{' ) | classify16( lower, '}' ) |
+		                  classify16( v, ':' ) | classify16( v, ',' ) )
+		                << i;
+	}
+	return m;
 }
-
-Json::Json( const Json &rhs ) noexcept
+#else
+inline BlockMasks classify( const char *p )
 {
-	_type = rhs._type;
-	_numberType = rhs._numberType;
-	_data.all = rhs._data.all;
-	if ( isPtr( _type ) )
-		_data.p->inc();
+	BlockMasks m{};
+	for ( int i = 0; i < 64; ++i )
+	{
+		const uint64_t bit = uint64_t( 1 ) << i;
+		switch ( p[i] )
+		{
+			case '"':
+				m.quote |= bit;
+				break;
+			case '\\':
+				m.backslash |= bit;
+				break;
+			case ' ':
+			case '\t':
+			case '\n':
+			case '\r':
+				m.whitespace |= bit;
+				break;
+			case '{':
+			case '}':
+			case '[':
+			case ']':
+			case ':':
+			case ',':
+				m.structural |= bit;
+				break;
+			default:
+				break;
+		}
+	}
+	return m;
 }
+#endif
 
-Json &Json::operator=( const Json &rhs ) noexcept
+class StructuralIndex
 {
-	if ( this != &rhs )
+public:
+	void reset( const std::string_view &i_input )
 	{
-		if ( isPtr( rhs._type ) )
-			rhs._data.p->inc();
-		if ( isPtr( _type ) )
-			_data.p->dec();
-		_type = rhs._type;
-		_numberType = rhs._numberType;
-		_data.all = rhs._data.all;
+		_input = i_input;
+		_base = _built = 0;
+		_starts.clear();
 	}
-	return *this;
+
+	//! first token start after i_pos, or the end of the input. i_pos must be
+	//! outside of a string or right after the previous token start.
+	size_t next( size_t i_pos )
+	{
+		if ( i_pos < _base or i_pos > _built )
+			restart( i_pos );
+		else if ( i_pos == _built )
+		{
+			if ( _built == _input.size() )
+				return _input.size();
+			extend();
+		}
+
+		auto b = ( i_pos - _base ) / 64;
+		auto bits =
+		    _starts[b] & ( ~uint64_t( 0 ) << ( ( i_pos - _base ) % 64 ) );
+		while ( bits == 0 )
+		{
+			if ( ++b == _starts.size() )
+			{
+				if ( _built == _input.size() )
+					return _input.size();
+				extend();
+			}
+			bits = _starts[b];
+		}
+		return std::min( _base + ( b * 64 ) + countTrailingZeros( bits ),
+		                 _input.size() );
+	}
+
+private:
+	static constexpr size_t kMinWindowSize = 256;
+	static constexpr size_t kMaxWindowSize = 4096;
+
+	std::string_view _input;
+	// one bit per input byte, from _base to _built
+	std::vector<uint64_t> _starts;
+	size_t _base = 0;
+	size_t _built = 0;
+	size_t _window = kMinWindowSize;
+
+	uint64_t _prevEscaped = 0; // first char of the block is escaped
+	uint64_t _prevInString = 0; // all ones if the block starts in a string
+	uint64_t _prevScalar = 0; // last char of the previous block is a scalar
+
+	// the caller knows i_pos is outside of a string, it is safe to start
+	// a new window there
+	void restart( size_t i_pos )
+	{
+		_base = _built = i_pos;
+		_window = kMinWindowSize;
+		_starts.clear();
+		_prevEscaped = _prevInString = _prevScalar = 0;
+		extend();
+	}
+
+	// windows grow as long as the caller keeps going
+	void extend()
+	{
+		auto end = std::min( _built + _window, _input.size() );
+		_window = std::min( _window * 2, kMaxWindowSize );
+		const char *p = _input.data();
+		for ( ; _built + 64 <= end; _built += 64 )
+			indexBlock( classify( p + _built ) );
+		if ( _built < end )
+		{
+			char tail[64];
+			memset( tail, ' ', 64 );
+			memcpy( tail, p + _built, end - _built );
+			indexBlock( classify( tail ) );
+			_built = end;
+		}
+	}
+
+	void indexBlock( const BlockMasks &i_masks )
+	{
+		// characters following an unescaped backslash, backslashes are rare
+		// enough to do it one at a time
+		uint64_t escaped = _prevEscaped;
+		_prevEscaped = 0;
+		for ( auto bs = i_masks.backslash & ~escaped; bs != 0; bs &= bs - 1 )
+		{
+			auto i = countTrailingZeros( bs );
+			if ( escaped & ( uint64_t( 1 ) << i ) )
+				continue;
+			if ( i == 63 )
+				_prevEscaped = 1;
+			else
+				escaped |= uint64_t( 1 ) << ( i + 1 );
+		}
+
+		// prefix xor of the unescaped quotes: ones from an opening quote
+		// to the character before its closing quote
+		auto quotes = i_masks.quote & ~escaped;
+		auto inString = quotes;
+		inString ^= inString << 1;
+		inString ^= inString << 2;
+		inString ^= inString << 4;
+		inString ^= inString << 8;
+		inString ^= inString << 16;
+		inString ^= inString << 32;
+		inString ^= _prevInString;
+		_prevInString = uint64_t( static_cast<int64_t>( inString ) >> 63 );
+
+		auto scalar =
+		    ~( i_masks.whitespace | i_masks.structural | quotes ) & ~inString;
+		_starts.push_back( ( i_masks.structural & ~inString ) |
+		                   ( quotes & inString ) |
+		                   ( scalar & ~( ( scalar << 1 ) | _prevScalar ) ) );
+		_prevScalar = scalar >> 63;
+	}
+};
+
 }
-Json::Json( Json &&rhs ) noexcept
+
+namespace su {
+
+namespace details {
+
+struct JsonValue
 {
-	_type = std::exchange( rhs._type, Type::NUL );
-	_numberType = std::exchange( rhs._numberType, NumberType::NOTANUMBER );
-	_data.all = std::exchange( rhs._data.all, 0 );
-}
-Json &Json::operator=( Json &&rhs ) noexcept
+	virtual ~JsonValue() = default;
+
+	// 0 for nodes owned by a JsonArena, never changes after construction
+#ifndef SU_JSON_SINGLE_THREADED
+	// atomic, so Json values can be copied and released concurrently from
+	// several threads, a read-only tree can be shared without a deep copy
+	mutable std::atomic<size_t> refCount{1};
+	void inc() const
+	{
+		// a new reference is always made from an existing one, no ordering
+		// needed
+		if ( refCount.load( std::memory_order_relaxed ) != 0 )
+			refCount.fetch_add( 1, std::memory_order_relaxed );
+	}
+	void dec() const
+	{
+		auto count = refCount.load( std::memory_order_acquire );
+		if ( count == 0 )
+			return;
+		// the sole owner can skip the atomic read-modify-write, no other
+		// thread can see this node
+		if ( count == 1 or
+		     refCount.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+			delete this;
+	}
+	bool unique() const
+	{
+		return refCount.load( std::memory_order_acquire ) == 1;
+	}
+	size_t use_count() const
+	{
+		return refCount.load( std::memory_order_relaxed );
+	}
+#else
+	mutable size_t refCount{1};
+	void inc() const
+	{
+		if ( refCount != 0 )
+			++refCount;
+	}
+	void dec() const
+	{
+		if ( refCount != 0 and --refCount == 0 )
+			delete this;
+	}
+	bool unique() const { return refCount == 1; }
+	size_t use_count() const { return refCount; }
+#endif
+};
+
+struct JsonString : JsonValue
 {
-	if ( this != &rhs )
+	std::string value; // empty when the characters are in a JsonArena
+	std::string_view text; // the characters, in value or in the arena
+	JsonString( const std::string &i_value ) : value( i_value ), text( value ) {}
+	JsonString( std::string &&i_value ) :
+	    value( std::move( i_value ) ),
+	    text( value )
+	{
+	}
+	// characters owned by an arena, nothing to destroy
+	explicit JsonString( const std::string_view &i_arenaText ) :
+	    text( i_arenaText )
+	{
+	}
+
+	// strings never change, their hash is computed once, 0 until then
+	size_t hash() const
 	{
-		if ( _type != rhs._type or _numberType != rhs._numberType or
-		     _data.all != rhs._data.all )
+		auto h = cachedHash.load( std::memory_order_relaxed );
+		if ( h == 0 )
 		{
-			// different storage
-			std::swap( _type, rhs._type );
-			std::swap( _numberType, rhs._numberType );
-			std::swap( _data.all, rhs._data.all );
+			h = std::hash<std::string_view>()( text );
+			cachedHash.store( h, std::memory_order_relaxed );
 		}
-		rhs.clear();
+		return h;
 	}
-	return *this;
-}
-
-/* * * * * * * * * * * * * * * * * * * *
- * Constructors
- */
-Json::Json( double i_value ) :
-    _data( i_value ),
-    _type( Type::NUMBER ),
-    _numberType( Json::NumberType::DOUBLE )
+	mutable std::atomic<size_t> cachedHash{0};
+};
+struct JsonArray : JsonValue
 {
-}
-Json::Json( int i_value ) :
-    _data( num_traits<int>::convert( i_value ) ),
-    _type( Type::NUMBER ),
-    _numberType( num_traits<int>::number_type )
+	Json::array value;
+	JsonArray( const Json::array &i_value ) : value( i_value ) {}
+	JsonArray( Json::array &&i_value ) : value( std::move( i_value ) ) {}
+};
+/* JsonObjectIndex
+ *
+ * A hash table of the keys of a large object, open addressing with linear
+ * probing. A slot is the high 32 bits of the key hash and the position of
+ * the key plus one, 0 for an empty slot.
+ */
+struct JsonObjectIndex
 {
-}
-Json::Json( unsigned int i_value ) :
-    _data( num_traits<unsigned int>::convert( i_value ) ),
-    _type( Type::NUMBER ),
-    _numberType( num_traits<unsigned int>::number_type )
+	std::unique_ptr<uint64_t[]> slots;
+	size_t mask = 0;
+	// of all the keys, in order
+	size_t keysHash = 0;
+};
+
+struct JsonObject : JsonValue
 {
+	Json::object value;
+	JsonObject( const Json::object &i_value ) : value( i_value ) {}
+	JsonObject( Json::object &&i_value ) : value( std::move( i_value ) ) {}
+	~JsonObject() { delete index.load( std::memory_order_relaxed ); }
+
+	// objects with fewer keys are searched, not indexed
+	static constexpr size_t kIndexThreshold = 32;
+
+	// The position of key, value.size() if missing.
+	size_t find( const std::string_view &i_key ) const;
+	// The index, built on first use, nullptr for a small object.
+	const JsonObjectIndex *get_index() const;
+	// After the keys were changed.
+	void keys_changed() { delete index.exchange( nullptr ); }
+
+	// built lazily by readers on several threads, the first one to finish
+	// publishes it
+	mutable std::atomic<JsonObjectIndex *> index{nullptr};
+};
+
 }
-Json::Json( long i_value ) :
-    _data( num_traits<long>::convert( i_value ) ),
-    _type( Type::NUMBER ),
-    _numberType( num_traits<long>::number_type )
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Arena
+ */
+
+JsonArena::JsonArena( size_t i_blockSize ) : _blockSize( i_blockSize ) {}
+
+JsonArena::~JsonArena()
 {
+	reset();
+	free( _blocks );
 }
-Json::Json( unsigned long i_value ) :
-    _data( num_traits<unsigned long>::convert( i_value ) ),
-    _type( Type::NUMBER ),
-    _numberType( num_traits<unsigned long>::number_type )
+
+void JsonArena::reset()
 {
+	for ( auto node : _nodes )
+		node->~JsonValue();
+	_nodes.clear();
+
+	if ( _blocks != nullptr )
+	{
+		// keep the first block around
+		for ( auto b = _blocks->next; b != nullptr; )
+		{
+			auto next = b->next;
+			free( b );
+			b = next;
+		}
+		_blocks->next = nullptr;
+		_ptr = reinterpret_cast<char *>( _blocks + 1 );
+		_end = reinterpret_cast<char *>( _blocks ) + _blocks->size;
+	}
 }
-Json::Json( long long i_value ) :
-    _data( num_traits<long long>::convert( i_value ) ),
-    _type( Type::NUMBER ),
-    _numberType( num_traits<long long>::number_type )
+
+size_t JsonArena::capacity() const
 {
+	size_t total = 0;
+	for ( auto b = _blocks; b != nullptr; b = b->next )
+		total += b->size;
+	return total;
 }
-Json::Json( unsigned long long i_value ) :
-    _data( num_traits<unsigned long long>::convert( i_value ) ),
-    _type( Type::NUMBER ),
-    _numberType( num_traits<unsigned long long>::number_type )
+
+void *JsonArena::allocate( size_t i_size, size_t i_align )
 {
+	auto p = reinterpret_cast<char *>(
+	    ( reinterpret_cast<uintptr_t>( _ptr ) + i_align - 1 ) &
+	    ~( uintptr_t( i_align ) - 1 ) );
+	if ( _ptr == nullptr or p + i_size > _end )
+	{
+		// new block, keep the first one at the head so reset() can reuse it
+		auto size = std::max( _blockSize, sizeof( Block ) + i_size + i_align );
+		auto b = static_cast<Block *>( malloc( size ) );
+		if ( b == nullptr )
+			throw std::bad_alloc();
+		b->size = size;
+		if ( _blocks == nullptr )
+		{
+			b->next = nullptr;
+			_blocks = b;
+		}
+		else
+		{
+			b->next = _blocks->next;
+			_blocks->next = b;
+		}
+		_ptr = reinterpret_cast<char *>( b + 1 );
+		_end = reinterpret_cast<char *>( b ) + size;
+		p = reinterpret_cast<char *>(
+		    ( reinterpret_cast<uintptr_t>( _ptr ) + i_align - 1 ) &
+		    ~( uintptr_t( i_align ) - 1 ) );
+	}
+	_ptr = p + i_size;
+	return p;
 }
-Json::Json( bool i_value ) : _data( i_value ), _type( Type::BOOL ) {}
-Json::Json( const std::string &i_value ) :
-    _data( new details::JsonString( i_value ) ),
-    _type( Type::STRING )
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Intern table
+ *
+ *  The items of an array or object are interned before it: nested arrays
+ *  and objects compare by address, everything else by value.
+ */
+
+namespace {
+
+size_t shallow_hash( const Json &i_value )
 {
+	switch ( i_value.type() )
+	{
+		case Json::Type::NUL:
+			return 0;
+		case Json::Type::BOOL:
+			return i_value.bool_value() ? 1 : 2;
+		case Json::Type::NUMBER:
+			if ( i_value.is_double() )
+			{
+				auto d = i_value.number_value();
+				uint64_t bits;
+				memcpy( &bits, &d, sizeof( bits ) );
+				return std::hash<uint64_t>()( bits );
+			}
+			return std::hash<int64_t>()( i_value.int64_value() );
+		case Json::Type::STRING:
+			return std::hash<std::string_view>()( i_value.string_view() );
+		case Json::Type::ARRAY:
+			return std::hash<const void *>()( &i_value.array_items() );
+		case Json::Type::OBJECT:
+			return std::hash<const void *>()( &i_value.object_items() );
+	}
+	return 0;
 }
-Json::Json( std::string &&i_value ) :
-    _data( new details::JsonString( std::move( i_value ) ) ),
-    _type( Type::STRING )
+
+bool shallow_equal( const Json &i_lhs, const Json &i_rhs )
 {
+	if ( i_lhs.type() != i_rhs.type() )
+		return false;
+	switch ( i_lhs.type() )
+	{
+		case Json::Type::NUL:
+			return true;
+		case Json::Type::BOOL:
+			return i_lhs.bool_value() == i_rhs.bool_value();
+		case Json::Type::NUMBER:
+			if ( i_lhs.number_type() != i_rhs.number_type() )
+				return false;
+			if ( i_lhs.is_double() )
+			{
+				auto l = i_lhs.number_value(), r = i_rhs.number_value();
+				return memcmp( &l, &r, sizeof( double ) ) == 0;
+			}
+			return i_lhs.int64_value() == i_rhs.int64_value();
+		case Json::Type::STRING:
+			return i_lhs.string_view() == i_rhs.string_view();
+		case Json::Type::ARRAY:
+			return &i_lhs.array_items() == &i_rhs.array_items();
+		case Json::Type::OBJECT:
+			return &i_lhs.object_items() == &i_rhs.object_items();
+	}
+	return false;
 }
-Json::Json( const char *i_value ) :
-    _data( new details::JsonString( i_value ) ),
-    _type( Type::STRING )
+
+inline void hash_mix( size_t &io_seed, size_t i_hash )
 {
+	io_seed ^= i_hash + 0x9e3779b9 + ( io_seed << 6 ) + ( io_seed >> 2 );
 }
-Json::Json( const Json::array &i_values ) :
-    _data( new details::JsonArray( i_values ) ),
-    _type( Type::ARRAY )
-{
+
 }
-Json::Json( Json::array &&i_values ) :
-    _data( new details::JsonArray( std::move( i_values ) ) ),
-    _type( Type::ARRAY )
+
+struct JsonInternTable::Impl
 {
-}
-Json::Json( const Json::object &i_values ) :
-    _data( new details::JsonObject( i_values ) ),
-    _type( Type::OBJECT )
+	size_t maxItems;
+	// the views point into the string nodes, kept alive by the table
+	std::unordered_map<std::string_view, Json> strings;
+	// arrays and objects, by shallow hash
+	std::unordered_multimap<size_t, Json> containers;
+};
+
+JsonInternTable::JsonInternTable( size_t i_maxItems ) :
+    _impl( std::make_unique<Impl>() )
 {
+	_impl->maxItems = i_maxItems;
 }
-Json::Json( Json::object &&i_values ) :
-    _data( new details::JsonObject( std::move( i_values ) ) ),
-    _type( Type::OBJECT )
+
+JsonInternTable::~JsonInternTable() = default;
+
+void JsonInternTable::clear()
 {
+	_impl->strings.clear();
+	_impl->containers.clear();
 }
 
-void Json::clear()
+size_t JsonInternTable::size() const
 {
-	if ( isPtr( _type ) )
-		_data.p->dec();
-	_type = Type::NUL;
-	_numberType = NumberType::NOTANUMBER;
-	_data.all = 0;
+	return _impl->strings.size() + _impl->containers.size();
 }
 
-void Json::clean()
+/* * * * * * * * * * * * * * * * * * * *
+ * Hashing
+ */
+
+namespace details {
+
+const JsonObjectIndex *JsonObject::get_index() const
 {
-	if ( type() == Type::OBJECT )
+	auto result = index.load( std::memory_order_acquire );
+	if ( result != nullptr or value.size() < kIndexThreshold )
+		return result;
+
+	auto fresh = std::make_unique<JsonObjectIndex>();
+	// at most half full
+	size_t size = 16;
+	while ( size < value.size() * 2 )
+		size *= 2;
+	fresh->slots.reset( new uint64_t[size]() );
+	fresh->mask = size - 1;
+	uint64_t pos = 0;
+	for ( auto &item : value )
 	{
-		auto &obj = ( (details::JsonObject *)_data.p )->value;
-		obj.storage().erase(
-		    std::remove_if(
-		        obj.storage().begin(),
-		        obj.storage().end(),
-		        []( auto &v ) {
-			        switch ( v.second.type() )
-			        {
-				        case Type::NUL:
-					        return true;
-					        break;
-				        case Type::STRING:
-					        if ( v.second.string_value().empty() )
-						        return true;
-					        break;
-				        case Type::ARRAY:
-				        {
-					        auto &arr =
-					            ( (details::JsonArray *)v.second._data.p )
-					                ->value;
-					        if ( arr.empty() )
-						        return true;
-					        else
-					        {
-						        for ( auto &el : arr )
-							        el.clean();
-					        }
-					        break;
-				        }
-				        case Type::OBJECT:
-				        {
-					        auto &o =
-					            ( (details::JsonObject *)v.second._data.p )
-					                ->value;
-					        if ( o.empty() )
-						        return true;
-					        else
-					        {
-						        for ( auto &el : o )
-							        el.second.clean();
-					        }
-					        break;
-				        }
-				        default:
-					        break;
-			        }
-			        return false;
-		        } ),
-		    obj.storage().end() );
+		auto h = std::hash<std::string_view>()( item.first );
+		hash_mix( fresh->keysHash, h );
+		auto slot = h & fresh->mask;
+		while ( fresh->slots[slot] != 0 )
+			slot = ( slot + 1 ) & fresh->mask;
+		fresh->slots[slot] = ( uint64_t( h ) & 0xffffffff00000000 ) | ++pos;
 	}
+
+	if ( index.compare_exchange_strong( result,
+	                                    fresh.get(),
+	                                    std::memory_order_acq_rel,
+	                                    std::memory_order_acquire ) )
+		return fresh.release();
+	// another thread was faster
+	return result;
 }
 
-double Json::number_value() const
+size_t JsonObject::find( const std::string_view &i_key ) const
 {
-	if ( type() == Type::NUMBER )
+	if ( value.size() < kIndexThreshold )
+		return value.find( i_key ) - value.begin();
+
+	auto idx = get_index();
+	auto h = std::hash<std::string_view>()( i_key );
+	auto tag = uint64_t( h ) & 0xffffffff00000000;
+	for ( auto slot = h & idx->mask;; slot = ( slot + 1 ) & idx->mask )
 	{
-		switch ( number_type() )
+		auto entry = idx->slots[slot];
+		if ( entry == 0 )
+			return value.size();
+		if ( ( entry & 0xffffffff00000000 ) == tag )
 		{
-			case NumberType::DOUBLE:
-				return _data.d;
-			case NumberType::INTEGER:
-				return _data.i32;
-			case NumberType::INTEGER64:
-				return static_cast<double>( _data.i64 );
-			default:
-				break;
+			size_t pos = static_cast<uint32_t>( entry ) - 1;
+			if ( ( value.begin() + pos )->first == i_key )
+				return pos;
 		}
 	}
-	return 0;
 }
 
-int32_t Json::int_value() const
-{
-	if ( type() == Type::NUMBER )
-	{
-		switch ( number_type() )
-		{
-			case NumberType::DOUBLE:
-				return static_cast<int32_t>( _data.d );
-			case NumberType::INTEGER:
-				return _data.i32;
-			case NumberType::INTEGER64:
-				return static_cast<int32_t>( _data.i64 );
-			default:
-				break;
-		}
-	}
-	return 0;
 }
 
-int64_t Json::int64_value() const
+/* hash()
+ *
+ * Consistent with operator==: numbers are hashed as doubles, so 1 and 1.0
+ * hash the same, strings by content whether they are inline or not.
+ */
+size_t Json::hash() const
 {
-	if ( type() == Type::NUMBER )
+	switch ( type() )
 	{
-		switch ( number_type() )
+		case Type::NUL:
+			return 0;
+		case Type::BOOL:
+			return _data.b ? 1 : 2;
+		case Type::NUMBER:
 		{
-			case NumberType::DOUBLE:
-				return static_cast<int64_t>( _data.d );
-			case NumberType::INTEGER:
-				return _data.i32;
-			case NumberType::INTEGER64:
-				return _data.i64;
-			default:
-				break;
+			auto d = number_value();
+			// 0.0 == -0.0
+			return d == 0 ? 3 : std::hash<double>()( d );
+		}
+		case Type::STRING:
+			if ( has_node() )
+				return static_cast<const details::JsonString *>( _data.p )->hash();
+			return std::hash<std::string_view>()( string_view() );
+		case Type::ARRAY:
+		{
+			size_t result = array_items().size();
+			for ( auto &item : array_items() )
+				hash_mix( result, item.hash() );
+			return result;
+		}
+		case Type::OBJECT:
+		{
+			size_t result = ~object_items().size();
+			for ( auto &item : object_items() )
+			{
+				hash_mix( result, std::hash<std::string_view>()( item.first ) );
+				hash_mix( result, item.second.hash() );
+			}
+			return result;
 		}
 	}
 	return 0;
 }
 
-bool Json::bool_value() const
+/* * * * * * * * * * * * * * * * * * * *
+ * Memory usage
+ */
+
+namespace {
+
+// heap bytes of s, 0 for a short string stored inside it
+size_t heap_bytes( const std::string &s )
 {
-	if ( type() == Type::BOOL )
-		return _data.b;
-	return false;
+	auto begin = reinterpret_cast<const char *>( &s );
+	if ( s.data() >= begin and s.data() < begin + sizeof( s ) )
+		return 0;
+	return s.capacity() + 1;
 }
 
-const std::string &Json::string_value() const
+size_t shrink_string( std::string &io_s )
 {
-	if ( type() == Type::STRING )
-		return ( (details::JsonString *)_data.p )->value;
-	return statics().empty_string;
+	auto before = heap_bytes( io_s );
+	io_s.shrink_to_fit();
+	return before - heap_bytes( io_s );
 }
 
-const Json::array &Json::array_items() const
+template<typename V>
+size_t shrink_vector( V &io_v )
 {
-	if ( type() == Type::ARRAY )
-		return ( (details::JsonArray *)_data.p )->value;
-	return statics().empty_array;
+	auto before = io_v.capacity();
+	io_v.shrink_to_fit();
+	return ( before - io_v.capacity() ) * sizeof( typename V::value_type );
 }
 
-const Json::object &Json::object_items() const
-{
-	if ( type() == Type::OBJECT )
-		return ( (details::JsonObject *)_data.p )->value;
-	return statics().empty_object;
 }
 
-double Json::to_number_value() const
+namespace details {
+
+/* JsonMemoryCounter
+ *
+ * A first pass counts how many times the tree refers to each node with
+ * more than one reference, the nodes with more references than that are
+ * also referenced from outside, the second pass adds up the bytes.
+ */
+struct JsonMemoryCounter
 {
-	switch ( type() )
+	JsonMemoryUsage usage;
+	std::unordered_map<const JsonValue *, size_t> references;
+
+	void count_references( const Json &i_value )
 	{
-		case Type::NUMBER:
-			return number_value();
-		case Type::BOOL:
-			return bool_value() ? 0 : 1;
-		case Type::STRING:
-			try
-			{
-				return std::stod( string_value() );
-			}
-			catch ( ... )
-			{
-			}
-			break;
-		default:
-			break;
+		if ( not i_value.has_node() )
+			return;
+		auto node = i_value._data.p;
+		if ( node->use_count() != 1 and references[node]++ > 0 )
+			return;
+		if ( i_value.is_array() )
+		{
+			for ( auto &item : i_value.array_items() )
+				count_references( item );
+		}
+		else if ( i_value.is_object() )
+		{
+			for ( auto &item : i_value.object_items() )
+				count_references( item.second );
+		}
 	}
-	return 0;
-}
-int32_t Json::to_int_value() const
-{
-	switch ( type() )
+
+	void add_string( const std::string &i_s )
 	{
-		case Type::NUMBER:
-			return int_value();
-		case Type::BOOL:
-			return bool_value() ? 0 : 1;
-		case Type::STRING:
-			try
+		auto bytes = heap_bytes( i_s );
+		if ( bytes > 0 )
+		{
+			usage.string_bytes += i_s.size() + 1;
+			usage.slack_bytes += bytes - ( i_s.size() + 1 );
+		}
+	}
+
+	void add( const Json &i_value, bool i_shared )
+	{
+		if ( not i_value.has_node() )
+			return;
+		auto node = i_value._data.p;
+		auto count = node->use_count();
+		if ( count != 1 )
+		{
+			// seen before, set to 0 to count it once
+			auto &seen = references[node];
+			if ( seen == 0 )
+				return;
+			// arena nodes (count 0) are never counted as shared
+			i_shared = i_shared or count > seen;
+			seen = 0;
+		}
+
+		auto before = usage.total();
+		++usage.nodes;
+		switch ( i_value.type() )
+		{
+			case Json::Type::STRING:
 			{
-				return std::stoi( string_value() );
+				usage.node_bytes += sizeof( JsonString );
+				auto s = static_cast<const JsonString *>( node );
+				if ( s->value.empty() )
+					usage.string_bytes += s->text.size(); // in an arena
+				else
+					add_string( s->value );
+				break;
 			}
-			catch ( ... )
+			case Json::Type::ARRAY:
 			{
+				usage.node_bytes += sizeof( JsonArray );
+				auto &items = static_cast<const JsonArray *>( node )->value;
+				usage.container_bytes += items.size() * sizeof( Json );
+				usage.slack_bytes +=
+				    ( items.capacity() - items.size() ) * sizeof( Json );
+				break;
 			}
-			break;
-		default:
-			break;
+			case Json::Type::OBJECT:
+			{
+				usage.node_bytes += sizeof( JsonObject );
+				auto object = static_cast<const JsonObject *>( node );
+				auto &items = object->value.storage();
+				using Item = std::decay_t<decltype( items )>::value_type;
+				usage.container_bytes += items.size() * sizeof( Item );
+				usage.slack_bytes +=
+				    ( items.capacity() - items.size() ) * sizeof( Item );
+				for ( auto &item : items )
+					add_string( item.first );
+				if ( auto idx = object->index.load( std::memory_order_acquire ) )
+				{
+					usage.index_bytes += sizeof( JsonObjectIndex ) +
+					                     ( idx->mask + 1 ) * sizeof( uint64_t );
+				}
+				break;
+			}
+			default:
+				break;
+		}
+		if ( i_shared )
+			usage.shared_bytes += usage.total() - before;
+
+		if ( i_value.is_array() )
+		{
+			for ( auto &item : i_value.array_items() )
+				add( item, i_shared );
+		}
+		else if ( i_value.is_object() )
+		{
+			for ( auto &item : i_value.object_items() )
+				add( item.second, i_shared );
+		}
 	}
-	return 0;
+};
+
 }
-int64_t Json::to_int64_value() const
+
+JsonMemoryUsage Json::memory_breakdown() const
+{
+	details::JsonMemoryCounter counter;
+	counter.count_references( *this );
+	counter.add( *this, false );
+	return counter.usage;
+}
+
+size_t Json::shrink_to_fit()
 {
+	// arena nodes (refCount 0) are left alone too
+	if ( not has_node() or not _data.p->unique() )
+		return 0;
+	auto node = const_cast<details::JsonValue *>( _data.p );
+	size_t released = 0;
 	switch ( type() )
 	{
-		case Type::NUMBER:
-			return int64_value();
-		case Type::BOOL:
-			return bool_value() ? 0 : 1;
 		case Type::STRING:
-			try
-			{
-				return std::stoll( string_value() );
-			}
-			catch ( ... )
-			{
-			}
+		{
+			auto s = static_cast<details::JsonString *>( node );
+			released = shrink_string( s->value );
+			s->text = s->value;
+			break;
+		}
+		case Type::ARRAY:
+		{
+			auto &items = static_cast<details::JsonArray *>( node )->value;
+			released = shrink_vector( items );
+			for ( auto &item : items )
+				released += item.shrink_to_fit();
+			break;
+		}
+		case Type::OBJECT:
+		{
+			auto &items =
+			    static_cast<details::JsonObject *>( node )->value.storage();
+			released = shrink_vector( items );
+			for ( auto &item : items )
+				released +=
+				    shrink_string( item.first ) + item.second.shrink_to_fit();
 			break;
+		}
 		default:
 			break;
 	}
-	return 0;
+	return released;
 }
 
-bool Json::to_bool_value() const
+Json::~Json()
 {
-	switch ( type() )
-	{
-		case Type::NUMBER:
-			return int_value() != 0;
-		case Type::BOOL:
-			return bool_value();
-		case Type::STRING:
-			return string_value() == "true";
-		default:
-			break;
-	}
-	return false;
+	if ( has_node() )
+		_data.p->dec();
 }
-std::string Json::to_string_value() const
+
+Json::Json( const Json &rhs ) noexcept
 {
-	switch ( type() )
+	_type = rhs._type;
+	_numberType = rhs._numberType;
+	_data.all = rhs._data.all;
+	std::memcpy( _chars, rhs._chars, sizeof( _chars ) );
+	if ( has_node() )
+		_data.p->inc();
+}
+
+Json &Json::operator=( const Json &rhs ) noexcept
+{
+	if ( this != &rhs )
 	{
-		case Type::NUMBER:
-			switch ( number_type() )
-			{
-				case Json::NumberType::DOUBLE:
-					return std::to_string( _data.d );
-				case Json::NumberType::INTEGER:
-					return std::to_string( _data.i32 );
-				case Json::NumberType::INTEGER64:
-					return std::to_string( _data.i64 );
-				default:
-					assert( false );
-					break;
-			}
-			break;
-		case Type::BOOL:
-			return bool_value() ? "true" : "false";
-		case Type::STRING:
-			return string_value();
-		default:
-			break;
+		if ( rhs.has_node() )
+			rhs._data.p->inc();
+		if ( has_node() )
+			_data.p->dec();
+		_type = rhs._type;
+		_numberType = rhs._numberType;
+		_data.all = rhs._data.all;
+		std::memcpy( _chars, rhs._chars, sizeof( _chars ) );
 	}
-	return statics().empty_string;
+	return *this;
 }
-
-const Json &Json::operator[]( size_t i ) const
+Json::Json( Json &&rhs ) noexcept
 {
-	if ( type() == Type::ARRAY )
+	_type = std::exchange( rhs._type, Type::NUL );
+	_numberType = std::exchange( rhs._numberType, NumberType::NOTANUMBER );
+	_data.all = std::exchange( rhs._data.all, 0 );
+	std::memcpy( _chars, rhs._chars, sizeof( _chars ) );
+}
+Json &Json::operator=( Json &&rhs ) noexcept
+{
+	if ( this != &rhs )
 	{
-		if ( i < ( (details::JsonArray *)_data.p )->value.size() )
-			return ( (details::JsonArray *)_data.p )->value[i];
+		// swap and let rhs release what was ours, fine even when both share
+		// the same node
+		std::swap( _type, rhs._type );
+		std::swap( _numberType, rhs._numberType );
+		std::swap( _data.all, rhs._data.all );
+		std::swap( _chars, rhs._chars );
+		rhs.clear();
 	}
-	return static_null();
+	return *this;
 }
 
-const Json &Json::operator[]( const std::string_view &key ) const
+void Json::set_inline_string( const std::string_view &i_value )
 {
-	if ( type() == Type::OBJECT )
+	// _data.chars and _chars are contiguous, 14 bytes at the start of the
+	// object, see string_view()
+	static_assert( offsetof( Json, _chars ) == sizeof( Storage ), "" );
+	if ( not i_value.empty() )
 	{
-		auto it = ( (details::JsonObject *)_data.p )->value.find( key );
-		if ( it != ( (details::JsonObject *)_data.p )->value.end() )
-			return it->second;
+		auto head = std::min( i_value.size(), sizeof( _data.chars ) );
+		std::memcpy( _data.chars, i_value.data(), head );
+		std::memcpy( _chars, i_value.data() + head, i_value.size() - head );
 	}
-	return static_null();
+	_type = Type::STRING;
+	_numberType =
+	    static_cast<NumberType>( kInlineString + i_value.size() );
 }
 
 /* * * * * * * * * * * * * * * * * * * *
- * Serialization
+ * Constructors
  */
-
-void Json::dump( std::string &output ) const
+Json::Json( double i_value ) :
+    _data( i_value ),
+    _type( Type::NUMBER ),
+    _numberType( Json::NumberType::DOUBLE )
 {
-	char buf[32];
-	switch ( type() )
-	{
-		case Type::NUL:
-			output.append( "null", 4 );
-			break;
-		case Type::BOOL:
-			if ( _data.b )
-				output.append( "true", 4 );
-			else
-				output.append( "false", 5 );
+}
+Json::Json( int i_value ) :
+    _data( num_traits<int>::convert( i_value ) ),
+    _type( Type::NUMBER ),
+    _numberType( num_traits<int>::number_type )
+{
+}
+Json::Json( unsigned int i_value ) :
+    _data( num_traits<unsigned int>::convert( i_value ) ),
+    _type( Type::NUMBER ),
+    _numberType( num_traits<unsigned int>::number_type )
+{
+}
+Json::Json( long i_value ) :
+    _data( num_traits<long>::convert( i_value ) ),
+    _type( Type::NUMBER ),
+    _numberType( num_traits<long>::number_type )
+{
+}
+Json::Json( unsigned long i_value ) :
+    _data( num_traits<unsigned long>::convert( i_value ) ),
+    _type( Type::NUMBER ),
+    _numberType( num_traits<unsigned long>::number_type )
+{
+}
+Json::Json( long long i_value ) :
+    _data( num_traits<long long>::convert( i_value ) ),
+    _type( Type::NUMBER ),
+    _numberType( num_traits<long long>::number_type )
+{
+}
+Json::Json( unsigned long long i_value ) :
+    _data( num_traits<unsigned long long>::convert( i_value ) ),
+    _type( Type::NUMBER ),
+    _numberType( num_traits<unsigned long long>::number_type )
+{
+}
+Json::Json( bool i_value ) : _data( i_value ), _type( Type::BOOL ) {}
+Json::Json( const std::string &i_value ) :
+    Json( std::string_view( i_value ) )
+{
+}
+Json::Json( std::string &&i_value ) :
+    _data( i_value.size() <= kInlineCapacity
+               ? nullptr
+               : new details::JsonString( std::move( i_value ) ) ),
+    _type( Type::STRING )
+{
+	if ( _data.p == nullptr )
+		set_inline_string( i_value );
+}
+Json::Json( const std::string_view &i_value ) :
+    _data( i_value.size() <= kInlineCapacity
+               ? nullptr
+               : new details::JsonString( std::string( i_value ) ) ),
+    _type( Type::STRING )
+{
+	if ( _data.p == nullptr )
+		set_inline_string( i_value );
+}
+Json::Json( const char *i_value ) : Json( std::string_view( i_value ) ) {}
+Json::Json( const Json::array &i_values ) :
+    _data( new details::JsonArray( i_values ) ),
+    _type( Type::ARRAY )
+{
+}
+Json::Json( Json::array &&i_values ) :
+    _data( new details::JsonArray( std::move( i_values ) ) ),
+    _type( Type::ARRAY )
+{
+}
+Json::Json( const Json::object &i_values ) :
+    _data( new details::JsonObject( i_values ) ),
+    _type( Type::OBJECT )
+{
+}
+Json::Json( Json::object &&i_values ) :
+    _data( new details::JsonObject( std::move( i_values ) ) ),
+    _type( Type::OBJECT )
+{
+}
+
+void Json::clear()
+{
+	if ( has_node() )
+		_data.p->dec();
+	_type = Type::NUL;
+	_numberType = NumberType::NOTANUMBER;
+	_data.all = 0;
+	std::memset( _chars, 0, sizeof( _chars ) );
+}
+
+void Json::clean()
+{
+	if ( type() != Type::OBJECT )
+		return;
+	// shared nodes are copied first, like set() and erase()
+	auto node = static_cast<details::JsonObject *>( detach() );
+	auto &obj = node->value;
+	auto size = obj.size();
+	obj.storage().erase(
+	    std::remove_if(
+	        obj.storage().begin(),
+	        obj.storage().end(),
+	        []( auto &v ) {
+		        switch ( v.second.type() )
+		        {
+			        case Type::NUL:
+				        return true;
+			        case Type::STRING:
+				        if ( v.second.string_view().empty() )
+					        return true;
+				        break;
+			        case Type::ARRAY:
+			        {
+				        if ( v.second.array_items().empty() )
+					        return true;
+				        auto &arr =
+				            static_cast<details::JsonArray *>( v.second.detach() )
+				                ->value;
+				        for ( auto &el : arr )
+					        el.clean();
+				        break;
+			        }
+			        case Type::OBJECT:
+			        {
+				        if ( v.second.object_items().empty() )
+					        return true;
+				        auto &o =
+				            static_cast<details::JsonObject *>( v.second.detach() )
+				                ->value;
+				        for ( auto &el : o )
+					        el.second.clean();
+				        break;
+			        }
+			        default:
+				        break;
+		        }
+		        return false;
+	        } ),
+	    obj.storage().end() );
+	if ( obj.size() != size )
+		node->keys_changed();
+}
+
+double Json::number_value() const
+{
+	if ( type() == Type::NUMBER )
+	{
+		switch ( number_type() )
+		{
+			case NumberType::DOUBLE:
+				return _data.d;
+			case NumberType::INTEGER:
+				return _data.i32;
+			case NumberType::INTEGER64:
+				return static_cast<double>( _data.i64 );
+			default:
+				break;
+		}
+	}
+	return 0;
+}
+
+int32_t Json::int_value() const
+{
+	if ( type() == Type::NUMBER )
+	{
+		switch ( number_type() )
+		{
+			case NumberType::DOUBLE:
+				return static_cast<int32_t>( _data.d );
+			case NumberType::INTEGER:
+				return _data.i32;
+			case NumberType::INTEGER64:
+				return static_cast<int32_t>( _data.i64 );
+			default:
+				break;
+		}
+	}
+	return 0;
+}
+
+int64_t Json::int64_value() const
+{
+	if ( type() == Type::NUMBER )
+	{
+		switch ( number_type() )
+		{
+			case NumberType::DOUBLE:
+				return static_cast<int64_t>( _data.d );
+			case NumberType::INTEGER:
+				return _data.i32;
+			case NumberType::INTEGER64:
+				return _data.i64;
+			default:
+				break;
+		}
+	}
+	return 0;
+}
+
+bool Json::bool_value() const
+{
+	if ( type() == Type::BOOL )
+		return _data.b;
+	return false;
+}
+
+std::string Json::string_value() const
+{
+	return std::string( string_view() );
+}
+
+std::string_view Json::string_view() const
+{
+	if ( type() == Type::STRING )
+	{
+		if ( is_inline_string() )
+			return std::string_view(
+			    reinterpret_cast<const char *>( this ),
+			    static_cast<uint8_t>( _numberType ) - kInlineString );
+		return ( (details::JsonString *)_data.p )->text;
+	}
+	return {};
+}
+
+const Json::array &Json::array_items() const
+{
+	if ( type() == Type::ARRAY )
+		return ( (details::JsonArray *)_data.p )->value;
+	return statics().empty_array;
+}
+
+const Json::object &Json::object_items() const
+{
+	if ( type() == Type::OBJECT )
+		return ( (details::JsonObject *)_data.p )->value;
+	return statics().empty_object;
+}
+
+double Json::to_number_value() const
+{
+	switch ( type() )
+	{
+		case Type::NUMBER:
+			return number_value();
+		case Type::BOOL:
+			return bool_value() ? 0 : 1;
+		case Type::STRING:
+			try
+			{
+				return std::stod( string_value() );
+			}
+			catch ( ... )
+			{
+			}
 			break;
+		default:
+			break;
+	}
+	return 0;
+}
+int32_t Json::to_int_value() const
+{
+	switch ( type() )
+	{
 		case Type::NUMBER:
-			switch ( number_type() )
+			return int_value();
+		case Type::BOOL:
+			return bool_value() ? 0 : 1;
+		case Type::STRING:
+			try
+			{
+				return std::stoi( string_value() );
+			}
+			catch ( ... )
 			{
-				case Json::NumberType::DOUBLE:
-					if ( std::isfinite( _data.d ) )
-						output.append( buf, numtoa( _data.d, buf ) - buf );
-					else
-						output.append( "null", 4 );
-					break;
-				case Json::NumberType::INTEGER:
-					output.append( buf, numtoa( _data.i32, buf ) - buf );
-					break;
-				case Json::NumberType::INTEGER64:
-					output.append( buf, numtoa( _data.i64, buf ) - buf );
-					break;
-				default:
-					assert( false );
-					break;
 			}
 			break;
+		default:
+			break;
+	}
+	return 0;
+}
+int64_t Json::to_int64_value() const
+{
+	switch ( type() )
+	{
+		case Type::NUMBER:
+			return int64_value();
+		case Type::BOOL:
+			return bool_value() ? 0 : 1;
 		case Type::STRING:
-			::dump( ( (details::JsonString *)_data.p )->value, output );
+			try
+			{
+				return std::stoll( string_value() );
+			}
+			catch ( ... )
+			{
+			}
 			break;
-		case Type::ARRAY:
-			if ( ( (details::JsonArray *)_data.p )->value.empty() )
-				output.append( "[]", 2 );
-			else
+		default:
+			break;
+	}
+	return 0;
+}
+
+bool Json::to_bool_value() const
+{
+	switch ( type() )
+	{
+		case Type::NUMBER:
+			return int_value() != 0;
+		case Type::BOOL:
+			return bool_value();
+		case Type::STRING:
+			return string_view() == "true";
+		default:
+			break;
+	}
+	return false;
+}
+std::string Json::to_string_value() const
+{
+	switch ( type() )
+	{
+		case Type::NUMBER:
+			switch ( number_type() )
+			{
+				case Json::NumberType::DOUBLE:
+					return std::to_string( _data.d );
+				case Json::NumberType::INTEGER:
+					return std::to_string( _data.i32 );
+				case Json::NumberType::INTEGER64:
+					return std::to_string( _data.i64 );
+				default:
+					assert( false );
+					break;
+			}
+			break;
+		case Type::BOOL:
+			return bool_value() ? "true" : "false";
+		case Type::STRING:
+			return string_value();
+		default:
+			break;
+	}
+	return statics().empty_string;
+}
+
+const Json &Json::operator[]( size_t i ) const
+{
+	if ( type() == Type::ARRAY )
+	{
+		if ( i < ( (details::JsonArray *)_data.p )->value.size() )
+			return ( (details::JsonArray *)_data.p )->value[i];
+	}
+	return static_null();
+}
+
+const Json &Json::operator[]( const std::string_view &key ) const
+{
+	if ( type() == Type::OBJECT )
+	{
+		auto node = static_cast<const details::JsonObject *>( _data.p );
+		auto pos = node->find( key );
+		if ( pos < node->value.size() )
+			return ( node->value.begin() + pos )->second;
+	}
+	return static_null();
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Mutation
+ */
+
+details::JsonValue *Json::detach()
+{
+	// arena nodes (refCount 0) are never changed either, they can be shared
+	// without being counted
+	if ( not _data.p->unique() )
+	{
+		if ( _type == Type::ARRAY )
+			*this = Json( new details::JsonArray( array_items() ), Type::ARRAY );
+		else
+			*this =
+			    Json( new details::JsonObject( object_items() ), Type::OBJECT );
+	}
+	return const_cast<details::JsonValue *>( _data.p );
+}
+
+bool Json::set( const std::string_view &key, Json value )
+{
+	if ( is_null() )
+		*this = Json( object() );
+	if ( type() != Type::OBJECT )
+		return false;
+	auto node = static_cast<details::JsonObject *>( detach() );
+	auto &items = node->value;
+	auto it = items.lower_bound( key );
+	if ( it != items.end() and it->first == key )
+		it->second = std::move( value );
+	else
+	{
+		items.storage().emplace( it, std::string( key ), std::move( value ) );
+		node->keys_changed();
+	}
+	return true;
+}
+
+bool Json::push_back( Json value )
+{
+	if ( is_null() )
+		*this = Json( array() );
+	if ( type() != Type::ARRAY )
+		return false;
+	static_cast<details::JsonArray *>( detach() )
+	    ->value.push_back( std::move( value ) );
+	return true;
+}
+
+bool Json::erase( const std::string_view &key )
+{
+	if ( type() != Type::OBJECT )
+		return false;
+	auto pos = static_cast<const details::JsonObject *>( _data.p )->find( key );
+	if ( pos == object_items().size() )
+		return false;
+	auto node = static_cast<details::JsonObject *>( detach() );
+	node->value.erase( node->value.begin() + pos );
+	node->keys_changed();
+	return true;
+}
+
+bool Json::erase( size_t i )
+{
+	if ( type() != Type::ARRAY or i >= array_items().size() )
+		return false;
+	auto &items = static_cast<details::JsonArray *>( detach() )->value;
+	items.erase( items.begin() + i );
+	return true;
+}
+
+Json *Json::mutable_item( const std::string_view &key )
+{
+	if ( type() != Type::OBJECT )
+		return nullptr;
+	// look first, not to detach for nothing
+	auto pos = static_cast<const details::JsonObject *>( _data.p )->find( key );
+	if ( pos == object_items().size() )
+		return nullptr;
+	auto &items = static_cast<details::JsonObject *>( detach() )->value;
+	return &( items.begin() + pos )->second;
+}
+
+Json *Json::mutable_item( size_t i )
+{
+	if ( type() != Type::ARRAY or i >= array_items().size() )
+		return nullptr;
+	return &static_cast<details::JsonArray *>( detach() )->value[i];
+}
+
+bool Json::set_path( const std::string_view &path, Json value )
+{
+	auto dot = path.find( '.' );
+	auto head = path.substr( 0, dot );
+
+	Json *item = nullptr;
+	if ( type() == Type::ARRAY )
+	{
+		size_t i = 0;
+		auto end = head.data() + head.size();
+		auto res = std::from_chars( head.data(), end, i );
+		if ( res.ec != std::errc() or res.ptr != end )
+			return false;
+		item = mutable_item( i );
+		if ( item == nullptr )
+			return false;
+		if ( dot == std::string_view::npos )
+		{
+			*item = std::move( value );
+			return true;
+		}
+	}
+	else
+	{
+		if ( dot == std::string_view::npos )
+			return set( head, std::move( value ) );
+		if ( is_null() )
+			*this = Json( object() );
+		if ( type() != Type::OBJECT )
+			return false;
+		item = mutable_item( head );
+		if ( item == nullptr )
+		{
+			set( head, object() );
+			item = mutable_item( head );
+		}
+	}
+	return item->set_path( path.substr( dot + 1 ), std::move( value ) );
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Serialization
+ */
+
+/* dump_to<PRETTY>(out, depth)
+ *
+ * Write to out, pretty printed with 2 spaces per level if PRETTY.
+ */
+template<bool PRETTY, typename OUT>
+void Json::dump_to( OUT &out, int i_depth ) const
+{
+	char buf[32];
+	switch ( type() )
+	{
+		case Type::NUL:
+			out.append( "null", 4 );
+			break;
+		case Type::BOOL:
+			if ( _data.b )
+				out.append( "true", 4 );
+			else
+				out.append( "false", 5 );
+			break;
+		case Type::NUMBER:
+			switch ( number_type() )
+			{
+				case Json::NumberType::DOUBLE:
+					if ( std::isfinite( _data.d ) )
+						out.append( buf, numtoa( _data.d, buf ) - buf );
+					else
+						out.append( "null", 4 );
+					break;
+				case Json::NumberType::INTEGER:
+					out.append( buf, numtoa( _data.i32, buf ) - buf );
+					break;
+				case Json::NumberType::INTEGER64:
+					out.append( buf, numtoa( _data.i64, buf ) - buf );
+					break;
+				default:
+					assert( false );
+					break;
+			}
+			break;
+		case Type::STRING:
+			::dump( string_view(), out );
+			break;
+		case Type::ARRAY:
+		{
+			const auto &items = ( (details::JsonArray *)_data.p )->value;
+			if ( items.empty() )
+			{
+				out.append( "[]", 2 );
+				break;
+			}
+			char sep = '[';
+			for ( const auto &value : items )
+			{
+				out.append( 1, sep );
+				sep = ',';
+				if constexpr ( PRETTY )
+					dump_newline( out, i_depth + 1 );
+				value.dump_to<PRETTY>( out, i_depth + 1 );
+			}
+			if constexpr ( PRETTY )
+				dump_newline( out, i_depth );
+			out.append( 1, ']' );
+			break;
+		}
+		case Type::OBJECT:
+		{
+			const auto &items = ( (details::JsonObject *)_data.p )->value;
+			if ( items.empty() )
+			{
+				out.append( "{}", 2 );
+				break;
+			}
+			char sep = '{';
+			for ( const auto &kv : items )
+			{
+				out.append( 1, sep );
+				sep = ',';
+				if constexpr ( PRETTY )
+					dump_newline( out, i_depth + 1 );
+				::dump( kv.first, out );
+				if constexpr ( PRETTY )
+					out.append( ": ", 2 );
+				else
+					out.append( 1, ':' );
+				kv.second.dump_to<PRETTY>( out, i_depth + 1 );
+			}
+			if constexpr ( PRETTY )
+				dump_newline( out, i_depth );
+			out.append( 1, '}' );
+			break;
+		}
+	}
+}
+
+template<typename OUT>
+void Json::dump_to( OUT &out, JsonDump style ) const
+{
+	if ( style == JsonDump::PRETTY )
+		dump_to<true>( out, 0 );
+	else
+		dump_to<false>( out, 0 );
+}
+
+void Json::dump( std::string &output, JsonDump style ) const
+{
+	dump_to( output, style );
+}
+
+bool Json::dump( const std::function<bool( const char *, size_t )> &write,
+                 JsonDump style ) const
+{
+	BufferedOutput output( write );
+	dump_to( output, style );
+	return output.flush();
+}
+
+bool Json::dump( std::streambuf &output, JsonDump style ) const
+{
+	return dump(
+	    [&output]( const char *i_str, size_t i_len ) {
+		    return output.sputn( i_str, i_len ) ==
+		           static_cast<std::streamsize>( i_len );
+	    },
+	    style );
+}
+
+void Json::dump( std::ostream &output, JsonDump style ) const
+{
+	std::ostream::sentry sentry( output );
+	if ( not sentry or output.rdbuf() == nullptr or
+	     not dump( *output.rdbuf(), style ) )
+		output.setstate( std::ios_base::badbit );
+}
+
+size_t Json::dump_size( JsonDump style ) const
+{
+	SizeOutput output;
+	dump_to( output, style );
+	return output.size;
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Comparison
+ */
+
+bool Json::operator==( const Json &rhs ) const
+{
+	if ( type() == rhs.type() )
+	{
+		switch ( type() )
+		{
+			case Type::NUL:
+				return true;
+			case Type::NUMBER:
+				switch ( number_type() )
+				{
+					case Json::NumberType::DOUBLE:
+						switch ( rhs.number_type() )
+						{
+							case Json::NumberType::DOUBLE:
+								return _data.d == rhs._data.d;
+							case Json::NumberType::INTEGER:
+								return _data.d == rhs._data.i32;
+							case Json::NumberType::INTEGER64:
+								return _data.d == rhs._data.i64;
+							default:
+								assert( false );
+								break;
+						}
+						break;
+					case Json::NumberType::INTEGER:
+						switch ( rhs.number_type() )
+						{
+							case Json::NumberType::DOUBLE:
+								return _data.i32 == rhs._data.d;
+							case Json::NumberType::INTEGER:
+								return _data.i32 == rhs._data.i32;
+							case Json::NumberType::INTEGER64:
+								return _data.i32 == rhs._data.i64;
+							default:
+								assert( false );
+								break;
+						}
+						break;
+					case Json::NumberType::INTEGER64:
+						switch ( rhs.number_type() )
+						{
+							case Json::NumberType::DOUBLE:
+								return _data.i64 == rhs._data.d;
+							case Json::NumberType::INTEGER:
+								return _data.i64 == rhs._data.i32;
+							case Json::NumberType::INTEGER64:
+								return _data.i64 == rhs._data.i64;
+							default:
+								assert( false );
+								break;
+						}
+						break;
+					default:
+						assert( false );
+						break;
+				}
+				break;
+			case Type::BOOL:
+				return _data.b == rhs._data.b;
+			case Type::STRING:
+				if ( has_node() and rhs.has_node() )
+				{
+					if ( _data.p == rhs._data.p )
+						return true;
+					// both hashes known and different
+					auto l = static_cast<const details::JsonString *>( _data.p )
+					             ->cachedHash.load( std::memory_order_relaxed );
+					auto r =
+					    static_cast<const details::JsonString *>( rhs._data.p )
+					        ->cachedHash.load( std::memory_order_relaxed );
+					if ( l != 0 and r != 0 and l != r )
+						return false;
+				}
+				return string_view() == rhs.string_view();
+			case Type::ARRAY:
+				return _data.p == rhs._data.p or
+				       array_items() == rhs.array_items();
+			case Type::OBJECT:
+			{
+				if ( _data.p == rhs._data.p )
+					return true;
+				auto l = static_cast<const details::JsonObject *>( _data.p );
+				auto r = static_cast<const details::JsonObject *>( rhs._data.p );
+				if ( l->value.size() != r->value.size() )
+					return false;
+				// both indexed with different keys
+				auto li = l->index.load( std::memory_order_acquire );
+				auto ri = r->index.load( std::memory_order_acquire );
+				if ( li != nullptr and ri != nullptr and
+				     li->keysHash != ri->keysHash )
+					return false;
+				return l->value == r->value;
+			}
+		}
+	}
+	return false;
+}
+
+bool Json::operator<( const Json &rhs ) const
+{
+	if ( type() == rhs.type() )
+	{
+		switch ( type() )
+		{
+			case Type::NUL:
+				return true;
+			case Type::NUMBER:
+				switch ( number_type() )
+				{
+					case Json::NumberType::DOUBLE:
+						switch ( rhs.number_type() )
+						{
+							case Json::NumberType::DOUBLE:
+								return _data.d < rhs._data.d;
+							case Json::NumberType::INTEGER:
+								return _data.d < rhs._data.i32;
+							case Json::NumberType::INTEGER64:
+								return _data.d < rhs._data.i64;
+							default:
+								assert( false );
+								break;
+						}
+						break;
+					case Json::NumberType::INTEGER:
+						switch ( rhs.number_type() )
+						{
+							case Json::NumberType::DOUBLE:
+								return _data.i32 < rhs._data.d;
+							case Json::NumberType::INTEGER:
+								return _data.i32 < rhs._data.i32;
+							case Json::NumberType::INTEGER64:
+								return _data.i32 < rhs._data.i64;
+							default:
+								assert( false );
+								break;
+						}
+						break;
+					case Json::NumberType::INTEGER64:
+						switch ( rhs.number_type() )
+						{
+							case Json::NumberType::DOUBLE:
+								return _data.i64 < rhs._data.d;
+							case Json::NumberType::INTEGER:
+								return _data.i64 < rhs._data.i32;
+							case Json::NumberType::INTEGER64:
+								return _data.i64 < rhs._data.i64;
+							default:
+								assert( false );
+								break;
+						}
+						break;
+					default:
+						assert( false );
+						break;
+				}
+				break;
+			case Type::BOOL:
+				return _data.b < rhs._data.b;
+			case Type::STRING:
+				return string_view() < rhs.string_view();
+			case Type::ARRAY:
+				return array_items() < rhs.array_items();
+			case Type::OBJECT:
+				return object_items() < rhs.object_items();
+			default:
+				assert( false );
+				break;
+		}
+	}
+	return type() < rhs.type();
+}
+
+namespace details {
+
+static const int max_depth = 200;
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Parsing
+ */
+
+/* esc(c)
+ *
+ * Format char c suitable for printing in an error message.
+ */
+inline std::string esc( char c )
+{
+	char buf[12];
+	if ( static_cast<uint8_t>( c ) >= 0x20 and
+	     static_cast<uint8_t>( c ) <= 0x7f )
+	{
+		snprintf( buf, sizeof buf, "'%c' (%d)", c, c );
+	}
+	else
+	{
+		snprintf( buf, sizeof buf, "(%d)", c );
+	}
+	return std::string( buf );
+}
+
+inline bool is_json_space( char c )
+{
+	return c == ' ' or c == '\n' or c == '\r' or c == '\t';
+}
+
+inline bool in_range( long x, long lower, long upper )
+{
+	return ( x >= lower and x <= upper );
+}
+
+long hexstrtol( const std::string_view &s )
+{
+	long r = 0;
+	for ( auto it : s )
+	{
+		auto c = std::tolower( it );
+		r = ( r * 16 ) + ( c < 'a' ? c - '0' : c - 'a' + 10 );
+	}
+	return r;
+}
+
+/* make_object_data(members, start)
+ *
+ * Move members from start to the end into a sorted object, without duplicated
+ * keys, and shrink members back to start.
+ */
+Json::object make_object_data(
+    std::vector<std::pair<std::string, Json>> &members, size_t start )
+{
+	Json::object object_data;
+	object_data.storage().assign(
+	    std::make_move_iterator( members.begin() + start ),
+	    std::make_move_iterator( members.end() ) );
+	members.resize( start );
+
+	std::sort( object_data.storage().begin(),
+	           object_data.storage().end(),
+	           []( const auto &lhs, const auto &rhs ) {
+		           return lhs.first < rhs.first;
+	           } );
+	auto last = std::unique( object_data.storage().begin(),
+	                         object_data.storage().end(),
+	                         []( const auto &lhs, const auto &rhs ) {
+		                         return lhs.first == rhs.first;
+	                         } );
+	object_data.storage().erase( last, object_data.storage().end() );
+	return object_data;
+}
+
+/* JsonParser
+ *
+ * Object that tracks all state of an in-progress parse.
+ */
+struct JsonParser final
+{
+	const std::string_view &str;
+	std::string_view::const_iterator it;
+	bool failed = false;
+	std::string &err;
+	JsonParse strategy;
+	JsonArena *arena = nullptr;
+	JsonInternTable *intern = nullptr;
+	StructuralIndex structural;
+	bool indexed = false;
+
+	struct InlineString
+	{
+		char inlineStorage[1024];
+		std::unique_ptr<char[]> _heapStorage;
+		size_t _capacity = 1024;
+		char *_buffer, *_end;
+		InlineString()
+		{
+			_buffer = inlineStorage;
+			_end = _buffer;
+		}
+		~InlineString() = default;
+		void push_back( char c )
+		{
+			auto s = size();
+			if ( s >= ( _capacity - 2 ) )
+			{
+				// need to grow
+				_capacity = (_capacity / 10) * 16; // 1.6 grow
+				auto newBuffer = std::make_unique<char[]>( _capacity );
+				memcpy( newBuffer.get(), _buffer, s );
+				_heapStorage = std::move( newBuffer );
+				_buffer = _heapStorage.get();
+				_end = _buffer + s;
+			}
+			*_end = c;
+			++_end;
+		}
+		size_t size() const { return _end - _buffer; }
+		const char *c_str() const
+		{
+			*_end = 0;
+			return _buffer;
+		}
+
+		const char *begin() const { return _buffer; }
+		const char *end() const { return _end; }
+
+		void clear() { _end = _buffer; }
+
+		size_t capacity() const { return _capacity; }
+		void reserve( size_t l )
+		{
+			if ( l > _capacity )
+			{
+				auto s = size();
+				_capacity = std::max( l, _capacity * 2 );
+				std::unique_ptr<char[]> newBuffer( new char[_capacity] );
+				memcpy( newBuffer.get(), _buffer, s );
+				_heapStorage = std::move( newBuffer );
+				_buffer = _heapStorage.get();
+				_end = _buffer + s;
+			}
+		}
+		void append( const char *p, size_t n )
+		{
+			// keep room for c_str()
+			reserve( size() + n + 2 );
+			memcpy( _end, p, n );
+			_end += n;
+		}
+	};
+
+	InlineString collect_string;
+	std::vector<Json> collect_array_data;
+	std::vector<std::pair<std::string, Json>> collect_object_data;
+
+	JsonParser( const std::string_view &i_in,
+	            std::string &i_err,
+	            JsonParse i_strategy ) :
+	    str( i_in ),
+	    err( i_err ),
+	    strategy( i_strategy )
+	{
+		it = str.begin();
+
+		// comments could hide quotes from the structural index
+		if ( strategy == JsonParse::STANDARD )
+		{
+			structural.reset( str );
+			indexed = true;
+		}
+	}
+
+	Json fail( std::string &&msg ) { return fail( std::move( msg ), Json() ); }
+
+	/* make_node<NODE>(value, type)
+	 *
+	 * Allocate a string, array or object node, from the arena if there is one.
+	 */
+	template<typename NODE, typename T>
+	Json make_node( T &&value, Json::Type type )
+	{
+		if ( arena == nullptr )
+			return Json( new NODE( std::forward<T>( value ) ), type );
+
+		// make room first, the node is registered once constructed and
+		// push_back cannot throw
+		auto &nodes = arena->_nodes;
+		if ( nodes.size() == nodes.capacity() )
+			nodes.reserve( std::max<size_t>( 256, nodes.capacity() * 2 ) );
+		auto node = new ( arena->allocate( sizeof( NODE ), alignof( NODE ) ) )
+		    NODE( std::forward<T>( value ) );
+		node->refCount = 0;
+		nodes.push_back( node );
+		return Json( node, type );
+	}
+
+	/* make_string(value)
+	 *
+	 * A string, inline if short enough, shared if there is an intern table.
+	 */
+	Json make_string( const std::string_view &value )
+	{
+		if ( value.size() <= Json::kInlineCapacity )
+			return Json( value );
+		if ( arena != nullptr )
+		{
+			// the characters are in the arena too, the node has nothing to
+			// destroy and is not registered for reset()
+			auto chars = static_cast<char *>( arena->allocate( value.size(), 1 ) );
+			std::memcpy( chars, value.data(), value.size() );
+			auto node =
+			    new ( arena->allocate( sizeof( JsonString ), alignof( JsonString ) ) )
+			        JsonString( std::string_view( chars, value.size() ) );
+			node->refCount = 0;
+			return Json( node, Json::Type::STRING );
+		}
+		if ( intern == nullptr )
+			return make_node<JsonString>( std::string( value ),
+			                              Json::Type::STRING );
+
+		auto &strings = intern->_impl->strings;
+		auto found = strings.find( value );
+		if ( found != strings.end() )
+			return found->second;
+		auto node = new JsonString( std::string( value ) );
+		Json result( node, Json::Type::STRING );
+		strings.emplace( node->text, result );
+		return result;
+	}
+
+	/* make_array(start)
+	 *
+	 * An array of the collected items from start, which are removed.
+	 */
+	Json make_array( size_t start )
+	{
+		auto begin = collect_array_data.begin() + start;
+		auto end = collect_array_data.end();
+		size_t count = end - begin;
+		if ( intern == nullptr or count > intern->_impl->maxItems )
+		{
+			auto result = make_node<JsonArray>(
+			    Json::array( std::make_move_iterator( begin ),
+			                 std::make_move_iterator( end ) ),
+			    Json::Type::ARRAY );
+			collect_array_data.resize( start );
+			return result;
+		}
+
+		size_t hash = count;
+		for ( auto i = begin; i != end; ++i )
+			hash_mix( hash, shallow_hash( *i ) );
+		auto &containers = intern->_impl->containers;
+		auto range = containers.equal_range( hash );
+		for ( auto i = range.first; i != range.second; ++i )
+		{
+			auto &candidate = i->second;
+			if ( candidate.is_array() and
+			     std::equal( begin,
+			                 end,
+			                 candidate.array_items().begin(),
+			                 candidate.array_items().end(),
+			                 shallow_equal ) )
+			{
+				collect_array_data.resize( start );
+				return candidate;
+			}
+		}
+		auto result = Json( new JsonArray( Json::array(
+		                        std::make_move_iterator( begin ),
+		                        std::make_move_iterator( end ) ) ),
+		                    Json::Type::ARRAY );
+		collect_array_data.resize( start );
+		containers.emplace( hash, result );
+		return result;
+	}
+
+	/* make_object(value)
+	 *
+	 * An object node for value, shared if there is an intern table.
+	 */
+	Json make_object( Json::object &&value )
+	{
+		if ( intern == nullptr or value.size() > intern->_impl->maxItems )
+			return make_node<JsonObject>( std::move( value ),
+			                              Json::Type::OBJECT );
+
+		size_t hash = ~value.size();
+		for ( auto &item : value )
+		{
+			hash_mix( hash, std::hash<std::string>()( item.first ) );
+			hash_mix( hash, shallow_hash( item.second ) );
+		}
+		auto &containers = intern->_impl->containers;
+		auto range = containers.equal_range( hash );
+		for ( auto i = range.first; i != range.second; ++i )
+		{
+			auto &candidate = i->second;
+			if ( candidate.is_object() and
+			     std::equal( value.begin(),
+			                 value.end(),
+			                 candidate.object_items().begin(),
+			                 candidate.object_items().end(),
+			                 []( const auto &lhs, const auto &rhs ) {
+				                 return lhs.first == rhs.first and
+				                        shallow_equal( lhs.second,
+				                                       rhs.second );
+			                 } ) )
+				return candidate;
+		}
+		auto result =
+		    Json( new JsonObject( std::move( value ) ), Json::Type::OBJECT );
+		containers.emplace( hash, result );
+		return result;
+	}
+	template<typename T>
+	T fail( std::string &&msg, const T err_ret )
+	{
+		if ( not failed )
+			err = std::move( msg );
+		failed = true;
+		return err_ret;
+	}
+
+	/* get_next_token()
+	 *
+	 * Return the next non-whitespace character. If the end of the input is
+	 * reached, flag an error and return 0.
+	 */
+	char get_next_token()
+	{
+		consume_garbage();
+		if ( it == str.end() )
+			return fail( "unexpected end of input", 0 );
+
+		return *it++;
+	}
+
+	/* consume_whitespace()
+	 *
+	 * Advance until the current character is non-whitespace.
+	 */
+	void consume_whitespace()
+	{
+		while ( it != str.end() and std::isspace( *it ) )
+		{
+			++it;
+			// in a run of json whitespace, the next token start is indexed
+			if ( indexed and it != str.end() and is_json_space( *it ) and
+			     is_json_space( *( it - 1 ) ) )
+				skip_indexed_whitespace();
+		}
+	}
+
+	never_inline_func void skip_indexed_whitespace()
+	{
+		it = str.begin() + structural.next( it - str.begin() );
+	}
+
+	/* consume_comment()
+	 *
+	 * Advance comments (c-style inline and multiline).
+	 */
+	bool consume_comment()
+	{
+		bool comment_found = false;
+		if ( it != str.end() and *it == '/' )
+		{
+			it++;
+			if ( it == str.end() )
+				return fail( "unexpected end of input inside comment", false );
+			if ( *it == '/' )
+			{ // inline comment
+				it++;
+				if ( it == str.end() )
+					return fail(
+					    "unexpected end of input inside inline comment",
+					    false );
+				// advance until next line
+				while ( *it != '\n' )
+				{
+					it++;
+					if ( it == str.end() )
+						return fail(
+						    "unexpected end of input inside inline comment",
+						    false );
+				}
+				comment_found = true;
+			}
+			else if ( *it == '*' )
+			{ // multiline comment
+				it++;
+				if ( it > str.end() - 2 )
+					return fail(
+					    "unexpected end of input inside multi-line comment",
+					    false );
+				// advance until closing tokens
+				while ( not ( *it == '*' and *( it + 1 ) == '/' ) )
+				{
+					it++;
+					if ( it > str.end() - 2 )
+						return fail(
+						    "unexpected end of input inside multi-line comment",
+						    false );
+				}
+				it += 2;
+				if ( it == str.end() )
+					return fail(
+					    "unexpected end of input inside multi-line comment",
+					    false );
+				comment_found = true;
+			}
+			else
+				return fail( "malformed comment", false );
+		}
+		return comment_found;
+	}
+
+	/* consume_garbage()
+	 *
+	 * Advance until the current character is non-whitespace and non-comment.
+	 */
+	void consume_garbage()
+	{
+		consume_whitespace();
+		if ( strategy == JsonParse::COMMENTS )
+		{
+			bool comment_found = false;
+			do
+			{
+				comment_found = consume_comment();
+				consume_whitespace();
+			} while ( comment_found );
+		}
+	}
+
+	/* encode_utf8(pt)
+	 *
+	 * Encode pt as UTF-8 and add it to the collect string.
+	 */
+	void encode_utf8( long pt )
+	{
+		if ( pt < 0 )
+			return;
+
+		if ( pt < 0x80 )
+		{
+			collect_string.push_back( static_cast<char>( pt ) );
+		}
+		else if ( pt < 0x800 )
+		{
+			collect_string.push_back( static_cast<char>( ( pt >> 6 ) | 0xC0 ) );
+			collect_string.push_back(
+			    static_cast<char>( ( pt & 0x3F ) | 0x80 ) );
+		}
+		else if ( pt < 0x10000 )
+		{
+			collect_string.push_back(
+			    static_cast<char>( ( pt >> 12 ) | 0xE0 ) );
+			collect_string.push_back(
+			    static_cast<char>( ( ( pt >> 6 ) & 0x3F ) | 0x80 ) );
+			collect_string.push_back(
+			    static_cast<char>( ( pt & 0x3F ) | 0x80 ) );
+		}
+		else
+		{
+			collect_string.push_back(
+			    static_cast<char>( ( pt >> 18 ) | 0xF0 ) );
+			collect_string.push_back(
+			    static_cast<char>( ( ( pt >> 12 ) & 0x3F ) | 0x80 ) );
+			collect_string.push_back(
+			    static_cast<char>( ( ( pt >> 6 ) & 0x3F ) | 0x80 ) );
+			collect_string.push_back(
+			    static_cast<char>( ( pt & 0x3F ) | 0x80 ) );
+		}
+	}
+
+	/* parse_string()
+	 *
+	 * Parse a string, starting at the current position.
+	 */
+	void parse_string()
+	{
+		collect_string.clear();
+
+		long last_escaped_codepoint = -1;
+		for ( ;; )
+		{
+			// The usual case: a run of non-escaped characters
+			auto run = str.data() + ( it - str.begin() );
+			auto runEnd = skip_plain_chars<false>( run, str.data() + str.size() );
+			if ( runEnd != run )
+			{
+				encode_utf8( last_escaped_codepoint );
+				last_escaped_codepoint = -1;
+				collect_string.append( run, runEnd - run );
+				it += runEnd - run;
+			}
+
+			if ( it == str.end() )
+			{
+				fail( "unexpected end of input in string" );
+				return;
+			}
+
+			char ch = *it++;
+
+			if ( ch == '"' )
+			{
+				encode_utf8( last_escaped_codepoint );
+				return;
+			}
+
+			if ( in_range( ch, 0, 0x1f ) )
+			{
+				fail( "unescaped " + esc( ch ) + " in string" );
+				return;
+			}
+
+			// Handle escapes
+			if ( it == str.end() )
+			{
+				fail( "unexpected end of input in string" );
+				return;
+			}
+
+			ch = *it++;
+
+			if ( ch == 'u' )
+			{
+				// Extract 4-byte escape sequence
+				auto esc = str.substr( it - str.begin(), 4 );
+				// Explicitly check length of the substring. The following loop
+				// relies on std::string returning the terminating NUL when
+				// accessing str[length]. Checking here reduces brittleness.
+				if ( esc.length() < 4 )
+				{
+					fail( "bad \\u escape: " + std::string( esc ) );
+					return;
+				}
+				for ( int j = 0; j < 4; j++ )
+				{
+					if ( not in_range( esc[j], 'a', 'f' ) and
+					     not in_range( esc[j], 'A', 'F' ) and
+					     not in_range( esc[j], '0', '9' ) )
+					{
+						fail( "bad \\u escape: " + std::string( esc ) );
+						return;
+					}
+				}
+
+				long codepoint = hexstrtol( esc );
+
+				// JSON specifies that characters outside the BMP shall be
+				// encoded as a pair of 4-hex-digit \u escapes encoding their
+				// surrogate pair components. Check whether we're in the middle
+				// of such a beast: the previous codepoint was an escaped lead
+				// (high) surrogate, and this is a trail (low) surrogate.
+				if ( in_range( last_escaped_codepoint, 0xD800, 0xDBFF ) and
+				     in_range( codepoint, 0xDC00, 0xDFFF ) )
+				{
+					// Reassemble the two surrogate pairs into one astral-plane
+					// character, per the UTF-16 algorithm.
+					encode_utf8(
+					    ( ( ( last_escaped_codepoint - 0xD800 ) << 10 ) |
+					      ( codepoint - 0xDC00 ) ) +
+					    0x10000 );
+					last_escaped_codepoint = -1;
+				}
+				else
+				{
+					encode_utf8( last_escaped_codepoint );
+					last_escaped_codepoint = codepoint;
+				}
+
+				it += 4;
+				continue;
+			}
+
+			encode_utf8( last_escaped_codepoint );
+			last_escaped_codepoint = -1;
+
+			if ( ch == 'b' )
+				collect_string.push_back( '\b' );
+			else if ( ch == 'f' )
+				collect_string.push_back( '\f' );
+			else if ( ch == 'n' )
+				collect_string.push_back( '\n' );
+			else if ( ch == 'r' )
+				collect_string.push_back( '\r' );
+			else if ( ch == 't' )
+				collect_string.push_back( '\t' );
+			else if ( ch == '"' or ch == '\\' or ch == '/' )
+				collect_string.push_back( ch );
+			else
+			{
+				fail( "invalid escape character " + esc( ch ) );
+				return;
+			}
+		}
+	}
+
+	/* parse_digits(io_value)
+	 *
+	 * Accumulate a run of digits in io_value, 8 at a time while the input
+	 * allows it. Wraps around past 19 digits, the caller counts them.
+	 */
+	void parse_digits( uint64_t &io_value )
+	{
+		while ( str.end() - it >= 8 )
+		{
+			uint64_t v;
+			memcpy( &v, str.data() + ( it - str.begin() ), 8 );
+			v = little_to_native( v );
+			if ( not IsEightDigits( v ) )
+				break;
+			io_value = io_value * 100000000 + ParseEightDigits( v );
+			it += 8;
+		}
+		while ( RAPIDJSON_LIKELY( *it >= '0' and *it <= '9' ) )
+		{
+			io_value = io_value * 10 + static_cast<unsigned>( *it - '0' );
+			++it;
+		}
+	}
+
+	/* parse_number()
+	 *
+	 * Parse a number, an int if it fits in 32 bits, an int64 if it fits in
+	 * 64 bits, a double otherwise.
+	 */
+	Json parse_number()
+	{
+		// Parse minus
+		bool minus = false;
+		if ( *it == '-' )
+		{
+			minus = true;
+			++it;
+		}
+
+		// Parse int: zero / ( digit1-9 *DIGIT )
+		uint64_t mantissa = 0;
+		auto intBegin = it;
+		if ( RAPIDJSON_UNLIKELY( *it == '0' ) )
+			++it;
+		else if ( RAPIDJSON_LIKELY( *it >= '1' and *it <= '9' ) )
+			parse_digits( mantissa );
+		else
+			return fail( "invalid number" );
+		auto intEnd = it;
+
+		// Parse frac = decimal-point 1*DIGIT
+		auto fracBegin = it, fracEnd = it;
+		if ( *it == '.' )
+		{
+			++it;
+			if ( RAPIDJSON_UNLIKELY( not( *it >= '0' and *it <= '9' ) ) )
+				return fail( "missing fraction for number" );
+			fracBegin = it;
+			parse_digits( mantissa );
+			fracEnd = it;
+		}
+
+		// Parse exp = e [ minus / plus ] 1*DIGIT
+		bool hasExp = false;
+		int64_t exp = 0;
+		if ( *it == 'e' or *it == 'E' )
+		{
+			hasExp = true;
+			++it;
+			bool expMinus = false;
+			if ( *it == '+' )
+				++it;
+			else if ( *it == '-' )
+			{
+				++it;
+				expMinus = true;
+			}
+			if ( RAPIDJSON_UNLIKELY( not( *it >= '0' and *it <= '9' ) ) )
+				return fail( "missing exponent for number" );
+			while ( RAPIDJSON_LIKELY( *it >= '0' and *it <= '9' ) )
+			{
+				// way past the range of double, only consume the rest
+				if ( exp < 0x10000000 )
+					exp = exp * 10 + static_cast<int>( *it - '0' );
+				++it;
+			}
+			if ( expMinus )
+				exp = -exp;
+		}
+
+		size_t count = ( intEnd - intBegin ) + ( fracEnd - fracBegin );
+		if ( fracBegin == fracEnd and not hasExp and count <= 19 )
+		{
+			// integer
+			if ( not minus )
+			{
+				if ( mantissa <= uint64_t( std::numeric_limits<int>::max() ) )
+					return static_cast<int>( mantissa );
+				if ( mantissa <= uint64_t( std::numeric_limits<int64_t>::max() ) )
+					return static_cast<int64_t>( mantissa );
+				return static_cast<double>( mantissa );
+			}
+			if ( mantissa <= uint64_t( 1 ) << 31 )
+				return static_cast<int>( -static_cast<int64_t>( mantissa ) );
+			if ( mantissa <= uint64_t( 1 ) << 63 )
+				return static_cast<int64_t>( ~mantissa + 1 );
+			return -static_cast<double>( mantissa );
+		}
+
+		// value is digits * 10^exp
+		exp -= fracEnd - fracBegin;
+
+		// first significant digit
+		auto first = intBegin;
+		if ( count > 19 )
+		{
+			while ( first != fracEnd and ( *first == '0' or *first == '.' ) )
+			{
+				if ( *first == '0' )
+					--count;
+				++first;
+			}
+		}
+
+		double d;
+		if ( count <= 19 )
+		{
+			if ( mantissa == 0 )
+				return minus ? -0.0 : 0.0;
+			// Clinger's fast path, then Eisel-Lemire
+			int q = static_cast<int>(
+			    std::clamp<int64_t>( exp, -0x20000000, 0x20000000 ) );
+			if ( mantissa <= RAPIDJSON_UINT64_C2( 0x1FFFFF, 0xFFFFFFFF ) and
+			     StrtodFast( static_cast<double>( mantissa ), q, &d ) )
+				return minus ? -d : d;
+			if ( not StrtodEiselLemire( mantissa, q, &d ) )
+				d = parse_number_slow( first, fracEnd, q );
+		}
+		else
+		{
+			// keep the first 19 significant digits, the value is between w
+			// and w + 1
+			uint64_t w = 0;
+			auto digit = first;
+			for ( int n = 0; n < 19; ++digit )
+			{
+				if ( *digit != '.' )
+				{
+					w = w * 10 + static_cast<unsigned>( *digit - '0' );
+					++n;
+				}
+			}
+			int q = static_cast<int>( std::clamp<int64_t>(
+			    exp + int64_t( count ) - 19, -0x20000000, 0x20000000 ) );
+			double d2;
+			if ( not StrtodEiselLemire( w, q, &d ) or
+			     not StrtodEiselLemire( w + 1, q, &d2 ) or d != d2 )
+				d = parse_number_slow( first, fracEnd, exp );
+		}
+		if ( RAPIDJSON_UNLIKELY( std::isinf( d ) ) )
+			return fail( "number is too big" );
+		return minus ? -d : d;
+	}
+
+	/* parse_number_slow(begin, end, exp)
+	 *
+	 * The digits from begin to end (skipping the decimal point) times 10^exp,
+	 * with arbitrary precision.
+	 */
+	double parse_number_slow( std::string_view::const_iterator i_begin,
+	                          std::string_view::const_iterator i_end,
+	                          int64_t i_exp )
+	{
+		collect_string.clear();
+		for ( ; i_begin != i_end; ++i_begin )
+		{
+			if ( *i_begin != '.' )
+				collect_string.push_back( *i_begin );
+		}
+		size_t length = collect_string.size();
+		int exp = static_cast<int>(
+		    std::clamp<int64_t>( i_exp, -0x20000000, 0x20000000 ) );
+		return StrtodFullPrecision( collect_string.c_str(), length, length, exp );
+	}
+
+	/* expect(str, res)
+	 *
+	 * Expect that 'str' starts at the character that was just read. If it does,
+	 * advance the input and return res. If not, flag an error.
+	 */
+	Json expect( const std::string_view &expected, Json res )
+	{
+		assert( it != str.begin() );
+		--it;
+		auto tmp = str.substr( it - str.begin(), expected.length() );
+		if ( tmp == expected )
+		{
+			it += expected.length();
+			return res;
+		}
+		else
+		{
+			return fail( "parse error: expected " + std::string( expected ) +
+			             ", got " + std::string( tmp ) );
+		}
+	}
+
+	void parse_json( int depth, Json &output )
+	{
+		if ( depth > max_depth )
+		{
+			output = fail( "exceeded maximum nesting depth" );
+			return;
+		}
+
+		char ch = get_next_token();
+		if ( failed )
+			return;
+
+		if ( ch == '-' or ( ch >= '0' and ch <= '9' ) )
+		{
+			it--;
+			output = parse_number();
+			return;
+		}
+
+		if ( ch == 't' )
+		{
+			output = expect( "true", true );
+			return;
+		}
+
+		if ( ch == 'f' )
+		{
+			output = expect( "false", false );
+			return;
+		}
+
+		if ( ch == 'n' )
+		{
+			output = expect( "null", Json() );
+			return;
+		}
+
+		if ( ch == '"' )
+		{
+			parse_string();
+			output = make_string(
+			    std::string_view( collect_string.begin(), collect_string.size() ) );
+			return;
+		}
+
+		if ( ch == '{' )
+		{
+			ch = get_next_token();
+			if ( ch == '}' )
+			{
+				output = make_object( Json::object() );
+				return;
+			}
+
+			auto prevSize = collect_object_data.size();
+
+			for ( ;; )
+			{
+				if ( ch != '"' )
+				{
+					output =
+					    fail( "expected '\"' in object, got " + esc( ch ) );
+					return;
+				}
+
+				parse_string();
+				if ( failed )
+					return;
+
+				std::string object_key( collect_string.begin(),
+				                        collect_string.end() );
+
+				ch = get_next_token();
+				if ( ch != ':' )
+				{
+					output = fail( "expected ':' in object, got " + esc( ch ) );
+					return;
+				}
+
+				Json v;
+				parse_json( depth + 1, v );
+				collect_object_data.emplace_back( std::move( object_key ),
+				                                  std::move( v ) );
+				if ( failed )
+					return;
+
+				ch = get_next_token();
+				if ( ch == '}' )
+					break;
+				if ( ch != ',' )
+				{
+					output = fail( "expected ',' in object, got " + esc( ch ) );
+					return;
+				}
+
+				ch = get_next_token();
+			}
+			output =
+			    make_object( make_object_data( collect_object_data, prevSize ) );
+			return;
+		}
+
+		if ( ch == '[' )
+		{
+			ch = get_next_token();
+			if ( ch == ']' )
 			{
-				output.append( 1, '[' );
-				for ( const auto &value :
-				      ( (details::JsonArray *)_data.p )->value )
-				{
-					value.dump( output );
-					output.append( 1, ',' );
-				}
-				output.back() = ']';
+				output = make_array( collect_array_data.size() );
+				return;
 			}
-			break;
-		case Type::OBJECT:
-			if ( ( (details::JsonObject *)_data.p )->value.empty() )
-				output.append( "{}", 2 );
-			else
+
+			auto prevSize = collect_array_data.size();
+
+			for ( ;; )
 			{
-				output.append( 1, '{' );
-				for ( const auto &kv :
-				      ( (details::JsonObject *)_data.p )->value )
+				--it;
+				Json v;
+				parse_json( depth + 1, v );
+				if ( failed )
+					return;
+				collect_array_data.push_back( std::move( v ) );
+
+				ch = get_next_token();
+				if ( ch == ']' )
+					break;
+				if ( ch != ',' )
 				{
-					::dump( kv.first, output );
-					output.append( 1, ':' );
-					kv.second.dump( output );
-					output.append( 1, ',' );
+					output = fail( "expected ',' in list, got " + esc( ch ) );
+					return;
 				}
-				output.back() = '}';
+
+				ch = get_next_token();
+				(void)ch;
 			}
-			break;
-	}
-}
+			output = make_array( prevSize );
+			return;
+		}
 
-/* * * * * * * * * * * * * * * * * * * *
- * Comparison
- */
+		output = fail( "expected value, got " + esc( ch ) );
+	}
 
-bool Json::operator==( const Json &rhs ) const
-{
-	if ( type() == rhs.type() )
+	/* skip_json(depth)
+	 *
+	 * Check a value like parse_json, without building it.
+	 */
+	void skip_json( int depth )
 	{
-		switch ( type() )
+		if ( depth > max_depth )
 		{
-			case Type::NUL:
-				return true;
-			case Type::NUMBER:
-				switch ( number_type() )
-				{
-					case Json::NumberType::DOUBLE:
-						switch ( rhs.number_type() )
-						{
-							case Json::NumberType::DOUBLE:
-								return _data.d == rhs._data.d;
-							case Json::NumberType::INTEGER:
-								return _data.d == rhs._data.i32;
-							case Json::NumberType::INTEGER64:
-								return _data.d == rhs._data.i64;
-							default:
-								assert( false );
-								break;
-						}
-						break;
-					case Json::NumberType::INTEGER:
-						switch ( rhs.number_type() )
-						{
-							case Json::NumberType::DOUBLE:
-								return _data.i32 == rhs._data.d;
-							case Json::NumberType::INTEGER:
-								return _data.i32 == rhs._data.i32;
-							case Json::NumberType::INTEGER64:
-								return _data.i32 == rhs._data.i64;
-							default:
-								assert( false );
-								break;
-						}
-						break;
-					case Json::NumberType::INTEGER64:
-						switch ( rhs.number_type() )
-						{
-							case Json::NumberType::DOUBLE:
-								return _data.i64 == rhs._data.d;
-							case Json::NumberType::INTEGER:
-								return _data.i64 == rhs._data.i32;
-							case Json::NumberType::INTEGER64:
-								return _data.i64 == rhs._data.i64;
-							default:
-								assert( false );
-								break;
-						}
-						break;
-					default:
-						assert( false );
-						break;
-				}
-				break;
-			case Type::BOOL:
-				return _data.b == rhs._data.b;
-			case Type::STRING:
-				return string_value() == rhs.string_value();
-			case Type::ARRAY:
-				return array_items() == rhs.array_items();
-			case Type::OBJECT:
-				return object_items() == rhs.object_items();
+			fail( "exceeded maximum nesting depth" );
+			return;
 		}
-	}
-	return false;
-}
 
-bool Json::operator<( const Json &rhs ) const
-{
-	if ( type() == rhs.type() )
-	{
-		switch ( type() )
+		char ch = get_next_token();
+		if ( failed )
+			return;
+
+		if ( ch == '{' or ch == '[' )
 		{
-			case Type::NUL:
-				return true;
-			case Type::NUMBER:
-				switch ( number_type() )
+			char close = ch == '{' ? '}' : ']';
+			ch = get_next_token();
+			if ( ch == close )
+				return;
+			for ( ;; )
+			{
+				if ( close == '}' )
 				{
-					case Json::NumberType::DOUBLE:
-						switch ( rhs.number_type() )
-						{
-							case Json::NumberType::DOUBLE:
-								return _data.d < rhs._data.d;
-							case Json::NumberType::INTEGER:
-								return _data.d < rhs._data.i32;
-							case Json::NumberType::INTEGER64:
-								return _data.d < rhs._data.i64;
-							default:
-								assert( false );
-								break;
-						}
-						break;
-					case Json::NumberType::INTEGER:
-						switch ( rhs.number_type() )
-						{
-							case Json::NumberType::DOUBLE:
-								return _data.i32 < rhs._data.d;
-							case Json::NumberType::INTEGER:
-								return _data.i32 < rhs._data.i32;
-							case Json::NumberType::INTEGER64:
-								return _data.i32 < rhs._data.i64;
-							default:
-								assert( false );
-								break;
-						}
-						break;
-					case Json::NumberType::INTEGER64:
-						switch ( rhs.number_type() )
-						{
-							case Json::NumberType::DOUBLE:
-								return _data.i64 < rhs._data.d;
-							case Json::NumberType::INTEGER:
-								return _data.i64 < rhs._data.i32;
-							case Json::NumberType::INTEGER64:
-								return _data.i64 < rhs._data.i64;
-							default:
-								assert( false );
-								break;
-						}
-						break;
-					default:
-						assert( false );
-						break;
+					if ( ch != '"' )
+					{
+						fail( "expected '\"' in object, got " + esc( ch ) );
+						return;
+					}
+					parse_string();
+					ch = get_next_token();
+					if ( ch != ':' )
+					{
+						fail( "expected ':' in object, got " + esc( ch ) );
+						return;
+					}
 				}
-				break;
-			case Type::BOOL:
-				return _data.b < rhs._data.b;
-			case Type::STRING:
-				return string_value() < rhs.string_value();
-			case Type::ARRAY:
-				return array_items() < rhs.array_items();
-			case Type::OBJECT:
-				return object_items() < rhs.object_items();
-			default:
-				assert( false );
-				break;
+				else
+					--it;
+				skip_json( depth + 1 );
+				if ( failed )
+					return;
+
+				ch = get_next_token();
+				if ( ch == close )
+					return;
+				if ( ch != ',' )
+				{
+					fail( std::string( close == '}' ? "expected ',' in object, got "
+					                                : "expected ',' in list, got " ) +
+					      esc( ch ) );
+					return;
+				}
+				ch = get_next_token();
+			}
+		}
+
+		if ( ch == '"' )
+			parse_string();
+		else if ( ch == '-' or ( ch >= '0' and ch <= '9' ) )
+		{
+			--it;
+			parse_number();
 		}
+		else if ( ch == 't' )
+			expect( "true", true );
+		else if ( ch == 'f' )
+			expect( "false", false );
+		else if ( ch == 'n' )
+			expect( "null", Json() );
+		else
+			fail( "expected value, got " + esc( ch ) );
 	}
-	return type() < rhs.type();
+};
 }
 
 namespace details {
 
-static const int max_depth = 200;
-
-/* * * * * * * * * * * * * * * * * * * *
- * Parsing
- */
-
-/* esc(c)
+/* parse_document(parser)
  *
- * Format char c suitable for printing in an error message.
+ * Parse a single value that must span the whole input.
  */
-inline std::string esc( char c )
+Json parse_document( JsonParser &parser )
 {
-	char buf[12];
-	if ( static_cast<uint8_t>( c ) >= 0x20 and
-	     static_cast<uint8_t>( c ) <= 0x7f )
-	{
-		snprintf( buf, sizeof buf, "'%c' (%d)", c, c );
-	}
-	else
-	{
-		snprintf( buf, sizeof buf, "(%d)", c );
-	}
-	return std::string( buf );
+	Json result;
+	parser.parse_json( 0, result );
+
+	// Check for any trailing garbage
+	parser.consume_garbage();
+	if ( parser.it != parser.str.end() )
+		result = parser.fail( "unexpected trailing" );
+
+	return result;
+}
+
+}
+
+Json Json::parse( const std::string_view &input,
+                  std::string &err,
+                  JsonParse strategy )
+{
+	details::JsonParser parser( input, err, strategy );
+	return details::parse_document( parser );
+}
+
+Json Json::parse( const std::string_view &input,
+                  std::string &err,
+                  JsonArena &arena,
+                  JsonParse strategy )
+{
+	details::JsonParser parser( input, err, strategy );
+	parser.arena = &arena;
+	return details::parse_document( parser );
 }
 
-inline bool in_range( long x, long lower, long upper )
+Json Json::parse( const std::string_view &input,
+                  std::string &err,
+                  JsonInternTable &table,
+                  JsonParse strategy )
 {
-	return ( x >= lower and x <= upper );
+	details::JsonParser parser( input, err, strategy );
+	parser.intern = &table;
+	return details::parse_document( parser );
 }
 
-long hexstrtol( const std::string_view &s )
+// Documented in sjson.h
+std::vector<Json> Json::parse_multi(
+    const std::string_view &input,
+    std::string_view::size_type &parser_stop_pos,
+    std::string &err,
+    JsonParse strategy )
 {
-	long r = 0;
-	for ( auto it : s )
+	std::vector<Json> json_vec;
+	details::JsonParser parser( input, err, strategy );
+	parser_stop_pos = 0;
+	while ( parser.it != input.end() and not parser.failed )
 	{
-		auto c = std::tolower( it );
-		r = ( r * 16 ) + ( c < 'a' ? c - '0' : c - 'a' + 10 );
+		Json v;
+		parser.parse_json( 0, v );
+		json_vec.push_back( std::move( v ) );
+		// Check for another object
+		parser.consume_garbage();
+		if ( not parser.failed )
+			parser_stop_pos = parser.it - input.begin();
 	}
-	return r;
+	return json_vec;
 }
 
-/* JsonParser
- *
- * Object that tracks all state of an in-progress parse.
- */
-struct JsonParser final
+namespace {
+
+// a newline delimited piece of the input, parsed on a worker
+struct NDJsonChunk
 {
-	const std::string_view &str;
-	std::string_view::const_iterator it;
-	bool failed = false;
-	std::string &err;
-	JsonParse strategy;
+	std::string_view text;
+	std::vector<su::Json> values;
+	std::string err;
+	su::job_ptr job; // null once done
+};
 
-	struct InlineString
+// The posted jobs write into their chunk and read the input, if the
+// callback throws they are waited for before either goes away.
+struct NDJsonInFlight
+{
+	std::deque<NDJsonChunk> chunks;
+
+	NDJsonInFlight() = default;
+	NDJsonInFlight( const NDJsonInFlight & ) = delete;
+	NDJsonInFlight &operator=( const NDJsonInFlight & ) = delete;
+	~NDJsonInFlight()
 	{
-		char inlineStorage[1024];
-		std::unique_ptr<char[]> _heapStorage;
-		size_t _capacity = 1024;
-		char *_buffer, *_end;
-		InlineString()
-		{
-			_buffer = inlineStorage;
-			_end = _buffer;
-		}
-		~InlineString() = default;
-		void push_back( char c )
-		{
-			auto s = size();
-			if ( s >= ( _capacity - 2 ) )
-			{
-				// need to grow
-				_capacity = (_capacity / 10) * 16; // 1.6 grow
-				auto newBuffer = std::make_unique<char[]>( _capacity );
-				memcpy( newBuffer.get(), _buffer, s );
-				_heapStorage = std::move( newBuffer );
-				_buffer = _heapStorage.get();
-				_end = _buffer + s;
-			}
-			*_end = c;
-			++_end;
-		}
-		size_t size() const { return _end - _buffer; }
-		const char *c_str() const
+		for ( auto &chunk : chunks )
 		{
-			*_end = 0;
-			return _buffer;
+			if ( chunk.job )
+				chunk.job->sprint();
 		}
+	}
+};
 
-		const char *begin() const { return _buffer; }
-		const char *end() const { return _end; }
+const size_t ndjson_chunk_size = 1024 * 1024;
 
-		void clear() { _end = _buffer; }
+}
 
-		size_t capacity() const { return _capacity; }
-		void reserve( size_t l )
+bool Json::parse_multi( const std::string_view &input,
+                        jobdispatcher &dispatcher,
+                        const std::function<bool( Json && )> &callback,
+                        std::string &err,
+                        JsonParse strategy )
+{
+	// enough chunks in flight to keep all workers busy, and no more, the
+	// memory used does not depend on the size of the input
+	const size_t maxInFlight =
+	    2 * std::max<size_t>( std::thread::hardware_concurrency(), 1 );
+	NDJsonInFlight guard;
+	auto &inFlight = guard.chunks;
+	size_t pos = 0;
+	auto post = [&]() {
+		// cut after the first newline past the chunk size, a newline can
+		// only be found between two tokens
+		auto end = input.find( '\n', std::min( pos + ndjson_chunk_size, input.size() ) );
+		end = end == std::string_view::npos ? input.size() : end + 1;
+		inFlight.emplace_back();
+		auto chunk = &inFlight.back();
+		chunk->text = input.substr( pos, end - pos );
+		pos = end;
+		auto parse = asyncJob_create( [chunk, strategy]( job & ) {
+			details::JsonParser parser( chunk->text, chunk->err, strategy );
+			parser.consume_garbage();
+			while ( parser.it != chunk->text.end() and not parser.failed )
+			{
+				Json v;
+				parser.parse_json( 0, v );
+				if ( not parser.failed )
+					chunk->values.push_back( std::move( v ) );
+				parser.consume_garbage();
+			}
+		} );
+		dispatcher.postAsync( parse );
+		chunk->job = std::move( parse );
+	};
+
+	err.clear();
+	bool ok = true;
+	size_t record = 0;
+	while ( pos < input.size() and inFlight.size() < maxInFlight )
+		post();
+	while ( not inFlight.empty() )
+	{
+		// blocks until done, or runs it here if no worker started it yet
+		auto &chunk = inFlight.front();
+		std::exchange( chunk.job, nullptr )->sprint();
+		if ( ok )
 		{
-			if ( l > _capacity )
+			for ( auto &it : chunk.values )
 			{
-				auto s = size();
-				_capacity = std::max( l, _capacity * 2 );
-				auto newBuffer = new char[_capacity];
-				memcpy( newBuffer, _buffer, s );
-				if ( _buffer != inlineStorage )
-					delete[] _buffer;
-				_buffer = newBuffer;
-				_end = _buffer + s;
+				++record;
+				if ( not callback( std::move( it ) ) )
+				{
+					ok = false;
+					break;
+				}
+			}
+			if ( ok and not chunk.err.empty() )
+			{
+				err = "record " + std::to_string( record + 1 ) + ": " + chunk.err;
+				ok = false;
 			}
 		}
-	};
+		inFlight.pop_front();
+		// on error, only wait for the chunks already posted, they point to
+		// the input
+		if ( ok and pos < input.size() )
+			post();
+	}
+	return ok;
+}
 
-	InlineString collect_string;
-	std::vector<Json> collect_array_data;
-	std::vector<std::pair<std::string, Json>> collect_object_data;
+std::vector<Json> Json::parse_multi( const std::string_view &input,
+                                     jobdispatcher &dispatcher,
+                                     std::string &err,
+                                     JsonParse strategy )
+{
+	std::vector<Json> json_vec;
+	parse_multi( input,
+	             dispatcher,
+	             [&json_vec]( Json &&v ) {
+		             json_vec.push_back( std::move( v ) );
+		             return true;
+	             },
+	             err,
+	             strategy );
+	return json_vec;
+}
 
-	JsonParser( const std::string_view &i_in,
-	            std::string &i_err,
-	            JsonParse i_strategy ) :
-	    str( i_in ),
-	    err( i_err ),
-	    strategy( i_strategy )
+/* * * * * * * * * * * * * * * * * * * *
+ * Files
+ */
+
+namespace details {
+
+/* JsonFile
+ *
+ * The content of a file, memory mapped when possible, read into a string
+ * otherwise. Like a std::string, it is always followed by a 0: the parser
+ * relies on it to stop at the end of a number.
+ */
+class JsonFile final
+{
+public:
+	JsonFile() = default;
+	JsonFile( const JsonFile & ) = delete;
+	JsonFile &operator=( const JsonFile & ) = delete;
+	~JsonFile()
 	{
-		it = str.begin();
-		collect_array_data.reserve( 64 );
-		collect_object_data.reserve( 64 );
+#if UPLATFORM_UNIX
+		if ( _mapped != nullptr )
+			munmap( _mapped, _mappedSize );
+#endif
 	}
 
-	Json fail( std::string &&msg ) { return fail( std::move( msg ), Json() ); }
-	template<typename T>
-	T fail( std::string &&msg, const T err_ret )
+	bool open( const filepath &i_path,
+	           bool i_sequential,
+	           bool i_prefetch,
+	           std::string &o_err );
+
+	std::string_view text() const { return _text; }
+
+private:
+	std::string_view _text;
+	void *_mapped = nullptr;
+	size_t _mappedSize = 0;
+	std::string _buffer;
+
+	bool read( const filepath &i_path, std::string &o_err );
+};
+
+bool JsonFile::open( const filepath &i_path,
+                     bool i_sequential,
+                     bool i_prefetch,
+                     std::string &o_err )
+{
+#if UPLATFORM_UNIX
+	int fd = ::open( i_path.ospath().c_str(), O_RDONLY | O_CLOEXEC );
+	if ( fd < 0 )
 	{
-		if ( not failed )
-			err = std::move( msg );
-		failed = true;
-		return err_ret;
+		o_err = "cannot open " + i_path.path() + ": " + strerror( errno );
+		return false;
 	}
-
-	/* get_next_token()
-	 *
-	 * Return the next non-whitespace character. If the end of the input is
-	 * reached, flag an error and return 0.
-	 */
-	char get_next_token()
+	struct stat st;
+	if ( fstat( fd, &st ) != 0 or not S_ISREG( st.st_mode ) or
+	     st.st_size == 0 )
 	{
-		consume_garbage();
-		if ( it == str.end() )
-			return fail( "unexpected end of input", 0 );
+		// pipes, devices and the like
+		::close( fd );
+		return read( i_path, o_err );
+	}
 
-		return *it++;
+	// a zero filled page after the file for the final 0, the file is
+	// mapped over the start of it
+	size_t size = static_cast<size_t>( st.st_size );
+	size_t page = static_cast<size_t>( sysconf( _SC_PAGESIZE ) );
+	_mappedSize = ( size / page + 1 ) * page;
+	_mapped = mmap( nullptr,
+	                _mappedSize,
+	                PROT_READ,
+	                MAP_PRIVATE | MAP_ANONYMOUS,
+	                -1,
+	                0 );
+	if ( _mapped == MAP_FAILED or
+	     mmap( _mapped, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0 ) ==
+	         MAP_FAILED )
+	{
+		if ( _mapped != MAP_FAILED )
+			munmap( _mapped, _mappedSize );
+		_mapped = nullptr;
+		::close( fd );
+		return read( i_path, o_err );
 	}
+	::close( fd );
+
+	if ( i_sequential )
+		madvise( _mapped, size, MADV_SEQUENTIAL );
+	// the kernel starts reading the whole file in the background
+	if ( i_prefetch )
+		madvise( _mapped, size, MADV_WILLNEED );
+	_text = std::string_view( static_cast<const char *>( _mapped ), size );
+	return true;
+#else
+	(void)i_sequential;
+	(void)i_prefetch;
+	return read( i_path, o_err );
+#endif
+}
 
-	/* consume_whitespace()
-	 *
-	 * Advance until the current character is non-whitespace.
-	 */
-	void consume_whitespace()
+bool JsonFile::read( const filepath &i_path, std::string &o_err )
+{
+	std::ifstream f;
+	i_path.fsopen( f );
+	if ( not f )
 	{
-		while ( it != str.end() and std::isspace( *it ) )
-			++it;
+		o_err = "cannot open " + i_path.path();
+		return false;
 	}
+	while ( f )
+	{
+		char buf[16 * 1024];
+		f.read( buf, sizeof( buf ) );
+		_buffer.append( buf, f.gcount() );
+	}
+	if ( f.bad() )
+	{
+		o_err = "cannot read " + i_path.path();
+		return false;
+	}
+	_text = _buffer;
+	return true;
+}
 
-	/* consume_comment()
-	 *
-	 * Advance comments (c-style inline and multiline).
-	 */
-	bool consume_comment()
+}
+
+Json Json::parse_file( const filepath &path,
+                       std::string &err,
+                       JsonParse strategy,
+                       bool prefetch )
+{
+	details::JsonFile file;
+	if ( not file.open( path, true, prefetch, err ) )
+		return Json();
+	return parse( file.text(), err, strategy );
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Lazy views
+ */
+
+namespace details {
+
+inline size_t view_skip_whitespace( const std::string_view &text, size_t pos )
+{
+	while ( pos < text.size() and is_json_space( text[pos] ) )
+		++pos;
+	return pos;
+}
+
+inline bool is_scalar_end( char c )
+{
+	return is_json_space( c ) or c == ',' or c == ':' or c == ']' or c == '}';
+}
+
+// position after the value starting at pos, npos if malformed
+size_t view_skip_value( const std::string_view &text, size_t pos )
+{
+	if ( pos >= text.size() )
+		return std::string_view::npos;
+
+	switch ( text[pos] )
 	{
-		bool comment_found = false;
-		if ( it != str.end() and *it == '/' )
-		{
-			it++;
-			if ( it == str.end() )
-				return fail( "unexpected end of input inside comment", false );
-			if ( *it == '/' )
-			{ // inline comment
-				it++;
-				if ( it == str.end() )
-					return fail(
-					    "unexpected end of input inside inline comment",
-					    false );
-				// advance until next line
-				while ( *it != '\n' )
-				{
-					it++;
-					if ( it == str.end() )
-						return fail(
-						    "unexpected end of input inside inline comment",
-						    false );
-				}
-				comment_found = true;
+		case '"':
+			for ( ++pos; pos < text.size(); ++pos )
+			{
+				if ( text[pos] == '"' )
+					return pos + 1;
+				if ( text[pos] == '\\' )
+					++pos;
 			}
-			else if ( *it == '*' )
-			{ // multiline comment
-				it++;
-				if ( it > str.end() - 2 )
-					return fail(
-					    "unexpected end of input inside multi-line comment",
-					    false );
-				// advance until closing tokens
-				while ( not ( *it == '*' and *( it + 1 ) == '/' ) )
+			return std::string_view::npos;
+
+		case '{':
+		case '[':
+		{
+			// only brackets matter, the structural index skips everything else
+			StructuralIndex index;
+			index.reset( text );
+			int depth = 0;
+			for ( ;; )
+			{
+				pos = index.next( pos );
+				if ( pos == text.size() )
+					return std::string_view::npos;
+				switch ( text[pos] )
 				{
-					it++;
-					if ( it > str.end() - 2 )
-						return fail(
-						    "unexpected end of input inside multi-line comment",
-						    false );
+					case '{':
+					case '[':
+						++depth;
+						break;
+					case '}':
+					case ']':
+						if ( --depth == 0 )
+							return pos + 1;
+						break;
+					default:
+						break;
 				}
-				it += 2;
-				if ( it == str.end() )
-					return fail(
-					    "unexpected end of input inside multi-line comment",
-					    false );
-				comment_found = true;
+				++pos;
 			}
-			else
-				return fail( "malformed comment", false );
 		}
-		return comment_found;
+
+		default:
+			while ( pos < text.size() and not is_scalar_end( text[pos] ) )
+				++pos;
+			return pos;
+	}
+}
+
+/* view_decode(text, pos, cb)
+ *
+ * Run the parser on the value at pos, with a copy of the text if needed so
+ * the parser can safely look one character past the value.
+ */
+template<typename CB>
+auto view_decode( const std::string_view &text, size_t pos, CB &&cb )
+{
+	auto end = view_skip_value( text, pos );
+	if ( end == std::string_view::npos )
+		end = text.size();
+	std::string_view value( text.data() + pos, end - pos );
+	std::string err;
+	if ( end < text.size() )
+	{
+		JsonParser parser( value, err, JsonParse::STANDARD );
+		return cb( parser );
 	}
+	std::string copy( value );
+	std::string_view terminated( copy.c_str(), copy.size() );
+	JsonParser parser( terminated, err, JsonParse::STANDARD );
+	return cb( parser );
+}
 
-	/* consume_garbage()
-	 *
-	 * Advance until the current character is non-whitespace and non-comment.
-	 */
-	void consume_garbage()
+Json view_number( const std::string_view &text, size_t pos )
+{
+	return view_decode( text, pos, []( JsonParser &parser ) {
+		auto result = parser.parse_number();
+		return parser.failed ? Json() : result;
+	} );
+}
+
+}
+
+Json::Type JsonView::type() const
+{
+	if ( _pos < _text.size() )
 	{
-		consume_whitespace();
-		if ( strategy == JsonParse::COMMENTS )
+		switch ( _text[_pos] )
 		{
-			bool comment_found = false;
-			do
-			{
-				comment_found = consume_comment();
-				consume_whitespace();
-			} while ( comment_found );
+			case '{':
+				return Json::Type::OBJECT;
+			case '[':
+				return Json::Type::ARRAY;
+			case '"':
+				return Json::Type::STRING;
+			case 't':
+			case 'f':
+				return Json::Type::BOOL;
+			case '-':
+			case '0':
+			case '1':
+			case '2':
+			case '3':
+			case '4':
+			case '5':
+			case '6':
+			case '7':
+			case '8':
+			case '9':
+				return Json::Type::NUMBER;
+			default:
+				break;
 		}
 	}
+	return Json::Type::NUL;
+}
 
-	/* encode_utf8(pt)
-	 *
-	 * Encode pt as UTF-8 and add it to the collect string.
-	 */
-	void encode_utf8( long pt )
+double JsonView::number_value() const
+{
+	return is_number() ? details::view_number( _text, _pos ).number_value() :
+	                     0;
+}
+
+int32_t JsonView::int_value() const
+{
+	return is_number() ? details::view_number( _text, _pos ).int_value() : 0;
+}
+
+int64_t JsonView::int64_value() const
+{
+	return is_number() ? details::view_number( _text, _pos ).int64_value() : 0;
+}
+
+bool JsonView::bool_value() const
+{
+	return is_bool() and _text.compare( _pos, 4, "true" ) == 0;
+}
+
+std::string JsonView::string_value() const
+{
+	std::string buffer;
+	auto result = string_value( buffer );
+	if ( result.data() != buffer.data() )
+		buffer.assign( result );
+	return buffer;
+}
+
+std::string_view JsonView::string_value( std::string &io_buffer ) const
+{
+	if ( not is_string() )
+		return {};
+
+	auto end = details::view_skip_value( _text, _pos );
+	if ( end == std::string_view::npos )
+		return {};
+	auto raw = _text.substr( _pos + 1, end - _pos - 2 );
+	if ( raw.find( '\\' ) == std::string_view::npos )
+		return raw;
+
+	return details::view_decode(
+	    _text, _pos, [&io_buffer]( details::JsonParser &parser ) {
+		    ++parser.it;
+		    parser.parse_string();
+		    if ( parser.failed )
+			    return std::string_view();
+		    io_buffer.assign( parser.collect_string.begin(),
+		                      parser.collect_string.end() );
+		    return std::string_view( io_buffer );
+	    } );
+}
+
+JsonView JsonView::operator[]( size_t i ) const
+{
+	JsonView result;
+	size_t n = 0;
+	for_each_item( [&]( const JsonView &item ) {
+		if ( n++ != i )
+			return true;
+		result = item;
+		return false;
+	} );
+	return result;
+}
+
+JsonView JsonView::operator[]( const std::string_view &key ) const
+{
+	JsonView result;
+	for_each_member( [&]( const std::string_view &k, const JsonView &value ) {
+		if ( k != key )
+			return true;
+		result = value;
+		return false;
+	} );
+	return result;
+}
+
+size_t JsonView::size() const
+{
+	size_t n = 0;
+	if ( is_array() )
 	{
-		if ( pt < 0 )
+		for_each_item( [&n]( const JsonView & ) {
+			++n;
+			return true;
+		} );
+	}
+	else if ( is_object() )
+	{
+		for_each_member( [&n]( const std::string_view &, const JsonView & ) {
+			++n;
+			return true;
+		} );
+	}
+	return n;
+}
+
+void JsonView::for_each_item(
+    const std::function<bool( const JsonView & )> &i_cb ) const
+{
+	if ( not is_array() )
+		return;
+
+	auto pos = details::view_skip_whitespace( _text, _pos + 1 );
+	if ( pos < _text.size() and _text[pos] == ']' )
+		return;
+	// one view for all the items, the owner is shared once
+	JsonView item( _text, pos, _owner );
+	while ( pos < _text.size() )
+	{
+		auto end = details::view_skip_value( _text, pos );
+		if ( end == std::string_view::npos )
+			return;
+		item._pos = pos;
+		if ( not i_cb( item ) )
 			return;
+		pos = details::view_skip_whitespace( _text, end );
+		if ( pos >= _text.size() or _text[pos] != ',' )
+			return;
+		pos = details::view_skip_whitespace( _text, pos + 1 );
+	}
+}
 
-		if ( pt < 0x80 )
-		{
-			collect_string.push_back( static_cast<char>( pt ) );
-		}
-		else if ( pt < 0x800 )
-		{
-			collect_string.push_back( static_cast<char>( ( pt >> 6 ) | 0xC0 ) );
-			collect_string.push_back(
-			    static_cast<char>( ( pt & 0x3F ) | 0x80 ) );
-		}
-		else if ( pt < 0x10000 )
-		{
-			collect_string.push_back(
-			    static_cast<char>( ( pt >> 12 ) | 0xE0 ) );
-			collect_string.push_back(
-			    static_cast<char>( ( ( pt >> 6 ) & 0x3F ) | 0x80 ) );
-			collect_string.push_back(
-			    static_cast<char>( ( pt & 0x3F ) | 0x80 ) );
-		}
-		else
-		{
-			collect_string.push_back(
-			    static_cast<char>( ( pt >> 18 ) | 0xF0 ) );
-			collect_string.push_back(
-			    static_cast<char>( ( ( pt >> 12 ) & 0x3F ) | 0x80 ) );
-			collect_string.push_back(
-			    static_cast<char>( ( ( pt >> 6 ) & 0x3F ) | 0x80 ) );
-			collect_string.push_back(
-			    static_cast<char>( ( pt & 0x3F ) | 0x80 ) );
-		}
+void JsonView::for_each_member(
+    const std::function<bool( const std::string_view &, const JsonView & )>
+        &i_cb ) const
+{
+	if ( not is_object() )
+		return;
+
+	std::string buffer;
+	auto pos = details::view_skip_whitespace( _text, _pos + 1 );
+	JsonView item( _text, pos, _owner );
+	while ( pos < _text.size() and _text[pos] == '"' )
+	{
+		item._pos = pos;
+		auto key = item.string_value( buffer );
+		pos = details::view_skip_value( _text, pos );
+		if ( pos == std::string_view::npos )
+			return;
+		pos = details::view_skip_whitespace( _text, pos );
+		if ( pos >= _text.size() or _text[pos] != ':' )
+			return;
+		pos = details::view_skip_whitespace( _text, pos + 1 );
+		auto end = details::view_skip_value( _text, pos );
+		if ( end == std::string_view::npos )
+			return;
+		item._pos = pos;
+		if ( not i_cb( key, item ) )
+			return;
+		pos = details::view_skip_whitespace( _text, end );
+		if ( pos >= _text.size() or _text[pos] != ',' )
+			return;
+		pos = details::view_skip_whitespace( _text, pos + 1 );
 	}
+}
 
-	/* parse_string()
-	 *
-	 * Parse a string, starting at the current position.
-	 */
-	void parse_string()
+std::string_view JsonView::raw() const
+{
+	auto end = details::view_skip_value( _text, _pos );
+	if ( end == std::string_view::npos )
+		return {};
+	return _text.substr( _pos, end - _pos );
+}
+
+Json JsonView::to_json() const
+{
+	std::string err;
+	return Json::parse( raw(), err );
+}
+
+JsonView JsonDocumentView::root() const
+{
+	return JsonView(
+	    _text, details::view_skip_whitespace( _text, 0 ), _owner );
+}
+
+JsonDocumentView::JsonDocumentView( const filepath &i_path,
+                                    std::string &o_err,
+                                    bool i_prefetch )
+{
+	auto file = std::make_shared<details::JsonFile>();
+	if ( file->open( i_path, false, i_prefetch, o_err ) )
 	{
-		collect_string.clear();
+		_text = file->text();
+		_owner = std::move( file );
+	}
+}
 
-		// pre-compute size
-		size_t extra = 0;
-		for ( auto c = it; c != str.end() and *c != '"'; ++c )
-			++extra;
-		if ( collect_string.capacity() < extra )
-			collect_string.reserve( extra );
+/* * * * * * * * * * * * * * * * * * * *
+ * Event driven reader
+ */
 
-		long last_escaped_codepoint = -1;
-		for ( ;; )
-		{
-			if ( it == str.end() )
-			{
-				fail( "unexpected end of input in string" );
-				return;
-			}
+json_reader::json_reader( JsonParse i_strategy, bool i_multiple ) :
+    _strategy( i_strategy ),
+    _multiple( i_multiple )
+{
+}
 
-			char ch = *it++;
+bool json_reader::start_object()
+{
+	return true;
+}
+bool json_reader::key( const std::string_view & )
+{
+	return true;
+}
+bool json_reader::end_object()
+{
+	return true;
+}
+bool json_reader::start_array()
+{
+	return true;
+}
+bool json_reader::end_array()
+{
+	return true;
+}
+bool json_reader::string( const std::string_view & )
+{
+	return true;
+}
+bool json_reader::number( const Json & )
+{
+	return true;
+}
+bool json_reader::boolean( bool )
+{
+	return true;
+}
+bool json_reader::null()
+{
+	return true;
+}
 
-			if ( ch == '"' )
-			{
-				encode_utf8( last_escaped_codepoint );
-				return;
-			}
+void json_reader::reset()
+{
+	_state = State::VALUE;
+	_token = Token::NONE;
+	_isKey = _escape = _hasEscapes = _stopped = false;
+	_buffer.clear();
+	_stack.clear();
+	_error.clear();
+}
 
-			if ( in_range( ch, 0, 0x1f ) )
-			{
-				fail( "unescaped " + esc( ch ) + " in string" );
-				return;
-			}
+bool json_reader::parse( std::istream &i_stream )
+{
+	reset();
+	std::unique_ptr<char[]> buf( new char[64 * 1024] );
+	while ( i_stream )
+	{
+		i_stream.read( buf.get(), 64 * 1024 );
+		if ( not feed( std::string_view( buf.get(), i_stream.gcount() ) ) )
+			return false;
+	}
+	return finish();
+}
 
-			// The usual case: non-escaped characters
-			if ( ch != '\\' )
-			{
-				encode_utf8( last_escaped_codepoint );
-				last_escaped_codepoint = -1;
-				collect_string.push_back( ch );
+bool json_reader::fail( std::string &&i_msg )
+{
+	if ( _error.empty() )
+		_error = std::move( i_msg );
+	_stopped = true;
+	return false;
+}
+
+bool json_reader::stop( bool i_continue )
+{
+	if ( not i_continue )
+		_stopped = true;
+	return i_continue;
+}
+
+bool json_reader::feed( const std::string_view &i_chunk )
+{
+	if ( _stopped )
+		return false;
+
+	const char *p = i_chunk.data();
+	const char *end = p + i_chunk.size();
+	while ( p != end )
+	{
+		// continue the token in progress
+		switch ( _token )
+		{
+			case Token::NONE:
+				break;
+			case Token::STRING:
+				if ( not string_chars( p, end ) )
+					return false;
 				continue;
-			}
+			case Token::NUMBER:
+				while ( p != end and ( ( *p >= '0' and *p <= '9' ) or
+				                       *p == '.' or *p == 'e' or
+				                       *p == 'E' or *p == '+' or *p == '-' ) )
+					_buffer.push_back( *p++ );
+				if ( p == end )
+					return true;
+				if ( not end_number() )
+					return false;
+				break;
+			case Token::LITERAL:
+				while ( p != end and *p >= 'a' and *p <= 'z' )
+					_buffer.push_back( *p++ );
+				if ( p == end )
+					return true;
+				if ( not end_literal() )
+					return false;
+				break;
+			case Token::COMMENT_START:
+				if ( *p == '/' )
+					_token = Token::LINE_COMMENT;
+				else if ( *p == '*' )
+					_token = Token::BLOCK_COMMENT;
+				else
+					return fail( "malformed comment" );
+				++p;
+				continue;
+			case Token::LINE_COMMENT:
+				while ( p != end and *p != '\n' )
+					++p;
+				if ( p != end )
+					_token = Token::NONE;
+				continue;
+			case Token::BLOCK_COMMENT:
+			case Token::BLOCK_COMMENT_STAR:
+				for ( ; p != end; ++p )
+				{
+					if ( _token == Token::BLOCK_COMMENT_STAR and *p == '/' )
+					{
+						_token = Token::NONE;
+						++p;
+						break;
+					}
+					_token = *p == '*' ? Token::BLOCK_COMMENT_STAR :
+					                     Token::BLOCK_COMMENT;
+				}
+				continue;
+		}
+		if ( p == end )
+			break;
 
-			// Handle escapes
-			if ( it == str.end() )
-			{
-				fail( "unexpected end of input in string" );
-				return;
-			}
+		char ch = *p++;
+		if ( std::isspace( ch ) )
+			continue;
+		if ( ch == '/' and _strategy == JsonParse::COMMENTS )
+		{
+			_token = Token::COMMENT_START;
+			continue;
+		}
 
-			ch = *it++;
+		switch ( _state )
+		{
+			case State::VALUE:
+				if ( not value( ch, p, end ) )
+					return false;
+				break;
 
-			if ( ch == 'u' )
-			{
-				// Extract 4-byte escape sequence
-				auto esc = str.substr( it - str.begin(), 4 );
-				// Explicitly check length of the substring. The following loop
-				// relies on std::string returning the terminating NUL when
-				// accessing str[length]. Checking here reduces brittleness.
-				if ( esc.length() < 4 )
+			case State::FIRST_VALUE:
+				if ( ch == ']' )
+				{
+					_stack.pop_back();
+					if ( not stop( end_array() ) or not end_value() )
+						return false;
+				}
+				else if ( not value( ch, p, end ) )
+					return false;
+				break;
+
+			case State::FIRST_KEY:
+			case State::KEY:
+				if ( ch == '}' and _state == State::FIRST_KEY )
+				{
+					_stack.pop_back();
+					if ( not stop( end_object() ) or not end_value() )
+						return false;
+				}
+				else if ( ch == '"' )
+				{
+					_isKey = true;
+					_token = Token::STRING;
+					_buffer.clear();
+					_hasEscapes = false;
+					if ( not string_chars( p, end ) )
+						return false;
+				}
+				else
+					return fail( "expected '\"' in object, got " +
+					             details::esc( ch ) );
+				break;
+
+			case State::COLON:
+				if ( ch != ':' )
+					return fail( "expected ':' in object, got " +
+					             details::esc( ch ) );
+				_state = State::VALUE;
+				break;
+
+			case State::AFTER_VALUE:
+				if ( _stack.empty() )
 				{
-					fail( "bad \\u escape: " + std::string( esc ) );
-					return;
+					if ( not _multiple )
+						return fail( "unexpected trailing" );
+					if ( not value( ch, p, end ) )
+						return false;
 				}
-				for ( int j = 0; j < 4; j++ )
+				else if ( _stack.back() == '{' )
 				{
-					if ( not in_range( esc[j], 'a', 'f' ) and
-					     not in_range( esc[j], 'A', 'F' ) and
-					     not in_range( esc[j], '0', '9' ) )
+					if ( ch == ',' )
+						_state = State::KEY;
+					else if ( ch == '}' )
 					{
-						fail( "bad \\u escape: " + std::string( esc ) );
-						return;
+						_stack.pop_back();
+						if ( not stop( end_object() ) or not end_value() )
+							return false;
 					}
-				}
-
-				long codepoint = hexstrtol( esc );
-
-				// JSON specifies that characters outside the BMP shall be
-				// encoded as a pair of 4-hex-digit \u escapes encoding their
-				// surrogate pair components. Check whether we're in the middle
-				// of such a beast: the previous codepoint was an escaped lead
-				// (high) surrogate, and this is a trail (low) surrogate.
-				if ( in_range( last_escaped_codepoint, 0xD800, 0xDBFF ) and
-				     in_range( codepoint, 0xDC00, 0xDFFF ) )
-				{
-					// Reassemble the two surrogate pairs into one astral-plane
-					// character, per the UTF-16 algorithm.
-					encode_utf8(
-					    ( ( ( last_escaped_codepoint - 0xD800 ) << 10 ) |
-					      ( codepoint - 0xDC00 ) ) +
-					    0x10000 );
-					last_escaped_codepoint = -1;
+					else
+						return fail( "expected ',' in object, got " +
+						             details::esc( ch ) );
 				}
 				else
 				{
-					encode_utf8( last_escaped_codepoint );
-					last_escaped_codepoint = codepoint;
+					if ( ch == ',' )
+						_state = State::VALUE;
+					else if ( ch == ']' )
+					{
+						_stack.pop_back();
+						if ( not stop( end_array() ) or not end_value() )
+							return false;
+					}
+					else
+						return fail( "expected ',' in list, got " +
+						             details::esc( ch ) );
 				}
+				break;
+		}
+	}
+	return true;
+}
 
-				it += 4;
-				continue;
-			}
+bool json_reader::finish()
+{
+	if ( _stopped )
+		return false;
 
-			encode_utf8( last_escaped_codepoint );
-			last_escaped_codepoint = -1;
+	switch ( _token )
+	{
+		case Token::NONE:
+			break;
+		case Token::STRING:
+			return fail( "unexpected end of input in string" );
+		case Token::NUMBER:
+			if ( not end_number() )
+				return false;
+			break;
+		case Token::LITERAL:
+			if ( not end_literal() )
+				return false;
+			break;
+		case Token::COMMENT_START:
+			return fail( "unexpected end of input inside comment" );
+		case Token::LINE_COMMENT:
+			return fail( "unexpected end of input inside inline comment" );
+		case Token::BLOCK_COMMENT:
+		case Token::BLOCK_COMMENT_STAR:
+			return fail( "unexpected end of input inside multi-line comment" );
+	}
 
-			if ( ch == 'b' )
-				collect_string.push_back( '\b' );
-			else if ( ch == 'f' )
-				collect_string.push_back( '\f' );
-			else if ( ch == 'n' )
-				collect_string.push_back( '\n' );
-			else if ( ch == 'r' )
-				collect_string.push_back( '\r' );
-			else if ( ch == 't' )
-				collect_string.push_back( '\t' );
-			else if ( ch == '"' or ch == '\\' or ch == '/' )
-				collect_string.push_back( ch );
-			else
+	if ( _stack.empty() and
+	     ( _state == State::AFTER_VALUE or
+	       ( _multiple and _state == State::VALUE ) ) )
+		return true;
+	return fail( "unexpected end of input" );
+}
+
+bool json_reader::value( char ch, const char *&io_p, const char *i_end )
+{
+	switch ( ch )
+	{
+		case '"':
+			_isKey = false;
+			_token = Token::STRING;
+			_buffer.clear();
+			_hasEscapes = false;
+			return string_chars( io_p, i_end );
+
+		case '{':
+			if ( _stack.size() >= size_t( details::max_depth ) )
+				return fail( "exceeded maximum nesting depth" );
+			_stack.push_back( '{' );
+			_state = State::FIRST_KEY;
+			return stop( start_object() );
+
+		case '[':
+			if ( _stack.size() >= size_t( details::max_depth ) )
+				return fail( "exceeded maximum nesting depth" );
+			_stack.push_back( '[' );
+			_state = State::FIRST_VALUE;
+			return stop( start_array() );
+
+		case 't':
+		case 'f':
+		case 'n':
+			_token = Token::LITERAL;
+			_buffer.assign( 1, ch );
+			return true;
+
+		default:
+			if ( ch == '-' or ( ch >= '0' and ch <= '9' ) )
 			{
-				fail( "invalid escape character " + esc( ch ) );
-				return;
+				_token = Token::NUMBER;
+				_buffer.assign( 1, ch );
+				return true;
 			}
-		}
+			return fail( "expected value, got " + details::esc( ch ) );
 	}
+}
 
-	/* parse_number()
-	 *
-	 * Parse a double.
-	 */
-	Json parse_number()
+/* string_chars(p, end)
+ *
+ * Consume the characters of the string in progress. A string that starts and
+ * ends in the same chunk without escapes is not copied.
+ */
+bool json_reader::string_chars( const char *&io_p, const char *i_end )
+{
+	auto start = io_p;
+	for ( ; io_p != i_end; ++io_p )
 	{
-		// Parse minus
-		bool minus = false;
-		if ( *it == '-' )
-		{
-			minus = true;
-			++it;
-		}
-
-		collect_string.clear();
-
-		// Parse int: zero / ( digit1-9 *DIGIT )
-		unsigned i = 0;
-		uint64_t i64 = 0;
-		bool use64bit = false;
-		int significandDigit = 0;
-		if ( RAPIDJSON_UNLIKELY( *it == '0' ) )
+		auto ch = *io_p;
+		if ( _escape )
 		{
-			i = 0;
-			collect_string.push_back( *it );
-			++it;
+			_escape = false;
+			continue;
 		}
-		else if ( RAPIDJSON_LIKELY( *it >= '1' and *it <= '9' ) )
+		if ( ch == '"' )
 		{
-			i = static_cast<unsigned>( *it - '0' );
-			collect_string.push_back( *it );
-			++it;
-
-			if ( minus )
+			bool result;
+			if ( _buffer.empty() and not _hasEscapes )
 			{
-				while ( RAPIDJSON_LIKELY( *it >= '0' and *it <= '9' ) )
-				{
-					if ( RAPIDJSON_UNLIKELY( i >= 214748364 ) )
-					{ // 2^31 = 2147483648
-						if ( RAPIDJSON_LIKELY( i != 214748364 or *it > '8' ) )
-						{
-							i64 = i;
-							use64bit = true;
-							break;
-						}
-					}
-					i = i * 10 + static_cast<unsigned>( *it - '0' );
-					collect_string.push_back( *it );
-					++it;
-					significandDigit++;
-				}
+				_token = Token::NONE;
+				std::string_view value( start, io_p - start );
+				result = stop( _isKey ? key( value ) : string( value ) ) and
+				         end_value();
 			}
 			else
 			{
-				while ( RAPIDJSON_LIKELY( *it >= '0' and *it <= '9' ) )
-				{
-					if ( RAPIDJSON_UNLIKELY( i >= 214748364 ) )
-					{ // 2^32 - 1 = 4294967295
-						if ( RAPIDJSON_LIKELY( i != 214748364 or *it > '8' ) )
-						{
-							i64 = i;
-							use64bit = true;
-							break;
-						}
-					}
-					i = i * 10 + static_cast<unsigned>( *it - '0' );
-					collect_string.push_back( *it );
-					++it;
-					significandDigit++;
-				}
+				_buffer.append( start, io_p );
+				result = end_string();
 			}
+			++io_p;
+			return result;
 		}
-		else
-			fail( "invalid number" );
-
-		// Parse 64bit int
-		bool useDouble = false;
-		double d = 0.0;
-		if ( use64bit )
+		if ( ch == '\\' )
 		{
-			if ( minus )
-			{
-				while ( RAPIDJSON_LIKELY( *it >= '0' and *it <= '9' ) )
-				{
-					if ( RAPIDJSON_UNLIKELY(
-					         i64 >=
-					         RAPIDJSON_UINT64_C2(
-					             0x0CCCCCCC,
-					             0xCCCCCCCC ) ) ) // 2^63 = 9223372036854775808
-						if ( RAPIDJSON_LIKELY(
-						         i64 != RAPIDJSON_UINT64_C2( 0x0CCCCCCC,
-						                                     0xCCCCCCCC ) or
-						         *it > '8' ) )
-						{
-							d = static_cast<double>( i64 );
-							useDouble = true;
-							break;
-						}
-					i64 = i64 * 10 + static_cast<unsigned>( *it - '0' );
-					collect_string.push_back( *it );
-					++it;
-					significandDigit++;
-				}
-			}
-			else
-			{
-				while ( RAPIDJSON_LIKELY( *it >= '0' and *it <= '9' ) )
-				{
-					if ( RAPIDJSON_UNLIKELY(
-					         i64 >= RAPIDJSON_UINT64_C2(
-					                    0x19999999,
-					                    0x99999999 ) ) ) // 2^64 - 1 =
-					                                     // 18446744073709551615
-						if ( RAPIDJSON_LIKELY(
-						         i64 != RAPIDJSON_UINT64_C2( 0x19999999,
-						                                     0x99999999 ) or
-						         *it > '5' ) )
-						{
-							d = static_cast<double>( i64 );
-							useDouble = true;
-							break;
-						}
-					i64 = i64 * 10 + static_cast<unsigned>( *it - '0' );
-					collect_string.push_back( *it );
-					++it;
-					significandDigit++;
-				}
-			}
+			_escape = true;
+			_hasEscapes = true;
 		}
+		else if ( details::in_range( ch, 0, 0x1f ) )
+			return fail( "unescaped " + details::esc( ch ) + " in string" );
+	}
+	_buffer.append( start, io_p );
+	return true;
+}
 
-		// Force double for big integer
-		if ( useDouble )
-		{
-			while ( RAPIDJSON_LIKELY( *it >= '0' and *it <= '9' ) )
-			{
-				if ( RAPIDJSON_UNLIKELY(
-				         d >= 1.7976931348623157e307 ) ) // DBL_MAX / 10.0
-					fail( "number is too big" );
-				d = d * 10 + ( *it - '0' );
-				collect_string.push_back( *it );
-				++it;
-			}
-		}
+bool json_reader::end_string()
+{
+	_token = Token::NONE;
+
+	// let the parser handle the escapes
+	_buffer.push_back( '"' );
+	std::string_view value( _buffer.data(), _buffer.size() - 1 );
+	std::string_view quoted( _buffer );
+	std::string err;
+	details::JsonParser parser( quoted, err, JsonParse::STANDARD );
+	if ( _hasEscapes )
+	{
+		parser.parse_string();
+		if ( parser.failed )
+			return fail( std::move( err ) );
+		value = std::string_view( parser.collect_string.begin(),
+		                          parser.collect_string.size() );
+	}
+	return stop( _isKey ? key( value ) : string( value ) ) and end_value();
+}
 
-		// Parse frac = decimal-point 1*DIGIT
-		int expFrac = 0;
-		size_t decimalPosition;
-		if ( *it == '.' )
-		{
-			++it;
-			decimalPosition = collect_string.size();
+bool json_reader::end_number()
+{
+	_token = Token::NONE;
+	std::string err;
+	std::string_view token( _buffer ); // std::string is null terminated
+	details::JsonParser parser( token, err, JsonParse::STANDARD );
+	auto value = parser.parse_number();
+	if ( parser.failed )
+		return fail( std::move( err ) );
+	if ( parser.it != token.end() )
+		return fail( "invalid number" );
+	return stop( number( value ) ) and end_value();
+}
 
-			if ( RAPIDJSON_UNLIKELY( not( *it >= '0' and *it <= '9' ) ) )
-				fail( "missing fraction for number" );
+bool json_reader::end_literal()
+{
+	_token = Token::NONE;
+	bool result;
+	if ( _buffer == "true" )
+		result = stop( boolean( true ) );
+	else if ( _buffer == "false" )
+		result = stop( boolean( false ) );
+	else if ( _buffer == "null" )
+		result = stop( null() );
+	else
+	{
+		std::string_view expected = _buffer[0] == 't' ?
+		                                "true" :
+		                                ( _buffer[0] == 'f' ? "false" : "null" );
+		return fail( "parse error: expected " + std::string( expected ) +
+		             ", got " + _buffer );
+	}
+	return result and end_value();
+}
 
-			if ( not useDouble )
-			{
-#if RAPIDJSON_64BIT
-				// Use i64 to store significand in 64-bit architecture
-				if ( not use64bit )
-					i64 = i;
+bool json_reader::end_value()
+{
+	if ( _stopped )
+		return false;
+	if ( _isKey )
+	{
+		_isKey = false;
+		_state = State::COLON;
+	}
+	else
+		_state = State::AFTER_VALUE;
+	return true;
+}
 
-				while ( RAPIDJSON_LIKELY( *it >= '0' and *it <= '9' ) )
-				{
-					if ( i64 >
-					     RAPIDJSON_UINT64_C2(
-					         0x1FFFFF, 0xFFFFFFFF ) ) // 2^53 - 1 for fast path
-						break;
-					else
-					{
-						i64 = i64 * 10 + static_cast<unsigned>( *it - '0' );
-						collect_string.push_back( *it );
-						++it;
-						--expFrac;
-						if ( i64 != 0 )
-							significandDigit++;
-					}
-				}
+/* * * * * * * * * * * * * * * * * * * *
+ * Push parser
+ */
 
-				d = static_cast<double>( i64 );
-#else
-				// Use double to store significand in 32-bit architecture
-				d = static_cast<double>( use64bit ? i64 : i );
-#endif
-				useDouble = true;
-			}
+JsonPushParser::JsonPushParser( JsonParse i_strategy, bool i_multiple ) :
+    json_reader( i_strategy, i_multiple )
+{
+}
 
-			while ( RAPIDJSON_LIKELY( *it >= '0' and *it <= '9' ) )
-			{
-				if ( significandDigit < 17 )
-				{
-					d = d * 10.0 + ( *it - '0' );
-					collect_string.push_back( *it );
-					++it;
-					--expFrac;
-					if ( RAPIDJSON_LIKELY( d > 0.0 ) )
-						significandDigit++;
-				}
-				else
-				{
-					collect_string.push_back( *it );
-					++it;
-				}
-			}
-		}
-		else
-			decimalPosition =
-			    collect_string
-			        .size(); // decimal position at the end of integer.
+void JsonPushParser::reset()
+{
+	json_reader::reset();
+	_frames.clear();
+	_arrayData.clear();
+	_objectData.clear();
+	_values.clear();
+}
 
-		// Parse exp = e [ minus / plus ] 1*DIGIT
-		int exp = 0;
-		if ( *it == 'e' or *it == 'E' )
-		{
-			if ( not useDouble )
-			{
-				d = static_cast<double>( use64bit ? i64 : i );
-				useDouble = true;
-			}
-			++it;
+Json JsonPushParser::next_value()
+{
+	if ( _values.empty() )
+		return Json();
+	Json result( std::move( _values.front() ) );
+	_values.pop_front();
+	return result;
+}
 
-			bool expMinus = false;
-			if ( *it == '+' )
-				++it;
-			else if ( *it == '-' )
-			{
-				++it;
-				expMinus = true;
-			}
+bool JsonPushParser::add( Json &&i_value )
+{
+	if ( _frames.empty() )
+		_values.push_back( std::move( i_value ) );
+	else if ( _frames.back().object )
+		_objectData.back().second = std::move( i_value );
+	else
+		_arrayData.push_back( std::move( i_value ) );
+	return true;
+}
 
-			if ( RAPIDJSON_LIKELY( *it >= '0' and *it <= '9' ) )
-			{
-				exp = static_cast<int>( *it - '0' );
-				++it;
-				if ( expMinus )
-				{
-					while ( RAPIDJSON_LIKELY( *it >= '0' and *it <= '9' ) )
-					{
-						exp = exp * 10 + static_cast<int>( *it - '0' );
-						++it;
-						if ( exp >= 214748364 )
-						{ // Issue #313: prevent overflow exponent
-							while ( RAPIDJSON_UNLIKELY(
-							    *it >= '0' and
-							    *it <= '9' ) ) // Consume the rest of exponent
-								++it;
-						}
-					}
-				}
-				else
-				{ // positive exp
-					int maxExp = 308 - expFrac;
-					while ( RAPIDJSON_LIKELY( *it >= '0' and *it <= '9' ) )
-					{
-						exp = exp * 10 + static_cast<int>( *it - '0' );
-						++it;
-						if ( RAPIDJSON_UNLIKELY( exp > maxExp ) )
-							fail( "number is too big" );
-					}
-				}
-			}
-			else
-				fail( "missing exponent for number" );
+bool JsonPushParser::start_object()
+{
+	_frames.push_back( { true, _objectData.size() } );
+	return true;
+}
 
-			if ( expMinus )
-				exp = -exp;
-		}
+bool JsonPushParser::key( const std::string_view &i_key )
+{
+	_objectData.emplace_back( std::string( i_key ), Json() );
+	return true;
+}
 
-		// Finish parsing, handle according to the type of number.
-		size_t length = collect_string.size();
-		const char *decimal =
-		    collect_string
-		        .c_str(); // Pop stack no matter if it will be used or not.
+bool JsonPushParser::end_object()
+{
+	auto start = _frames.back().start;
+	_frames.pop_back();
+	return add( details::make_object_data( _objectData, start ) );
+}
 
-		if ( useDouble )
-		{
-			int p = exp + expFrac;
-			d = StrtodFullPrecision(
-			    d, p, decimal, length, decimalPosition, exp );
+bool JsonPushParser::start_array()
+{
+	_frames.push_back( { false, _arrayData.size() } );
+	return true;
+}
+
+bool JsonPushParser::end_array()
+{
+	auto start = _frames.back().start;
+	_frames.pop_back();
+	Json::array items( std::make_move_iterator( _arrayData.begin() + start ),
+	                   std::make_move_iterator( _arrayData.end() ) );
+	_arrayData.resize( start );
+	return add( std::move( items ) );
+}
+
+bool JsonPushParser::string( const std::string_view &i_value )
+{
+	return add( Json( i_value ) );
+}
+
+bool JsonPushParser::number( const Json &i_value )
+{
+	return add( Json( i_value ) );
+}
+
+bool JsonPushParser::boolean( bool i_value )
+{
+	return add( i_value );
+}
+
+bool JsonPushParser::null()
+{
+	return add( nullptr );
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Tokenizer
+ */
+
+JsonTokenizer::JsonTokenizer( const std::string_view &i_text,
+                              JsonParse i_strategy ) :
+    _text( i_text ),
+    _parser( std::make_unique<details::JsonParser>( _text, _error, i_strategy ) )
+{
+}
+
+JsonTokenizer::~JsonTokenizer() = default;
+
+bool JsonTokenizer::fail( std::string &&i_msg )
+{
+	return _parser->fail( std::move( i_msg ), false );
+}
 
-			return ( minus ? -d : d );
-		}
-		else
-		{
-			if ( use64bit )
-			{
-				if ( minus )
-					return static_cast<int64_t>( ~i64 + 1 );
-				else
-					return static_cast<int64_t>( i64 );
-			}
-			else
-			{
-				if ( minus )
-					return static_cast<int>( ~i + 1 );
-				else
-					return static_cast<int>( i );
-			}
-		}
-	}
+bool JsonTokenizer::failed() const
+{
+	return _parser->failed;
+}
 
-	/* expect(str, res)
-	 *
-	 * Expect that 'str' starts at the character that was just read. If it does,
-	 * advance the input and return res. If not, flag an error.
-	 */
-	Json expect( const std::string_view &expected, Json res )
+Json::Type JsonTokenizer::peek()
+{
+	if ( _parser->failed )
+		return Json::Type::NUL;
+	_parser->consume_garbage();
+	if ( _parser->it == _text.end() )
+		return Json::Type::NUL;
+	switch ( *_parser->it )
 	{
-		assert( it != str.begin() );
-		--it;
-		auto tmp = str.substr( it - str.begin(), expected.length() );
-		if ( tmp == expected )
-		{
-			it += expected.length();
-			return res;
-		}
-		else
-		{
-			return fail( "parse error: expected " + std::string( expected ) +
-			             ", got " + std::string( tmp ) );
-		}
+		case '{':
+			return Json::Type::OBJECT;
+		case '[':
+			return Json::Type::ARRAY;
+		case '"':
+			return Json::Type::STRING;
+		case 't':
+		case 'f':
+			return Json::Type::BOOL;
+		case 'n':
+			return Json::Type::NUL;
+		default:
+			return Json::Type::NUMBER;
 	}
+}
 
-	void parse_json( int depth, Json &output )
-	{
-		if ( depth > max_depth )
-		{
-			output = fail( "exceeded maximum nesting depth" );
-			return;
-		}
-
-		char ch = get_next_token();
-		if ( failed )
-			return;
+bool JsonTokenizer::read_null()
+{
+	auto ch = _parser->get_next_token();
+	if ( _parser->failed )
+		return false;
+	if ( ch != 'n' )
+		return fail( "expected null, got " + details::esc( ch ) );
+	_parser->expect( "null", Json() );
+	return not _parser->failed;
+}
 
-		if ( ch == '-' or ( ch >= '0' and ch <= '9' ) )
-		{
-			it--;
-			output = parse_number();
-			return;
-		}
+bool JsonTokenizer::read_bool( bool &o_value )
+{
+	auto ch = _parser->get_next_token();
+	if ( _parser->failed )
+		return false;
+	if ( ch == 't' )
+		o_value = _parser->expect( "true", true ).bool_value();
+	else if ( ch == 'f' )
+		o_value = _parser->expect( "false", false ).bool_value();
+	else
+		return fail( "expected bool, got " + details::esc( ch ) );
+	return not _parser->failed;
+}
 
-		if ( ch == 't' )
-		{
-			output = expect( "true", true );
-			return;
-		}
+bool JsonTokenizer::read_number( Json &o_value )
+{
+	std::string_view text;
+	return read_number( o_value, text );
+}
 
-		if ( ch == 'f' )
-		{
-			output = expect( "false", false );
-			return;
-		}
+bool JsonTokenizer::read_number( Json &o_value, std::string_view &o_text )
+{
+	auto ch = _parser->get_next_token();
+	if ( _parser->failed )
+		return false;
+	if ( ch != '-' and ( ch < '0' or ch > '9' ) )
+		return fail( "expected number, got " + details::esc( ch ) );
+	--_parser->it;
+	auto start = _parser->it;
+	o_value = _parser->parse_number();
+	o_text = std::string_view( &*start, _parser->it - start );
+	return not _parser->failed;
+}
 
-		if ( ch == 'n' )
-		{
-			output = expect( "null", Json() );
-			return;
-		}
+bool JsonTokenizer::read_string( std::string_view &o_value )
+{
+	auto ch = _parser->get_next_token();
+	if ( _parser->failed )
+		return false;
+	if ( ch != '"' )
+		return fail( "expected string, got " + details::esc( ch ) );
+	_parser->parse_string();
+	auto &collected = _parser->collect_string;
+	o_value = std::string_view( collected.begin(), collected.size() );
+	return not _parser->failed;
+}
 
-		if ( ch == '"' )
-		{
-			parse_string();
-			output =
-			    std::string( collect_string.begin(), collect_string.end() );
-			return;
-		}
+bool JsonTokenizer::read_value( Json &o_value )
+{
+	_parser->parse_json( _depth, o_value );
+	return not _parser->failed;
+}
 
-		if ( ch == '{' )
-		{
-			ch = get_next_token();
-			if ( ch == '}' )
-			{
-				output = flat_map<std::string, Json>();
-				return;
-			}
+bool JsonTokenizer::skip_value()
+{
+	_parser->skip_json( _depth );
+	return not _parser->failed;
+}
 
-			auto prevSize = collect_object_data.size();
+bool JsonTokenizer::start_object()
+{
+	auto ch = _parser->get_next_token();
+	if ( _parser->failed )
+		return false;
+	if ( ch != '{' )
+		return fail( "expected object, got " + details::esc( ch ) );
+	if ( ++_depth > details::max_depth )
+		return fail( "exceeded maximum nesting depth" );
+	_first = true;
+	return true;
+}
 
-			for ( ;; )
-			{
-				if ( ch != '"' )
-				{
-					output =
-					    fail( "expected '\"' in object, got " + esc( ch ) );
-					return;
-				}
+/* next_key(key)
+ *
+ * Read the comma, the key and the colon of the next member, false at the
+ * closing brace.
+ */
+bool JsonTokenizer::next_key( std::string_view &o_key )
+{
+	if ( _parser->failed )
+		return false;
+	auto ch = _parser->get_next_token();
+	if ( ch == '}' )
+	{
+		--_depth;
+		_first = false;
+		return false;
+	}
+	if ( not _first )
+	{
+		if ( ch != ',' )
+			return fail( "expected ',' in object, got " + details::esc( ch ) );
+		ch = _parser->get_next_token();
+	}
+	_first = false;
+	if ( ch != '"' )
+		return fail( "expected '\"' in object, got " + details::esc( ch ) );
+	_parser->parse_string();
+	auto &collected = _parser->collect_string;
+	o_key = std::string_view( collected.begin(), collected.size() );
+	ch = _parser->get_next_token();
+	if ( ch != ':' )
+		return fail( "expected ':' in object, got " + details::esc( ch ) );
+	return not _parser->failed;
+}
 
-				parse_string();
-				if ( failed )
-					return;
+bool JsonTokenizer::start_array()
+{
+	auto ch = _parser->get_next_token();
+	if ( _parser->failed )
+		return false;
+	if ( ch != '[' )
+		return fail( "expected array, got " + details::esc( ch ) );
+	if ( ++_depth > details::max_depth )
+		return fail( "exceeded maximum nesting depth" );
+	_first = true;
+	return true;
+}
 
-				std::string object_key( collect_string.begin(),
-				                        collect_string.end() );
+bool JsonTokenizer::next_item()
+{
+	if ( _parser->failed )
+		return false;
+	auto ch = _parser->get_next_token();
+	if ( ch == ']' )
+	{
+		--_depth;
+		_first = false;
+		return false;
+	}
+	if ( _first )
+		--_parser->it;
+	else if ( ch != ',' )
+		return fail( "expected ',' in list, got " + details::esc( ch ) );
+	_first = false;
+	return not _parser->failed;
+}
 
-				ch = get_next_token();
-				if ( ch != ':' )
-				{
-					output = fail( "expected ':' in object, got " + esc( ch ) );
-					return;
-				}
+bool JsonTokenizer::finish()
+{
+	if ( _parser->failed )
+		return false;
+	_parser->consume_garbage();
+	if ( _parser->it != _text.end() )
+		return fail( "unexpected trailing" );
+	return true;
+}
 
-				Json v;
-				parse_json( depth + 1, v );
-				collect_object_data.emplace_back( std::move( object_key ),
-				                                  std::move( v ) );
-				if ( failed )
-					return;
+/* * * * * * * * * * * * * * * * * * * *
+ * Writer
+ */
 
-				ch = get_next_token();
-				if ( ch == '}' )
-					break;
-				if ( ch != ',' )
-				{
-					output = fail( "expected ',' in object, got " + esc( ch ) );
-					return;
-				}
+void JsonWriter::null()
+{
+	separator();
+	_out.append( "null", 4 );
+}
 
-				ch = get_next_token();
-			}
-			flat_map<std::string, Json> object_data;
-			object_data.storage().assign(
-			    collect_object_data.begin() + prevSize,
-			    collect_object_data.end() );
-			collect_object_data.resize( prevSize );
-
-			std::sort( object_data.storage().begin(),
-			           object_data.storage().end(),
-			           []( const auto &lhs, const auto &rhs ) {
-				           return lhs.first < rhs.first;
-			           } );
-			auto last = std::unique( object_data.storage().begin(),
-			                         object_data.storage().end(),
-			                         []( const auto &lhs, const auto &rhs ) {
-				                         return lhs.first == rhs.first;
-			                         } );
-			object_data.storage().erase( last, object_data.storage().end() );
-			output = std::move( object_data );
-			return;
-		}
+void JsonWriter::boolean( bool i_value )
+{
+	separator();
+	if ( i_value )
+		_out.append( "true", 4 );
+	else
+		_out.append( "false", 5 );
+}
 
-		if ( ch == '[' )
-		{
-			ch = get_next_token();
-			if ( ch == ']' )
-			{
-				output = std::vector<Json>();
-				return;
-			}
+void JsonWriter::number( int64_t i_value )
+{
+	separator();
+	char buf[32];
+	_out.append( buf, numtoa( i_value, buf ) - buf );
+}
 
-			auto prevSize = collect_array_data.size();
+void JsonWriter::number( uint64_t i_value )
+{
+	separator();
+	char buf[32];
+	_out.append( buf, numtoa( i_value, buf ) - buf );
+}
 
-			for ( ;; )
-			{
-				--it;
-				Json v;
-				parse_json( depth + 1, v );
-				if ( failed )
-					return;
-				collect_array_data.push_back( std::move( v ) );
+void JsonWriter::number( double i_value )
+{
+	separator();
+	char buf[32];
+	if ( std::isfinite( i_value ) )
+		_out.append( buf, numtoa( i_value, buf ) - buf );
+	else
+		_out.append( "null", 4 );
+}
 
-				ch = get_next_token();
-				if ( ch == ']' )
-					break;
-				if ( ch != ',' )
-				{
-					output = fail( "expected ',' in list, got " + esc( ch ) );
-					return;
-				}
+void JsonWriter::string( const std::string_view &i_value )
+{
+	separator();
+	::dump( i_value, _out );
+}
 
-				ch = get_next_token();
-				(void)ch;
-			}
-			output = std::vector<Json>( collect_array_data.begin() + prevSize,
-			                            collect_array_data.end() );
-			collect_array_data.resize( prevSize );
-			return;
-		}
+void JsonWriter::value( const Json &i_value )
+{
+	separator();
+	i_value.dump( _out );
+}
 
-		output = fail( "expected value, got " + esc( ch ) );
-	}
-};
+void JsonWriter::start_object()
+{
+	separator();
+	_out.push_back( '{' );
+	_first = true;
 }
 
-Json Json::parse( const std::string_view &input,
-                  std::string &err,
-                  JsonParse strategy )
+void JsonWriter::key( const std::string_view &i_key )
 {
-	Json result;
-	details::JsonParser parser( input, err, strategy );
-	parser.parse_json( 0, result );
+	separator();
+	::dump( i_key, _out );
+	_out.push_back( ':' );
+	_first = true;
+}
 
-	// Check for any trailing garbage
-	parser.consume_garbage();
-	if ( parser.it != input.end() )
-		result = parser.fail( "unexpected trailing" );
+void JsonWriter::end_object()
+{
+	_out.push_back( '}' );
+	_first = false;
+}
 
-	return result;
+void JsonWriter::start_array()
+{
+	separator();
+	_out.push_back( '[' );
+	_first = true;
 }
 
-// Documented in sjson.h
-std::vector<Json> Json::parse_multi(
-    const std::string_view &input,
-    std::string_view::size_type &parser_stop_pos,
-    std::string &err,
-    JsonParse strategy )
+void JsonWriter::end_array()
 {
-	std::vector<Json> json_vec;
-	details::JsonParser parser( input, err, strategy );
-	parser_stop_pos = 0;
-	while ( parser.it != input.end() and not parser.failed )
-	{
-		Json v;
-		parser.parse_json( 0, v );
-		json_vec.push_back( std::move( v ) );
-		// Check for another object
-		parser.consume_garbage();
-		if ( not parser.failed )
-			parser_stop_pos = parser.it - input.begin();
-	}
-	return json_vec;
+	_out.push_back( ']' );
+	_first = false;
 }
 
 /* * * * * * * * * * * * * * * * * * * *
@@ -1,8 +1,13 @@
 #ifndef H_SU_JSON
 #define H_SU_JSON
 
+#include <cstdint>
 #include <string_view>
 #include <string>
+#include <functional>
+#include <iosfwd>
+#include <deque>
+#include <memory>
 #include "su_flat_map.h"
 
 namespace su {
@@ -13,15 +18,129 @@ enum class JsonParse
 	COMMENTS
 };
 
+enum class JsonDump
+{
+	COMPACT,
+	// 2 spaces indentation, one item per line
+	PRETTY
+};
+
+class jobdispatcher;
+class filepath;
+
 namespace details {
 struct JsonValue;
+struct JsonParser;
+struct JsonMemoryCounter;
 }
 
+/*!
+   @brief Monotonic memory arena for Json::parse.
+
+   The string, array and object nodes of a document parsed into an arena,
+   and the characters of its strings, are carved out of a few large blocks
+   instead of being allocated one by one, and they are not ref counted. The
+   items of an array or object (keys included) are still allocated on the
+   heap: reset() and the destructor run the destructor of each array and
+   object node, O(n) in their number, strings have nothing to destroy and
+   the blocks are released at once. Json values referring to an arena must
+   not outlive it.
+*/
+class JsonArena final
+{
+public:
+	JsonArena( size_t i_blockSize = 64 * 1024 );
+	~JsonArena();
+
+	JsonArena( const JsonArena & ) = delete;
+	JsonArena &operator=( const JsonArena & ) = delete;
+
+	//! destroy the array and object nodes, one by one, keep the first block
+	//! for re-use
+	void reset();
+
+	//! bytes reserved from the system
+	size_t capacity() const;
+
+	void *allocate( size_t i_size, size_t i_align );
+
+private:
+	friend struct details::JsonParser;
+
+	struct Block
+	{
+		Block *next;
+		size_t size;
+	};
+	Block *_blocks = nullptr;
+	char *_ptr = nullptr;
+	char *_end = nullptr;
+	size_t _blockSize;
+	// the nodes to destroy on reset(), strings are not
+	std::vector<details::JsonValue *> _nodes;
+};
+
+/*!
+   @brief Intern table for Json::parse, hash-consing of repeated values.
+
+   Strings too long to be stored inline and arrays and objects of up to
+   i_maxItems items are looked up in the table as they are parsed: identical
+   ones share a single node, within a document and across all the documents
+   parsed with the same table. The nodes are reference counted as usual,
+   values can outlive the table and the first change to a shared value
+   copies it (see Json::set). Not thread safe.
+*/
+class JsonInternTable final
+{
+public:
+	JsonInternTable( size_t i_maxItems = 16 );
+	~JsonInternTable();
+
+	JsonInternTable( const JsonInternTable & ) = delete;
+	JsonInternTable &operator=( const JsonInternTable & ) = delete;
+
+	//! forget all the values, the documents keep theirs
+	void clear();
+
+	//! number of distinct strings, arrays and objects in the table
+	size_t size() const;
+
+private:
+	friend struct details::JsonParser;
+
+	struct Impl;
+	std::unique_ptr<Impl> _impl;
+};
+
+/*!
+   @brief Heap memory held by a Json, see Json::memory_breakdown().
+
+   Nodes reachable several times are counted once, allocator overhead is
+   not counted.
+*/
+struct JsonMemoryUsage
+{
+	size_t nodes = 0; // string, array and object nodes
+	size_t node_bytes = 0; // the nodes themselves
+	size_t string_bytes = 0; // characters of long strings and keys
+	size_t container_bytes = 0; // items of arrays and objects
+	size_t slack_bytes = 0; // reserved but unused, see Json::shrink_to_fit()
+	size_t index_bytes = 0; // key index of large objects
+	// the part of the total also referenced from outside of this tree
+	size_t shared_bytes = 0;
+
+	size_t total() const
+	{
+		return node_bytes + string_bytes + container_bytes + slack_bytes +
+		       index_bytes;
+	}
+};
+
 class Json final
 {
 public:
 	// Types
-	enum class Type
+	enum class Type : uint8_t
 	{
 		NUL,
 		BOOL,
@@ -55,6 +174,7 @@ public:
 	Json( bool value ); // BOOL
 	Json( const std::string &value ); // STRING
 	Json( std::string &&value ); // STRING
+	Json( const std::string_view &value ); // STRING
 	Json( const char *value ); // STRING
 	Json( const array &values ); // ARRAY
 	Json( array &&values ); // ARRAY
@@ -107,17 +227,20 @@ public:
 	bool is_array() const { return type() == Type::ARRAY; }
 	bool is_object() const { return type() == Type::OBJECT; }
 
-	enum class NumberType
+	enum class NumberType : uint8_t
 	{
 		NOTANUMBER,
 		INTEGER,
 		INTEGER64,
 		DOUBLE
 	};
-	NumberType number_type() const { return _numberType; }
-	bool is_int() const { return number_type() == NumberType::INTEGER; }
-	bool is_int64() const { return number_type() == NumberType::INTEGER64; }
-	bool is_double() const { return number_type() == NumberType::DOUBLE; }
+	NumberType number_type() const
+	{
+		return _type == Type::NUMBER ? _numberType : NumberType::NOTANUMBER;
+	}
+	bool is_int() const { return _numberType == NumberType::INTEGER; }
+	bool is_int64() const { return _numberType == NumberType::INTEGER64; }
+	bool is_double() const { return _numberType == NumberType::DOUBLE; }
 
 	// Return the enclosed value if this is a number, 0 otherwise. Note that
 	// sjson does not distinguish between integer and non-integer numbers -
@@ -129,8 +252,12 @@ public:
 
 	// Return the enclosed value if this is a boolean, false otherwise.
 	bool bool_value() const;
-	// Return the enclosed string if this is a string, "" otherwise.
-	const std::string &string_value() const;
+	// Return a copy of the enclosed string if this is a string, "" otherwise.
+	std::string string_value() const;
+	// Same, without a copy. Short strings are stored inside the Json itself,
+	// the view is valid as long as this Json is neither modified, moved nor
+	// destroyed.
+	std::string_view string_view() const;
 	// Return the enclosed std::vector if this is an array, or an empty vector
 	// otherwise.
 	const array &array_items() const;
@@ -153,14 +280,51 @@ public:
 	// Return a reference to obj[key] if this is an object, Json() otherwise.
 	const Json &operator[]( const std::string_view &key ) const;
 
+	// Mutation. Arrays and objects are shared between copies: the first
+	// change to a shared one detaches it, copying the items but not their
+	// content, a unique one is changed in place. Null is turned into an
+	// empty object or array first, other types are left unchanged and false
+	// is returned.
+	bool set( const std::string_view &key, Json value );
+	bool push_back( Json value );
+	// Return true if an item was removed.
+	bool erase( const std::string_view &key );
+	bool erase( size_t i );
+	// Return a mutable pointer to obj[key] or array[i], nullptr if missing.
+	Json *mutable_item( const std::string_view &key );
+	Json *mutable_item( size_t i );
+	// Set the value at a dot separated path, array elements by index:
+	// "a.0.b". Missing keys along the way are created as objects, an index
+	// past the end of an array fails.
+	bool set_path( const std::string_view &path, Json value );
+
+	// Heap memory held by this value, sizeof( Json ) is not included.
+	size_t memory_usage() const { return memory_breakdown().total(); }
+	JsonMemoryUsage memory_breakdown() const;
+	// Release the unused capacity of the strings, arrays and objects only
+	// this value refers to, shared ones are left alone. Return the number
+	// of bytes released.
+	size_t shrink_to_fit();
+
 	// Serialize.
-	void dump( std::string &output ) const;
-	std::string dump() const
+	void dump( std::string &output, JsonDump style = JsonDump::COMPACT ) const;
+	std::string dump( JsonDump style = JsonDump::COMPACT ) const
 	{
 		std::string output;
-		dump( output );
+		dump( output, style );
 		return output;
 	}
+	// Serialize through a fixed size buffer, write is called each time it
+	// fills up and at the end, the document is never in memory as a whole.
+	// Return false as soon as write does, the output is then incomplete.
+	bool dump( const std::function<bool( const char *, size_t )> &write,
+	           JsonDump style = JsonDump::COMPACT ) const;
+	bool dump( std::streambuf &output,
+	           JsonDump style = JsonDump::COMPACT ) const;
+	// Set badbit on error.
+	void dump( std::ostream &output, JsonDump style = JsonDump::COMPACT ) const;
+	// The exact size of the output of dump(), without writing it.
+	size_t dump_size( JsonDump style = JsonDump::COMPACT ) const;
 
 	// Parse. If parse fails, return Json() and assign an error message to err.
 	static Json parse( const std::string_view &input,
@@ -177,6 +341,23 @@ public:
 		}
 		return parse( std::string_view( input ), err, strategy );
 	}
+	// Parse into an arena, see JsonArena.
+	static Json parse( const std::string_view &input,
+	                   std::string &err,
+	                   JsonArena &arena,
+	                   JsonParse strategy = JsonParse::STANDARD );
+	// Parse sharing the repeated values, see JsonInternTable.
+	static Json parse( const std::string_view &input,
+	                   std::string &err,
+	                   JsonInternTable &table,
+	                   JsonParse strategy = JsonParse::STANDARD );
+	// Parse a file in place: it is memory mapped, not read into a string
+	// first. With prefetch, the kernel is asked to read the whole file
+	// ahead while it is parsed. The file must not be truncated meanwhile.
+	static Json parse_file( const filepath &path,
+	                        std::string &err,
+	                        JsonParse strategy = JsonParse::STANDARD,
+	                        bool prefetch = false );
 	// Parse multiple objects, concatenated or separated by whitespace
 	static std::vector<Json> parse_multi(
 	    const std::string_view &input,
@@ -192,6 +373,22 @@ public:
 		std::string::size_type parser_stop_pos;
 		return parse_multi( input, parser_stop_pos, err, strategy );
 	}
+	// Parse newline delimited json, one document per line, in parallel on
+	// the workers of dispatcher. The input is cut in chunks at newlines and
+	// callback receives the documents in their original order, on the
+	// calling thread, until it returns false. Must be called from the main
+	// thread. Return false if stopped by callback or on error, with an error
+	// message in err.
+	static bool parse_multi( const std::string_view &input,
+	                         jobdispatcher &dispatcher,
+	                         const std::function<bool( Json && )> &callback,
+	                         std::string &err,
+	                         JsonParse strategy = JsonParse::STANDARD );
+	static std::vector<Json> parse_multi(
+	    const std::string_view &input,
+	    jobdispatcher &dispatcher,
+	    std::string &err,
+	    JsonParse strategy = JsonParse::STANDARD );
 
 	bool operator==( const Json &rhs ) const;
 	bool operator<( const Json &rhs ) const;
@@ -199,6 +396,8 @@ public:
 	bool operator<=( const Json &rhs ) const { return !( rhs < *this ); }
 	bool operator>( const Json &rhs ) const { return ( rhs < *this ); }
 	bool operator>=( const Json &rhs ) const { return !( *this < rhs ); }
+	// Consistent with operator==, the hash of long strings is computed once.
+	size_t hash() const;
 	/* has_shape(types, err)
 	 *
 	 * Return true if this is a JSON object and, for each item in types, has a
@@ -209,6 +408,36 @@ public:
 	bool has_shape( const shape &types, std::string &err ) const;
 
 private:
+	friend struct details::JsonParser;
+	friend struct details::JsonMemoryCounter;
+
+	Json( const details::JsonValue *i_node, Type i_type ) noexcept :
+	    _data( i_node ),
+	    _type( i_type )
+	{
+	}
+	// Strings of up to kInlineCapacity bytes are stored in _data.chars and
+	// _chars, their size is in _numberType, offset by kInlineString.
+	static constexpr size_t kInlineCapacity = 14;
+	static constexpr uint8_t kInlineString = 4;
+	bool is_inline_string() const
+	{
+		return static_cast<uint8_t>( _numberType ) >= kInlineString;
+	}
+	// A string, array or object node.
+	bool has_node() const
+	{
+		return _type >= Type::STRING and
+		       _numberType == NumberType::NOTANUMBER;
+	}
+	void set_inline_string( const std::string_view &i_value );
+	// The node of an array or object, ready to be changed.
+	details::JsonValue *detach();
+	template<bool PRETTY, typename OUT>
+	void dump_to( OUT &out, int depth ) const;
+	template<typename OUT>
+	void dump_to( OUT &out, JsonDump style ) const;
+
 	union Storage
 	{
 		Storage() : all( 0 ) {}
@@ -218,6 +447,7 @@ private:
 		Storage( bool v ) : b( v ) {}
 		Storage( const details::JsonValue *const v ) : p( v ) {}
 		uint64_t all;
+		char chars[sizeof( uint64_t )]; // start of an inline string
 		const int32_t i32;
 		const int64_t i64;
 		const double d;
@@ -225,9 +455,345 @@ private:
 		const details::JsonValue *const p; // ref counted
 	} _data;
 	static_assert( sizeof( Storage ) == sizeof( uint64_t ), "" );
+	char _chars[kInlineCapacity - sizeof( Storage )]{};
 	Type _type{Type::NUL};
 	NumberType _numberType{NumberType::NOTANUMBER};
 };
+static_assert( sizeof( Json ) == 16, "" );
+
+/*!
+   @brief Read-only, lazy view of a value inside a json text.
+
+   Nothing is parsed up front: operator[] skips over the values it does not
+   need, strings and numbers are decoded on access. The text must outlive
+   the views, a mapped file is kept mapped by its views. A view of a missing
+   or malformed value is null, is_missing() tells a missing value from an
+   explicit null.
+*/
+class JsonView final
+{
+public:
+	JsonView() = default;
+
+	Json::Type type() const;
+	bool is_null() const { return type() == Json::Type::NUL; }
+	bool is_number() const { return type() == Json::Type::NUMBER; }
+	bool is_bool() const { return type() == Json::Type::BOOL; }
+	bool is_string() const { return type() == Json::Type::STRING; }
+	bool is_array() const { return type() == Json::Type::ARRAY; }
+	bool is_object() const { return type() == Json::Type::OBJECT; }
+	// Not found by operator[], or a default constructed view.
+	bool is_missing() const { return _pos == std::string_view::npos; }
+
+	// Decoded on each call, 0 / false / "" if not of the right type.
+	double number_value() const;
+	int32_t int_value() const;
+	int64_t int64_value() const;
+	bool bool_value() const;
+	std::string string_value() const;
+	// Point straight into the text when the string has no escapes, otherwise
+	// decode into io_buffer.
+	std::string_view string_value( std::string &io_buffer ) const;
+
+	// Return the view of array[i] if this is an array, a null view otherwise.
+	JsonView operator[]( size_t i ) const;
+	// Return the view of obj[key] if this is an object, a null view otherwise.
+	JsonView operator[]( const std::string_view &key ) const;
+
+	// Number of items of an array or object, 0 otherwise.
+	size_t size() const;
+
+	// Visit the items of an array or an object, stop when the callback
+	// returns false. Keys are decoded in a temporary buffer if needed.
+	void for_each_item( const std::function<bool( const JsonView & )> &i_cb ) const;
+	void for_each_member(
+	    const std::function<bool( const std::string_view &, const JsonView & )>
+	        &i_cb ) const;
+
+	// The json text of this value.
+	std::string_view raw() const;
+
+	// Fully parse this value.
+	Json to_json() const;
+
+private:
+	friend class JsonDocumentView;
+
+	JsonView( const std::string_view &i_text,
+	          size_t i_pos,
+	          const std::shared_ptr<const void> &i_owner ) :
+	    _text( i_text ),
+	    _pos( i_pos ),
+	    _owner( i_owner )
+	{
+	}
+
+	std::string_view _text;
+	size_t _pos = std::string_view::npos;
+	// keeps _text alive, null if the caller does
+	std::shared_ptr<const void> _owner;
+};
+
+/*!
+   @brief Entry point to lazily navigate a json text, see JsonView.
+*/
+class JsonDocumentView final
+{
+public:
+	JsonDocumentView( const std::string_view &i_text ) : _text( i_text ) {}
+	// Map a file, it stays mapped as long as this or any of its views
+	// exist. On error, the root is null and err is set.
+	JsonDocumentView( const filepath &i_path,
+	                  std::string &o_err,
+	                  bool i_prefetch = false );
+
+	JsonView root() const;
+	JsonView operator[]( size_t i ) const { return root()[i]; }
+	JsonView operator[]( const std::string_view &key ) const
+	{
+		return root()[key];
+	}
+
+private:
+	std::string_view _text;
+	std::shared_ptr<const void> _owner;
+};
+
+/*!
+   @brief Event driven json reader.
+
+   Subclass and override the callbacks, each returns false to stop the
+   reader. Input can come from a stream or be fed in chunks of any size: only
+   the token in progress is buffered, so memory stays bounded by the largest
+   string or number, not by the document.
+*/
+class json_reader
+{
+public:
+	// i_multiple allow a sequence of values, concatenated or separated by
+	// whitespace, like Json::parse_multi.
+	json_reader( JsonParse i_strategy = JsonParse::STANDARD,
+	             bool i_multiple = false );
+	virtual ~json_reader() = default;
+
+	json_reader( const json_reader & ) = delete;
+	json_reader &operator=( const json_reader & ) = delete;
+
+	// Read the whole stream, return false on error or if stopped.
+	bool parse( std::istream &i_stream );
+
+	// Feed the next chunk, return false on error or if stopped.
+	bool feed( const std::string_view &i_chunk );
+	// End of input, return false if it is incomplete.
+	bool finish();
+
+	// Start over, for a new input.
+	void reset();
+
+	// Why the reader failed, empty if it was stopped by a callback.
+	const std::string &error() const { return _error; }
+
+	virtual bool start_object();
+	virtual bool key( const std::string_view &i_key );
+	virtual bool end_object();
+	virtual bool start_array();
+	virtual bool end_array();
+	virtual bool string( const std::string_view &i_value );
+	// i_value is a NUMBER, of the number type Json::parse would give it.
+	virtual bool number( const Json &i_value );
+	virtual bool boolean( bool i_value );
+	virtual bool null();
+
+private:
+	enum class State : uint8_t
+	{
+		VALUE,
+		FIRST_VALUE, // after [
+		FIRST_KEY, // after {
+		KEY,
+		COLON,
+		AFTER_VALUE
+	};
+	enum class Token : uint8_t
+	{
+		NONE,
+		STRING,
+		NUMBER,
+		LITERAL,
+		COMMENT_START,
+		LINE_COMMENT,
+		BLOCK_COMMENT,
+		BLOCK_COMMENT_STAR
+	};
+
+	const JsonParse _strategy;
+	const bool _multiple;
+	State _state = State::VALUE;
+	Token _token = Token::NONE;
+	bool _isKey = false;
+	bool _escape = false;
+	bool _hasEscapes = false;
+	bool _stopped = false;
+	std::string _buffer;
+	std::string _stack;
+	std::string _error;
+
+	bool fail( std::string &&i_msg );
+	bool stop( bool i_continue );
+	bool value( char c, const char *&io_p, const char *i_end );
+	bool string_chars( const char *&io_p, const char *i_end );
+	bool end_string();
+	bool end_number();
+	bool end_literal();
+	bool end_value();
+};
+
+/*!
+   @brief Resumable json parser, fed in chunks of any size.
+
+   Keeps its state between feed() calls, no input is scanned twice. Values
+   are available as soon as they close: a top-level number closes on the
+   next character or on finish().
+*/
+class JsonPushParser final : private json_reader
+{
+public:
+	// i_multiple allow a sequence of values, like Json::parse_multi.
+	JsonPushParser( JsonParse i_strategy = JsonParse::STANDARD,
+	                bool i_multiple = true );
+
+	// Feed the next chunk, return false on error.
+	bool feed( const std::string_view &i_chunk )
+	{
+		return json_reader::feed( i_chunk );
+	}
+	// End of input, return false if it is incomplete.
+	bool finish() { return json_reader::finish(); }
+
+	// Start over, drop values not yet taken.
+	void reset();
+
+	using json_reader::error;
+
+	// Completed values, in input order.
+	bool has_value() const { return not _values.empty(); }
+	Json next_value();
+
+private:
+	struct Frame
+	{
+		bool object;
+		size_t start;
+	};
+	std::vector<Frame> _frames;
+	std::vector<Json> _arrayData;
+	std::vector<std::pair<std::string, Json>> _objectData;
+	std::deque<Json> _values;
+
+	bool add( Json &&i_value );
+
+	bool start_object() override;
+	bool key( const std::string_view &i_key ) override;
+	bool end_object() override;
+	bool start_array() override;
+	bool end_array() override;
+	bool string( const std::string_view &i_value ) override;
+	bool number( const Json &i_value ) override;
+	bool boolean( bool i_value ) override;
+	bool null() override;
+};
+
+/*!
+   @brief Pull tokenizer, reads a json text one value at a time.
+
+   The caller asks for the value it expects next, nothing is built that it
+   does not ask for: used by the typed bindings of su_jsonbind.h. Strings
+   are decoded in an internal buffer, valid until the next call. After an
+   error every call returns false and error() has the first message.
+*/
+class JsonTokenizer final
+{
+public:
+	JsonTokenizer( const std::string_view &i_text,
+	               JsonParse i_strategy = JsonParse::STANDARD );
+	~JsonTokenizer();
+
+	JsonTokenizer( const JsonTokenizer & ) = delete;
+	JsonTokenizer &operator=( const JsonTokenizer & ) = delete;
+
+	// Type of the next value, NUL at the end of the input or after an error.
+	Json::Type peek();
+
+	bool read_null();
+	bool read_bool( bool &o_value );
+	// An int, int64 or double, like Json::parse.
+	bool read_number( Json &o_value );
+	// Same, o_text is the number as written, valid until the next call.
+	bool read_number( Json &o_value, std::string_view &o_text );
+	bool read_string( std::string_view &o_value );
+	bool read_value( Json &o_value );
+	bool skip_value();
+
+	// start_object(), then next_key() and a value until next_key() returns
+	// false at the closing brace. Same for arrays, with next_item().
+	bool start_object();
+	bool next_key( std::string_view &o_key );
+	bool start_array();
+	bool next_item();
+
+	// Check that only whitespace is left.
+	bool finish();
+
+	// Stop with an error, return false.
+	bool fail( std::string &&i_msg );
+	bool failed() const;
+	const std::string &error() const { return _error; }
+
+private:
+	std::string_view _text;
+	std::string _error;
+	std::unique_ptr<details::JsonParser> _parser;
+	int _depth = 0;
+	bool _first = false;
+};
+
+/*!
+   @brief Appends a json text to a string, one token at a time.
+
+   The counterpart of JsonTokenizer: commas and colons are added as needed,
+   the caller writes a well formed sequence of calls.
+*/
+class JsonWriter final
+{
+public:
+	explicit JsonWriter( std::string &o_output ) : _out( o_output ) {}
+
+	void null();
+	void boolean( bool i_value );
+	void number( int64_t i_value );
+	void number( uint64_t i_value );
+	// null if not finite, like Json::dump.
+	void number( double i_value );
+	void string( const std::string_view &i_value );
+	void value( const Json &i_value );
+
+	void start_object();
+	void key( const std::string_view &i_key );
+	void end_object();
+	void start_array();
+	void end_array();
+
+private:
+	std::string &_out;
+	bool _first = true;
+
+	void separator()
+	{
+		if ( not _first )
+			_out.push_back( ',' );
+		_first = false;
+	}
+};
 
 }
 
@@ -236,4 +802,14 @@ inline std::string to_string( const su::Json &v )
 	return v.dump();
 }
 
+namespace std {
+
+template<>
+struct hash<su::Json>
+{
+	std::size_t operator()( const su::Json &k ) const { return k.hash(); }
+};
+
+}
+
 #endif
@@ -0,0 +1,418 @@
+/*
+ *  su_jsonbind.h
+ *  sutils
+ *
+ *  Created by Sandy Martel on 2026/10/18.
+ *  Copyright (c) 2026年 Sandy Martel. All rights reserved.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software for any
+ * purpose is hereby granted without fee. The sotware is provided "AS-IS" and
+ * without warranty of any kind, express, implied or otherwise.
+ */
+
+#ifndef H_SU_JSONBIND
+#define H_SU_JSONBIND
+
+#include "su_json.h"
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+
+/*!
+   Typed binding: a json text is read straight into C++ values, and back,
+   without a Json tree in between.
+
+   A struct lists its members once:
+
+   struct User
+   {
+       std::string name;
+       int64_t id = 0;
+       std::vector<std::string> tags;
+       std::optional<Json> extra;
+
+       static constexpr auto json_fields()
+       {
+           return std::make_tuple( su::json_field( "name", &User::name ),
+                                   su::json_field( "id", &User::id ),
+                                   su::json_field( "tags", &User::tags ),
+                                   su::json_field( "extra", &User::extra ) );
+       }
+   };
+   User user;
+   if ( not su::json_read( text, user, err ) ) ...
+   std::string copy = su::json_write( user );
+
+   For a type that cannot be changed, specialize su::json_binding with a
+   static fields().
+
+   Supported: bool, numbers, std::string, Json, std::optional, containers
+   with emplace_back (std::vector, std::deque, std::list), maps with string
+   keys (std::map, std::unordered_map, su::flat_map) and bound structs.
+   Types with a to_json() are written through it and read with their
+   constructor from a Json, if they have one.
+
+   Unknown keys are skipped, missing keys keep the member unchanged and
+   empty optionals are not written.
+*/
+
+namespace su {
+
+template<class T, typename M>
+struct JsonField
+{
+	std::string_view name;
+	M T::*member;
+};
+
+template<class T, typename M>
+constexpr JsonField<T, M> json_field( const std::string_view &i_name,
+                                      M T::*i_member )
+{
+	return { i_name, i_member };
+}
+
+// The fields of T, from T::json_fields() by default.
+template<typename T, typename = void>
+struct json_binding
+{
+};
+
+template<typename T>
+struct json_binding<T, std::void_t<decltype( T::json_fields() )>>
+{
+	static constexpr auto fields() { return T::json_fields(); }
+};
+
+namespace details {
+
+template<typename T, typename = void>
+struct is_json_bound : std::false_type
+{
+};
+template<typename T>
+struct is_json_bound<T, std::void_t<decltype( json_binding<T>::fields() )>>
+    : std::true_type
+{
+};
+
+template<typename T>
+struct is_optional : std::false_type
+{
+};
+template<typename T>
+struct is_optional<std::optional<T>> : std::true_type
+{
+};
+
+template<typename T, typename = void>
+struct is_json_map : std::false_type
+{
+};
+template<typename T>
+struct is_json_map<T, std::void_t<typename T::mapped_type>>
+    : std::is_constructible<typename T::key_type, std::string_view>
+{
+};
+
+template<typename T, typename = void>
+struct is_json_sequence : std::false_type
+{
+};
+template<typename T>
+struct is_json_sequence<
+    T,
+    std::void_t<decltype( std::declval<T &>().emplace_back() )>>
+    : std::true_type
+{
+};
+
+template<typename T, typename = void>
+struct has_to_json : std::false_type
+{
+};
+template<typename T>
+struct has_to_json<T, std::void_t<decltype( std::declval<const T &>().to_json() )>>
+    : std::true_type
+{
+};
+
+template<typename T>
+inline constexpr bool always_false = false;
+
+/* json_read_integer(tokenizer, value)
+ *
+ * Integer digits are read exactly into T, all of uint64_t included.
+ * Integers in doubles are accepted if they are whole and in range.
+ */
+template<typename T>
+bool json_read_integer( JsonTokenizer &io_tokenizer, T &o_value )
+{
+	Json number;
+	std::string_view text;
+	if ( not io_tokenizer.read_number( number, text ) )
+		return false;
+	auto end = text.data() + text.size();
+	T exact;
+	auto res = std::from_chars( text.data(), end, exact );
+	if ( res.ec == std::errc() and res.ptr == end )
+	{
+		o_value = exact;
+		return true;
+	}
+	if ( res.ec == std::errc::result_out_of_range )
+		return io_tokenizer.fail( "integer out of range: " + std::string( text ) );
+	if ( number.number_type() == Json::NumberType::DOUBLE )
+	{
+		auto d = number.number_value();
+		if ( d != std::floor( d ) or
+		     d < static_cast<double>( std::numeric_limits<T>::min() ) or
+		     d >= std::ldexp( 1.0, std::numeric_limits<T>::digits ) )
+			return io_tokenizer.fail( "expected an integer, got " + number.dump() );
+		o_value = static_cast<T>( d );
+		return true;
+	}
+	auto v = number.int64_value();
+	if constexpr ( std::is_signed_v<T> )
+	{
+		if ( v < std::numeric_limits<T>::min() or v > std::numeric_limits<T>::max() )
+			return io_tokenizer.fail( "integer out of range: " + number.dump() );
+	}
+	else
+	{
+		if ( v < 0 or static_cast<uint64_t>( v ) > std::numeric_limits<T>::max() )
+			return io_tokenizer.fail( "integer out of range: " + number.dump() );
+	}
+	o_value = static_cast<T>( v );
+	return true;
+}
+
+}
+
+/* json_read(tokenizer, value)
+ *
+ * Read the next value of the tokenizer into value, return false on error.
+ */
+template<typename T>
+bool json_read( JsonTokenizer &io_tokenizer, T &o_value )
+{
+	if constexpr ( std::is_same_v<T, bool> )
+	{
+		return io_tokenizer.read_bool( o_value );
+	}
+	else if constexpr ( std::is_integral_v<T> )
+	{
+		return details::json_read_integer( io_tokenizer, o_value );
+	}
+	else if constexpr ( std::is_floating_point_v<T> )
+	{
+		Json number;
+		if ( not io_tokenizer.read_number( number ) )
+			return false;
+		o_value = static_cast<T>( number.number_value() );
+		return true;
+	}
+	else if constexpr ( std::is_same_v<T, std::string> )
+	{
+		std::string_view s;
+		if ( not io_tokenizer.read_string( s ) )
+			return false;
+		o_value.assign( s.data(), s.size() );
+		return true;
+	}
+	else if constexpr ( std::is_same_v<T, Json> )
+	{
+		return io_tokenizer.read_value( o_value );
+	}
+	else if constexpr ( details::is_optional<T>::value )
+	{
+		if ( io_tokenizer.peek() == Json::Type::NUL )
+		{
+			o_value.reset();
+			return io_tokenizer.read_null();
+		}
+		if ( not o_value )
+			o_value.emplace();
+		return json_read( io_tokenizer, *o_value );
+	}
+	else if constexpr ( details::is_json_bound<T>::value )
+	{
+		if ( not io_tokenizer.start_object() )
+			return false;
+		const auto fields = json_binding<T>::fields();
+		std::string_view key;
+		while ( io_tokenizer.next_key( key ) )
+		{
+			auto match = [&]( const auto &field ) {
+				if ( field.name != key )
+					return false;
+				json_read( io_tokenizer, o_value.*field.member );
+				return true;
+			};
+			bool found = std::apply(
+			    [&]( const auto &... field ) { return ( match( field ) or ... ); },
+			    fields );
+			if ( not found )
+				io_tokenizer.skip_value();
+		}
+		return not io_tokenizer.failed();
+	}
+	else if constexpr ( details::is_json_map<T>::value )
+	{
+		if ( not io_tokenizer.start_object() )
+			return false;
+		o_value.clear();
+		std::string_view key;
+		while ( io_tokenizer.next_key( key ) )
+			json_read( io_tokenizer, o_value[typename T::key_type( key )] );
+		return not io_tokenizer.failed();
+	}
+	else if constexpr ( details::is_json_sequence<T>::value )
+	{
+		if ( not io_tokenizer.start_array() )
+			return false;
+		o_value.clear();
+		while ( io_tokenizer.next_item() )
+			json_read( io_tokenizer, o_value.emplace_back() );
+		return not io_tokenizer.failed();
+	}
+	else if constexpr ( std::is_constructible_v<T, Json> )
+	{
+		Json value;
+		if ( not io_tokenizer.read_value( value ) )
+			return false;
+		o_value = T( value );
+		return true;
+	}
+	else
+	{
+		static_assert( details::always_false<T>, "no json binding for this type" );
+		return false;
+	}
+}
+
+/* json_write(writer, value)
+ *
+ * Write value with writer.
+ */
+template<typename T>
+void json_write( JsonWriter &io_writer, const T &i_value )
+{
+	if constexpr ( std::is_same_v<T, bool> )
+	{
+		io_writer.boolean( i_value );
+	}
+	else if constexpr ( std::is_integral_v<T> and std::is_signed_v<T> )
+	{
+		io_writer.number( static_cast<int64_t>( i_value ) );
+	}
+	else if constexpr ( std::is_integral_v<T> )
+	{
+		io_writer.number( static_cast<uint64_t>( i_value ) );
+	}
+	else if constexpr ( std::is_floating_point_v<T> )
+	{
+		io_writer.number( static_cast<double>( i_value ) );
+	}
+	else if constexpr ( std::is_convertible_v<const T &, std::string_view> )
+	{
+		io_writer.string( i_value );
+	}
+	else if constexpr ( std::is_same_v<T, Json> )
+	{
+		io_writer.value( i_value );
+	}
+	else if constexpr ( details::is_optional<T>::value )
+	{
+		if ( i_value )
+			json_write( io_writer, *i_value );
+		else
+			io_writer.null();
+	}
+	else if constexpr ( details::is_json_bound<T>::value )
+	{
+		io_writer.start_object();
+		std::apply(
+		    [&]( const auto &... field ) {
+			    ( [&]( const auto &member ) {
+				      if constexpr ( details::is_optional<
+				                         std::decay_t<decltype( member )>>::value )
+				      {
+					      if ( not member )
+						      return;
+				      }
+				      io_writer.key( field.name );
+				      json_write( io_writer, member );
+			      }( i_value.*field.member ),
+			      ... );
+		    },
+		    json_binding<T>::fields() );
+		io_writer.end_object();
+	}
+	else if constexpr ( details::has_to_json<T>::value )
+	{
+		io_writer.value( i_value.to_json() );
+	}
+	else if constexpr ( details::is_json_map<T>::value )
+	{
+		io_writer.start_object();
+		for ( auto &item : i_value )
+		{
+			io_writer.key( item.first );
+			json_write( io_writer, item.second );
+		}
+		io_writer.end_object();
+	}
+	else if constexpr ( details::is_json_sequence<T>::value )
+	{
+		io_writer.start_array();
+		for ( auto &item : i_value )
+			json_write( io_writer, item );
+		io_writer.end_array();
+	}
+	else
+	{
+		static_assert( details::always_false<T>, "no json binding for this type" );
+	}
+}
+
+/* json_read(text, value, err, strategy)
+ *
+ * Read a whole json text into value. On error, return false with a message
+ * in err, value is partially filled.
+ */
+template<typename T>
+bool json_read( const std::string_view &i_text,
+                T &o_value,
+                std::string &o_err,
+                JsonParse i_strategy = JsonParse::STANDARD )
+{
+	JsonTokenizer tokenizer( i_text, i_strategy );
+	if ( json_read( tokenizer, o_value ) and tokenizer.finish() )
+		return true;
+	o_err = tokenizer.error();
+	return false;
+}
+
+// Append the json text of value to output.
+template<typename T>
+void json_write( std::string &o_output, const T &i_value )
+{
+	JsonWriter writer( o_output );
+	json_write( writer, i_value );
+}
+
+template<typename T>
+std::string json_write( const T &i_value )
+{
+	std::string output;
+	json_write( output, i_value );
+	return output;
+}
+
+}
+
+#endif
@@ -0,0 +1,375 @@
+/*
+ *  su_jsonpath.cpp
+ *  sutils
+ *
+ *  Created by Sandy Martel on 2026/10/18.
+ *  Copyright (c) 2026年 Sandy Martel. All rights reserved.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software for any
+ * purpose is hereby granted without fee. The sotware is provided "AS-IS" and
+ * without warranty of any kind, express, implied or otherwise.
+ */
+
+#include "su_jsonpath.h"
+#include <ciso646>
+#include <charconv>
+
+namespace su {
+namespace details {
+
+JsonPathStep::JsonPathStep( const JsonPathStep &rhs ) :
+    key( rhs.key ),
+    index( rhs.index ),
+    wildcard( rhs.wildcard ),
+    hint( rhs.hint.load( std::memory_order_relaxed ) )
+{
+}
+
+JsonPathStep &JsonPathStep::operator=( const JsonPathStep &rhs )
+{
+	key = rhs.key;
+	index = rhs.index;
+	wildcard = rhs.wildcard;
+	hint.store( rhs.hint.load( std::memory_order_relaxed ),
+	            std::memory_order_relaxed );
+	return *this;
+}
+
+}
+}
+
+namespace {
+
+using su::details::JsonPathStep;
+
+/* make_step(key, wildcards)
+ *
+ * An array index is "0" or digits without a leading zero.
+ */
+JsonPathStep make_step( std::string &&i_key, bool i_wildcards )
+{
+	JsonPathStep step;
+	step.wildcard = i_wildcards and i_key == "*";
+	if ( not i_key.empty() and ( i_key[0] != '0' or i_key.size() == 1 ) )
+	{
+		size_t index = 0;
+		auto end = i_key.data() + i_key.size();
+		auto res = std::from_chars( i_key.data(), end, index );
+		if ( res.ec == std::errc() and res.ptr == end )
+			step.index = index;
+	}
+	step.key = std::move( i_key );
+	return step;
+}
+
+/* compile_pointer(text, wildcards, steps, err)
+ *
+ * RFC 6901: "" is the whole document, otherwise each step is preceded by
+ * '/', with "~1" for '/' and "~0" for '~'.
+ */
+bool compile_pointer( const std::string_view &i_text,
+                      bool i_wildcards,
+                      std::vector<JsonPathStep> &o_steps,
+                      std::string &o_err )
+{
+	if ( i_text.empty() )
+		return true;
+	if ( i_text[0] != '/' )
+	{
+		o_err = "json pointer must start with '/'";
+		return false;
+	}
+	std::string key;
+	for ( size_t i = 1; i <= i_text.size(); ++i )
+	{
+		if ( i == i_text.size() or i_text[i] == '/' )
+		{
+			o_steps.push_back( make_step( std::move( key ), i_wildcards ) );
+			key.clear();
+		}
+		else if ( i_text[i] == '~' )
+		{
+			++i;
+			if ( i < i_text.size() and i_text[i] == '0' )
+				key.push_back( '~' );
+			else if ( i < i_text.size() and i_text[i] == '1' )
+				key.push_back( '/' );
+			else
+			{
+				o_err = "invalid escape in json pointer at " + std::to_string( i - 1 );
+				return false;
+			}
+		}
+		else
+			key.push_back( i_text[i] );
+	}
+	return true;
+}
+
+bool compile_path( const std::string_view &i_text,
+                   std::vector<JsonPathStep> &o_steps,
+                   std::string &o_err )
+{
+	if ( i_text.empty() or i_text[0] == '/' )
+		return compile_pointer( i_text, true, o_steps, o_err );
+
+	size_t start = 0;
+	for ( ;; )
+	{
+		auto dot = i_text.find( '.', start );
+		o_steps.push_back( make_step(
+		    std::string( i_text.substr( start, dot - start ) ), true ) );
+		if ( dot == std::string_view::npos )
+			break;
+		start = dot + 1;
+	}
+	return true;
+}
+
+/* lookup(value, step)
+ *
+ * The item step refers to in value, nullptr if missing.
+ */
+const su::Json *lookup( const su::Json &i_value, const JsonPathStep &i_step )
+{
+	if ( i_value.is_object() )
+	{
+		auto &items = i_value.object_items();
+		auto hint = i_step.hint.load( std::memory_order_relaxed );
+		if ( hint < items.size() )
+		{
+			auto it = items.begin() + hint;
+			if ( it->first == i_step.key )
+				return &it->second;
+		}
+		auto it = items.find( i_step.key );
+		if ( it == items.end() )
+			return nullptr;
+		i_step.hint.store( static_cast<uint32_t>( it - items.begin() ),
+		                   std::memory_order_relaxed );
+		return &it->second;
+	}
+	if ( i_value.is_array() and i_step.index < i_value.array_items().size() )
+		return &i_value.array_items()[i_step.index];
+	return nullptr;
+}
+
+su::JsonView lookup( const su::JsonView &i_value, const JsonPathStep &i_step )
+{
+	if ( i_value.is_object() )
+		return i_value[i_step.key];
+	if ( i_value.is_array() and i_step.index != JsonPathStep::npos )
+		return i_value[i_step.index];
+	return {};
+}
+
+template<typename VALUE, typename CB>
+bool walk( const VALUE &i_value,
+           const JsonPathStep *i_step,
+           const JsonPathStep *i_end,
+           const CB &i_cb );
+
+/* walk_all(value, step, end, cb)
+ *
+ * A wildcard step, walk the rest of the path from each item of value.
+ */
+bool walk_all( const su::Json &i_value,
+               const JsonPathStep *i_next,
+               const JsonPathStep *i_end,
+               const std::function<bool( const su::Json & )> &i_cb )
+{
+	if ( i_value.is_array() )
+	{
+		for ( auto &item : i_value.array_items() )
+		{
+			if ( not walk( item, i_next, i_end, i_cb ) )
+				return false;
+		}
+	}
+	else if ( i_value.is_object() )
+	{
+		for ( auto &item : i_value.object_items() )
+		{
+			if ( not walk( item.second, i_next, i_end, i_cb ) )
+				return false;
+		}
+	}
+	return true;
+}
+
+bool walk_all( const su::JsonView &i_value,
+               const JsonPathStep *i_next,
+               const JsonPathStep *i_end,
+               const std::function<bool( const su::JsonView & )> &i_cb )
+{
+	bool result = true;
+	if ( i_value.is_array() )
+	{
+		i_value.for_each_item( [&]( const su::JsonView &item ) {
+			return result = walk( item, i_next, i_end, i_cb );
+		} );
+	}
+	else if ( i_value.is_object() )
+	{
+		i_value.for_each_member(
+		    [&]( const std::string_view &, const su::JsonView &item ) {
+			    return result = walk( item, i_next, i_end, i_cb );
+		    } );
+	}
+	return result;
+}
+
+template<typename VALUE, typename CB>
+bool walk( const VALUE &i_value,
+           const JsonPathStep *i_step,
+           const JsonPathStep *i_end,
+           const CB &i_cb )
+{
+	// follow the plain steps without recursing
+	const VALUE *current = &i_value;
+	VALUE holder;
+	for ( ; i_step != i_end; ++i_step )
+	{
+		if ( i_step->wildcard )
+			return walk_all( *current, i_step + 1, i_end, i_cb );
+		if constexpr ( std::is_same_v<VALUE, su::Json> )
+		{
+			current = lookup( *current, *i_step );
+			if ( current == nullptr )
+				return true;
+		}
+		else
+		{
+			holder = lookup( *current, *i_step );
+			if ( holder.is_missing() )
+				return true;
+			current = &holder;
+		}
+	}
+	return i_cb( *current );
+}
+
+}
+
+namespace su {
+
+/* * * * * * * * * * * * * * * * * * * *
+ * JsonPointer
+ */
+
+JsonPointer::JsonPointer( const std::string_view &i_pointer, std::string &o_err )
+{
+	_valid = compile_pointer( i_pointer, false, _steps, o_err );
+	if ( not _valid )
+		_steps.clear();
+}
+
+JsonPointer::JsonPointer( const std::string_view &i_pointer )
+{
+	std::string err;
+	_valid = compile_pointer( i_pointer, false, _steps, err );
+	if ( not _valid )
+		_steps.clear();
+}
+
+const Json *JsonPointer::find( const Json &i_root ) const
+{
+	if ( not _valid )
+		return nullptr;
+	const Json *current = &i_root;
+	for ( auto &step : _steps )
+	{
+		current = lookup( *current, step );
+		if ( current == nullptr )
+			return nullptr;
+	}
+	return current;
+}
+
+JsonView JsonPointer::find( const JsonView &i_root ) const
+{
+	if ( not _valid )
+		return {};
+	JsonView current = i_root;
+	for ( auto &step : _steps )
+	{
+		current = lookup( current, step );
+		if ( current.is_missing() )
+			break;
+	}
+	return current;
+}
+
+Json JsonPointer::get( const Json &i_root ) const
+{
+	auto value = find( i_root );
+	return value != nullptr ? *value : Json();
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * JsonPath
+ */
+
+JsonPath::JsonPath( const std::string_view &i_path, std::string &o_err )
+{
+	_valid = compile_path( i_path, _steps, o_err );
+	if ( not _valid )
+		_steps.clear();
+}
+
+JsonPath::JsonPath( const std::string_view &i_path )
+{
+	std::string err;
+	_valid = compile_path( i_path, _steps, err );
+	if ( not _valid )
+		_steps.clear();
+}
+
+bool JsonPath::for_each( const Json &i_root,
+                         const std::function<bool( const Json & )> &i_cb ) const
+{
+	if ( not _valid )
+		return true;
+	return walk( i_root, _steps.data(), _steps.data() + _steps.size(), i_cb );
+}
+
+bool JsonPath::for_each(
+    const JsonView &i_root,
+    const std::function<bool( const JsonView & )> &i_cb ) const
+{
+	if ( not _valid )
+		return true;
+	return walk( i_root, _steps.data(), _steps.data() + _steps.size(), i_cb );
+}
+
+const Json *JsonPath::find_first( const Json &i_root ) const
+{
+	const Json *result = nullptr;
+	for_each( i_root, [&result]( const Json &i_match ) {
+		result = &i_match;
+		return false;
+	} );
+	return result;
+}
+
+std::vector<Json> JsonPath::select( const Json &i_root ) const
+{
+	std::vector<Json> result;
+	for_each( i_root, [&result]( const Json &i_match ) {
+		result.push_back( i_match );
+		return true;
+	} );
+	return result;
+}
+
+size_t JsonPath::count( const Json &i_root ) const
+{
+	size_t result = 0;
+	for_each( i_root, [&result]( const Json & ) {
+		++result;
+		return true;
+	} );
+	return result;
+}
+
+}
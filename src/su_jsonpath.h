@@ -0,0 +1,117 @@
+/*
+ *  su_jsonpath.h
+ *  sutils
+ *
+ *  Created by Sandy Martel on 2026/10/18.
+ *  Copyright (c) 2026年 Sandy Martel. All rights reserved.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software for any
+ * purpose is hereby granted without fee. The sotware is provided "AS-IS" and
+ * without warranty of any kind, express, implied or otherwise.
+ */
+
+#ifndef H_SU_JSONPATH
+#define H_SU_JSONPATH
+
+#include "su_json.h"
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace su {
+
+namespace details {
+
+// One step of a compiled path: an object key, also an array index if it is
+// a number.
+struct JsonPathStep
+{
+	static constexpr size_t npos = size_t( -1 );
+
+	JsonPathStep() = default;
+	JsonPathStep( const JsonPathStep &rhs );
+	JsonPathStep &operator=( const JsonPathStep &rhs );
+
+	std::string key;
+	size_t index = npos;
+	bool wildcard = false;
+	// position of key in the last object it was found in, tried before
+	// searching
+	mutable std::atomic<uint32_t> hint{0};
+};
+
+}
+
+/*!
+   @brief A compiled RFC 6901 json pointer, "/statuses/0/user/id".
+
+   The text is parsed once ("~1" is "/", "~0" is "~"). A lookup then only
+   compares keys: each step first tries the position its key had in the
+   previous object it was found in, documents of the same shape are walked
+   without searching. Can be used from several threads at once.
+*/
+class JsonPointer final
+{
+public:
+	// The whole document.
+	JsonPointer() = default;
+	// On error, the pointer matches nothing and err is set.
+	JsonPointer( const std::string_view &i_pointer, std::string &o_err );
+	explicit JsonPointer( const std::string_view &i_pointer );
+
+	bool is_valid() const { return _valid; }
+
+	// The value, nullptr if missing.
+	const Json *find( const Json &i_root ) const;
+	// The value, a null view if missing.
+	JsonView find( const JsonView &i_root ) const;
+	// A copy of the value, null if missing.
+	Json get( const Json &i_root ) const;
+
+private:
+	std::vector<details::JsonPathStep> _steps;
+	bool _valid = true;
+};
+
+/*!
+   @brief A compiled json path, a json pointer with wildcards.
+
+   Either a json pointer or dot separated keys, like Json::set_path. A "*"
+   step matches all the items of an array or all the values of an object,
+   "statuses.*.user.id" is the same path as the pointer form with a "*"
+   step between "statuses" and "user". The matches are visited
+   in place, in document order, without building intermediate arrays. Can
+   be used from several threads at once.
+*/
+class JsonPath final
+{
+public:
+	// On error, the path matches nothing and err is set.
+	JsonPath( const std::string_view &i_path, std::string &o_err );
+	explicit JsonPath( const std::string_view &i_path );
+
+	bool is_valid() const { return _valid; }
+
+	// Call i_cb for each match until it returns false, return false if
+	// stopped.
+	bool for_each( const Json &i_root,
+	               const std::function<bool( const Json & )> &i_cb ) const;
+	// A null view is a missing value, null values are not visited.
+	bool for_each( const JsonView &i_root,
+	               const std::function<bool( const JsonView & )> &i_cb ) const;
+
+	// The first match, nullptr if none.
+	const Json *find_first( const Json &i_root ) const;
+	// Copies of all the matches, they share their content with i_root.
+	std::vector<Json> select( const Json &i_root ) const;
+	size_t count( const Json &i_root ) const;
+
+private:
+	std::vector<details::JsonPathStep> _steps;
+	bool _valid = true;
+};
+
+}
+
+#endif
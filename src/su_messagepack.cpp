@@ -0,0 +1,431 @@
+/*
+ *  su_messagepack.cpp
+ *  sutils
+ *
+ *  Created by Sandy Martel on 2026/10/18.
+ *  Copyright (c) 2026年 Sandy Martel. All rights reserved.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software for any
+ * purpose is hereby granted without fee. The sotware is provided "AS-IS" and
+ * without warranty of any kind, express, implied or otherwise.
+ */
+
+#include "su_messagepack.h"
+#include "su_endian.h"
+#include <ciso646>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const int max_depth = 200;
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Writing
+ */
+
+class Writer
+{
+public:
+	Writer( std::vector<uint8_t> &o_buffer ) : _out( o_buffer ) {}
+
+	void write( const su::Json &i_json );
+
+private:
+	std::vector<uint8_t> &_out;
+
+	void put( uint8_t i_byte ) { _out.push_back( i_byte ); }
+	template<typename T>
+	void put( uint8_t i_byte, T i_value )
+	{
+		i_value = su::native_to_big( i_value );
+		auto pos = _out.size();
+		_out.resize( pos + 1 + sizeof( T ) );
+		_out[pos] = i_byte;
+		std::memcpy( _out.data() + pos + 1, &i_value, sizeof( T ) );
+	}
+
+	void write_int( int64_t i_value );
+	void write_double( double i_value );
+	void write_string( const std::string_view &i_value );
+	void write_header( size_t i_size, uint8_t i_fix, uint8_t i_16 );
+};
+
+void Writer::write( const su::Json &i_json )
+{
+	switch ( i_json.type() )
+	{
+		case su::Json::Type::NUL:
+			put( 0xc0 );
+			break;
+		case su::Json::Type::BOOL:
+			put( i_json.bool_value() ? 0xc3 : 0xc2 );
+			break;
+		case su::Json::Type::NUMBER:
+			if ( i_json.is_double() )
+				write_double( i_json.number_value() );
+			else
+				write_int( i_json.int64_value() );
+			break;
+		case su::Json::Type::STRING:
+			write_string( i_json.string_view() );
+			break;
+		case su::Json::Type::ARRAY:
+		{
+			const auto &items = i_json.array_items();
+			write_header( items.size(), 0x90, 0xdc );
+			for ( auto &it : items )
+				write( it );
+			break;
+		}
+		case su::Json::Type::OBJECT:
+		{
+			const auto &items = i_json.object_items();
+			write_header( items.size(), 0x80, 0xde );
+			for ( auto &it : items )
+			{
+				write_string( it.first );
+				write( it.second );
+			}
+			break;
+		}
+	}
+}
+
+void Writer::write_int( int64_t i_value )
+{
+	if ( i_value >= 0 )
+	{
+		if ( i_value < 128 )
+			put( static_cast<uint8_t>( i_value ) );
+		else if ( i_value <= std::numeric_limits<uint8_t>::max() )
+			put( 0xcc, static_cast<uint8_t>( i_value ) );
+		else if ( i_value <= std::numeric_limits<uint16_t>::max() )
+			put( 0xcd, static_cast<uint16_t>( i_value ) );
+		else if ( i_value <= std::numeric_limits<uint32_t>::max() )
+			put( 0xce, static_cast<uint32_t>( i_value ) );
+		else
+			put( 0xcf, static_cast<uint64_t>( i_value ) );
+	}
+	else
+	{
+		if ( i_value >= -32 )
+			put( static_cast<uint8_t>( i_value ) );
+		else if ( i_value >= std::numeric_limits<int8_t>::min() )
+			put( 0xd0, static_cast<int8_t>( i_value ) );
+		else if ( i_value >= std::numeric_limits<int16_t>::min() )
+			put( 0xd1, static_cast<int16_t>( i_value ) );
+		else if ( i_value >= std::numeric_limits<int32_t>::min() )
+			put( 0xd2, static_cast<int32_t>( i_value ) );
+		else
+			put( 0xd3, i_value );
+	}
+}
+
+void Writer::write_double( double i_value )
+{
+	float f = static_cast<float>( i_value );
+	if ( static_cast<double>( f ) == i_value )
+		put( 0xca, f );
+	else
+		put( 0xcb, i_value );
+}
+
+void Writer::write_string( const std::string_view &i_value )
+{
+	auto size = i_value.size();
+	if ( size < 32 )
+		put( static_cast<uint8_t>( 0xa0 | size ) );
+	else if ( size <= std::numeric_limits<uint8_t>::max() )
+		put( 0xd9, static_cast<uint8_t>( size ) );
+	else if ( size <= std::numeric_limits<uint16_t>::max() )
+		put( 0xda, static_cast<uint16_t>( size ) );
+	else
+		put( 0xdb, static_cast<uint32_t>( size ) );
+	_out.insert( _out.end(), i_value.begin(), i_value.end() );
+}
+
+// array and map headers, 16 and 32 bits variants are consecutive
+void Writer::write_header( size_t i_size, uint8_t i_fix, uint8_t i_16 )
+{
+	if ( i_size < 16 )
+		put( static_cast<uint8_t>( i_fix | i_size ) );
+	else if ( i_size <= std::numeric_limits<uint16_t>::max() )
+		put( i_16, static_cast<uint16_t>( i_size ) );
+	else
+		put( i_16 + 1, static_cast<uint32_t>( i_size ) );
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Reading
+ */
+
+class Reader
+{
+public:
+	Reader( const uint8_t *i_data, size_t i_size, std::string &o_err ) :
+	    _ptr( i_data ),
+	    _end( i_data + i_size ),
+	    _err( o_err )
+	{
+	}
+
+	su::Json read( int i_depth );
+	bool at_end() const { return _ptr == _end; }
+	bool failed() const { return _failed; }
+
+	su::Json fail( std::string &&i_msg )
+	{
+		if ( not _failed )
+			_err = std::move( i_msg );
+		_failed = true;
+		return su::Json();
+	}
+
+private:
+	const uint8_t *_ptr;
+	const uint8_t *_end;
+	std::string &_err;
+	bool _failed = false;
+
+	bool has( size_t i_size )
+	{
+		if ( static_cast<size_t>( _end - _ptr ) >= i_size )
+			return true;
+		fail( "unexpected end of input" );
+		return false;
+	}
+	template<typename T>
+	T get()
+	{
+		T v;
+		std::memcpy( &v, _ptr, sizeof( T ) );
+		_ptr += sizeof( T );
+		return su::big_to_native( v );
+	}
+	template<typename T>
+	bool get_size( size_t &o_size )
+	{
+		if ( not has( sizeof( T ) ) )
+			return false;
+		o_size = get<T>();
+		return true;
+	}
+
+	su::Json read_int( int64_t i_value );
+	su::Json read_string( size_t i_size );
+	bool read_key( std::string &o_key );
+	su::Json read_array( size_t i_size, int i_depth );
+	su::Json read_map( size_t i_size, int i_depth );
+};
+
+su::Json Reader::read( int i_depth )
+{
+	if ( i_depth > max_depth )
+		return fail( "exceeded maximum nesting depth" );
+	if ( not has( 1 ) )
+		return su::Json();
+
+	uint8_t b = *_ptr++;
+	if ( b < 0x80 )
+		return int( b );
+	if ( b >= 0xe0 )
+		return int( static_cast<int8_t>( b ) );
+	if ( b < 0x90 )
+		return read_map( b & 0x0f, i_depth );
+	if ( b < 0xa0 )
+		return read_array( b & 0x0f, i_depth );
+	if ( b < 0xc0 )
+		return read_string( b & 0x1f );
+
+	size_t size = 0;
+	switch ( b )
+	{
+		case 0xc0:
+			return su::Json();
+		case 0xc2:
+			return false;
+		case 0xc3:
+			return true;
+		case 0xc4: // bin 8
+		case 0xd9: // str 8
+			return get_size<uint8_t>( size ) ? read_string( size ) : su::Json();
+		case 0xc5: // bin 16
+		case 0xda: // str 16
+			return get_size<uint16_t>( size ) ? read_string( size ) : su::Json();
+		case 0xc6: // bin 32
+		case 0xdb: // str 32
+			return get_size<uint32_t>( size ) ? read_string( size ) : su::Json();
+		case 0xca:
+			return has( 4 ) ? su::Json( static_cast<double>( get<float>() ) )
+			                : su::Json();
+		case 0xcb:
+			return has( 8 ) ? su::Json( get<double>() ) : su::Json();
+		case 0xcc:
+			return has( 1 ) ? read_int( get<uint8_t>() ) : su::Json();
+		case 0xcd:
+			return has( 2 ) ? read_int( get<uint16_t>() ) : su::Json();
+		case 0xce:
+			return has( 4 ) ? read_int( get<uint32_t>() ) : su::Json();
+		case 0xcf:
+			if ( has( 8 ) )
+			{
+				auto v = get<uint64_t>();
+				if ( v > uint64_t( std::numeric_limits<int64_t>::max() ) )
+					return static_cast<double>( v );
+				return read_int( static_cast<int64_t>( v ) );
+			}
+			return su::Json();
+		case 0xd0:
+			return has( 1 ) ? read_int( get<int8_t>() ) : su::Json();
+		case 0xd1:
+			return has( 2 ) ? read_int( get<int16_t>() ) : su::Json();
+		case 0xd2:
+			return has( 4 ) ? read_int( get<int32_t>() ) : su::Json();
+		case 0xd3:
+			return has( 8 ) ? read_int( get<int64_t>() ) : su::Json();
+		case 0xdc:
+			return get_size<uint16_t>( size ) ? read_array( size, i_depth )
+			                                  : su::Json();
+		case 0xdd:
+			return get_size<uint32_t>( size ) ? read_array( size, i_depth )
+			                                  : su::Json();
+		case 0xde:
+			return get_size<uint16_t>( size ) ? read_map( size, i_depth )
+			                                  : su::Json();
+		case 0xdf:
+			return get_size<uint32_t>( size ) ? read_map( size, i_depth )
+			                                  : su::Json();
+		case 0xc7:
+		case 0xc8:
+		case 0xc9:
+		case 0xd4:
+		case 0xd5:
+		case 0xd6:
+		case 0xd7:
+		case 0xd8:
+			return fail( "unsupported ext type" );
+		default:
+			return fail( "invalid type byte " + std::to_string( b ) );
+	}
+}
+
+su::Json Reader::read_int( int64_t i_value )
+{
+	if ( i_value >= std::numeric_limits<int32_t>::min() and
+	     i_value <= std::numeric_limits<int32_t>::max() )
+		return static_cast<int32_t>( i_value );
+	return i_value;
+}
+
+su::Json Reader::read_string( size_t i_size )
+{
+	if ( not has( i_size ) )
+		return su::Json();
+	su::Json s( std::string( reinterpret_cast<const char *>( _ptr ), i_size ) );
+	_ptr += i_size;
+	return s;
+}
+
+bool Reader::read_key( std::string &o_key )
+{
+	if ( not has( 1 ) )
+		return false;
+	uint8_t b = *_ptr++;
+	size_t size = 0;
+	if ( b >= 0xa0 and b < 0xc0 )
+		size = b & 0x1f;
+	else if ( b == 0xd9 )
+	{
+		if ( not get_size<uint8_t>( size ) )
+			return false;
+	}
+	else if ( b == 0xda )
+	{
+		if ( not get_size<uint16_t>( size ) )
+			return false;
+	}
+	else if ( b == 0xdb )
+	{
+		if ( not get_size<uint32_t>( size ) )
+			return false;
+	}
+	else
+	{
+		fail( "map key is not a string" );
+		return false;
+	}
+	if ( not has( size ) )
+		return false;
+	o_key.assign( reinterpret_cast<const char *>( _ptr ), size );
+	_ptr += size;
+	return true;
+}
+
+su::Json Reader::read_array( size_t i_size, int i_depth )
+{
+	su::Json::array items;
+	// every item takes at least one byte
+	items.reserve( std::min<size_t>( i_size, _end - _ptr ) );
+	for ( size_t i = 0; i < i_size and not _failed; ++i )
+		items.push_back( read( i_depth + 1 ) );
+	return _failed ? su::Json() : su::Json( std::move( items ) );
+}
+
+su::Json Reader::read_map( size_t i_size, int i_depth )
+{
+	su::Json::object items;
+	items.reserve( std::min<size_t>( i_size, ( _end - _ptr ) / 2 ) );
+	std::string key;
+	for ( size_t i = 0; i < i_size and not _failed; ++i )
+	{
+		if ( not read_key( key ) )
+			break;
+		auto value = read( i_depth + 1 );
+		// keys are written sorted, append without searching
+		if ( items.empty() or items.storage().back().first < key )
+			items.storage().emplace_back( std::move( key ), std::move( value ) );
+		else
+			items[std::move( key )] = std::move( value );
+	}
+	return _failed ? su::Json() : su::Json( std::move( items ) );
+}
+
+}
+
+namespace su {
+namespace messagepack {
+
+void write( const Json &i_json, std::vector<uint8_t> &o_buffer )
+{
+	o_buffer.clear();
+	Writer writer( o_buffer );
+	writer.write( i_json );
+}
+
+std::vector<uint8_t> write( const Json &i_json )
+{
+	std::vector<uint8_t> result;
+	write( i_json, result );
+	return result;
+}
+
+Json read( const uint8_t *i_data, size_t i_size, std::string &o_err )
+{
+	Reader reader( i_data, i_size, o_err );
+	auto result = reader.read( 0 );
+	if ( reader.failed() )
+		return Json();
+	if ( not reader.at_end() )
+		return reader.fail( "unexpected trailing data" );
+	return result;
+}
+
+Json read( const uint8_t *i_data, size_t i_size )
+{
+	std::string err;
+	return read( i_data, i_size, err );
+}
+
+}
+}
@@ -0,0 +1,45 @@
+/*
+ *  su_messagepack.h
+ *  sutils
+ *
+ *  Created by Sandy Martel on 2026/10/18.
+ *  Copyright (c) 2026年 Sandy Martel. All rights reserved.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software for any
+ * purpose is hereby granted without fee. The sotware is provided "AS-IS" and
+ * without warranty of any kind, express, implied or otherwise.
+ */
+
+#ifndef H_SU_MESSAGEPACK
+#define H_SU_MESSAGEPACK
+
+#include "su_json.h"
+#include <cstdint>
+#include <vector>
+
+namespace su {
+namespace messagepack {
+
+/*!
+   @brief Serialize to MessagePack, https://msgpack.org
+
+   Numbers use the smallest encoding that keeps their value, doubles that are
+   exactly representable as a float are written as float 32.
+   o_buffer is cleared first, its capacity is kept for re-use.
+*/
+void write( const Json &i_json, std::vector<uint8_t> &o_buffer );
+std::vector<uint8_t> write( const Json &i_json );
+
+/*!
+   @brief Deserialize MessagePack.
+
+   bin is read as a string, maps must have string keys and ext types are not
+   supported. On error, return Json() and assign an error message to o_err.
+*/
+Json read( const uint8_t *i_data, size_t i_size, std::string &o_err );
+Json read( const uint8_t *i_data, size_t i_size );
+
+}
+}
+
+#endif
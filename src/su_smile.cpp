@@ -0,0 +1,715 @@
+/*
+ *  su_smile.cpp
+ *  sutils
+ *
+ *  Created by Sandy Martel on 2026/10/18.
+ *  Copyright (c) 2026年 Sandy Martel. All rights reserved.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software for any
+ * purpose is hereby granted without fee. The sotware is provided "AS-IS" and
+ * without warranty of any kind, express, implied or otherwise.
+ */
+
+#include "su_smile.h"
+#include <ciso646>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+const int max_depth = 200;
+
+// header flags
+const uint8_t kSharedNames = 0x01;
+const uint8_t kSharedValues = 0x02;
+const uint8_t kRawBinary = 0x04;
+
+// back-references tables are reset when full
+const int kMaxShared = 1024;
+
+// longest strings written in short form, and so shared
+const size_t kMaxShortAscii = 64;
+const size_t kMaxShortUnicode = 65;
+const size_t kMaxShortUnicodeName = 57;
+
+bool is_ascii( const std::string_view &i_value )
+{
+	for ( auto c : i_value )
+	{
+		if ( static_cast<uint8_t>( c ) >= 0x80 )
+			return false;
+	}
+	return true;
+}
+
+uint32_t zigzag( int32_t i_value )
+{
+	return ( static_cast<uint32_t>( i_value ) << 1 ) ^
+	       static_cast<uint32_t>( i_value >> 31 );
+}
+uint64_t zigzag( int64_t i_value )
+{
+	return ( static_cast<uint64_t>( i_value ) << 1 ) ^
+	       static_cast<uint64_t>( i_value >> 63 );
+}
+int64_t unzigzag( uint64_t i_value )
+{
+	return static_cast<int64_t>( i_value >> 1 ) ^
+	       -static_cast<int64_t>( i_value & 1 );
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Writing
+ */
+
+/* SharedTable
+ *
+ * Back-references of the writer: the strings seen so far, in order, and an
+ * open addressing index on them, both in flat arrays allocated once. The
+ * strings are views on the Json being written.
+ */
+class SharedTable
+{
+public:
+	SharedTable() : _strings( kMaxShared ), _slots( 2 * kMaxShared, -1 ) {}
+
+	// index of i_value if seen, -1 after adding it
+	int find_or_add( const std::string_view &i_value );
+
+private:
+	std::vector<std::string_view> _strings;
+	std::vector<int16_t> _slots;
+	int _count = 0;
+};
+
+int SharedTable::find_or_add( const std::string_view &i_value )
+{
+	const size_t mask = _slots.size() - 1;
+	size_t h = std::hash<std::string_view>()( i_value ) & mask;
+	while ( _slots[h] != -1 )
+	{
+		if ( _strings[_slots[h]] == i_value )
+			return _slots[h];
+		h = ( h + 1 ) & mask;
+	}
+	if ( _count == kMaxShared )
+	{
+		std::fill( _slots.begin(), _slots.end(), -1 );
+		_count = 0;
+		h = std::hash<std::string_view>()( i_value ) & mask;
+	}
+	_strings[_count] = i_value;
+	_slots[h] = static_cast<int16_t>( _count++ );
+	return -1;
+}
+
+class Writer
+{
+public:
+	Writer( std::vector<uint8_t> &o_buffer ) : _out( o_buffer ) {}
+
+	void write_header();
+	void write( const su::Json &i_json );
+
+private:
+	std::vector<uint8_t> &_out;
+	SharedTable _names;
+	SharedTable _values;
+
+	void put( uint8_t i_byte ) { _out.push_back( i_byte ); }
+	void put( const std::string_view &i_bytes )
+	{
+		_out.insert( _out.end(), i_bytes.begin(), i_bytes.end() );
+	}
+
+	void write_vint( uint64_t i_value );
+	void write_int( int64_t i_value );
+	void write_double( double i_value );
+	void write_string( const std::string_view &i_value );
+	void write_key( const std::string_view &i_key );
+};
+
+void Writer::write_header()
+{
+	put( ':' );
+	put( ')' );
+	put( '\n' );
+	put( kSharedNames | kSharedValues );
+}
+
+void Writer::write( const su::Json &i_json )
+{
+	switch ( i_json.type() )
+	{
+		case su::Json::Type::NUL:
+			put( 0x21 );
+			break;
+		case su::Json::Type::BOOL:
+			put( i_json.bool_value() ? 0x23 : 0x22 );
+			break;
+		case su::Json::Type::NUMBER:
+			if ( i_json.is_double() )
+				write_double( i_json.number_value() );
+			else
+				write_int( i_json.int64_value() );
+			break;
+		case su::Json::Type::STRING:
+			write_string( i_json.string_view() );
+			break;
+		case su::Json::Type::ARRAY:
+			put( 0xf8 );
+			for ( auto &it : i_json.array_items() )
+				write( it );
+			put( 0xf9 );
+			break;
+		case su::Json::Type::OBJECT:
+			put( 0xfa );
+			for ( auto &it : i_json.object_items() )
+			{
+				write_key( it.first );
+				write( it.second );
+			}
+			put( 0xfb );
+			break;
+	}
+}
+
+// 7 bits per byte, most significant first, the last byte has the high bit
+// set and only 6 bits
+void Writer::write_vint( uint64_t i_value )
+{
+	uint8_t buffer[11];
+	int pos = sizeof( buffer );
+	buffer[--pos] = static_cast<uint8_t>( 0x80 | ( i_value & 0x3f ) );
+	i_value >>= 6;
+	while ( i_value != 0 )
+	{
+		buffer[--pos] = static_cast<uint8_t>( i_value & 0x7f );
+		i_value >>= 7;
+	}
+	_out.insert( _out.end(), buffer + pos, buffer + sizeof( buffer ) );
+}
+
+void Writer::write_int( int64_t i_value )
+{
+	if ( i_value >= -16 and i_value <= 15 )
+		put( static_cast<uint8_t>( 0xc0 + zigzag( int32_t( i_value ) ) ) );
+	else if ( i_value >= std::numeric_limits<int32_t>::min() and
+	          i_value <= std::numeric_limits<int32_t>::max() )
+	{
+		put( 0x24 );
+		write_vint( zigzag( int32_t( i_value ) ) );
+	}
+	else
+	{
+		put( 0x25 );
+		write_vint( zigzag( i_value ) );
+	}
+}
+
+// float and double are sent as 7 bits bytes, most significant first
+void Writer::write_double( double i_value )
+{
+	float f = static_cast<float>( i_value );
+	if ( static_cast<double>( f ) == i_value )
+	{
+		uint32_t bits;
+		std::memcpy( &bits, &f, 4 );
+		put( 0x28 );
+		for ( int shift = 28; shift >= 0; shift -= 7 )
+			put( static_cast<uint8_t>( ( bits >> shift ) & 0x7f ) );
+	}
+	else
+	{
+		uint64_t bits;
+		std::memcpy( &bits, &i_value, 8 );
+		put( 0x29 );
+		for ( int shift = 63; shift >= 0; shift -= 7 )
+			put( static_cast<uint8_t>( ( bits >> shift ) & 0x7f ) );
+	}
+}
+
+void Writer::write_string( const std::string_view &i_value )
+{
+	auto size = i_value.size();
+	if ( size == 0 )
+	{
+		put( 0x20 );
+		return;
+	}
+	bool ascii = is_ascii( i_value );
+	if ( ( ascii and size <= kMaxShortAscii ) or
+	     ( not ascii and size >= 2 and size <= kMaxShortUnicode ) )
+	{
+		int ref = _values.find_or_add( i_value );
+		if ( ref >= 0 )
+		{
+			if ( ref < 31 )
+				put( static_cast<uint8_t>( ref + 1 ) );
+			else
+			{
+				put( static_cast<uint8_t>( 0xec | ( ref >> 8 ) ) );
+				put( static_cast<uint8_t>( ref & 0xff ) );
+			}
+			return;
+		}
+		if ( ascii )
+			put( static_cast<uint8_t>( size <= 32 ? 0x40 + ( size - 1 )
+			                                      : 0x60 + ( size - 33 ) ) );
+		else
+			put( static_cast<uint8_t>( size <= 33 ? 0x80 + ( size - 2 )
+			                                      : 0xa0 + ( size - 34 ) ) );
+		put( i_value );
+	}
+	else
+	{
+		put( ascii ? 0xe0 : 0xe4 );
+		put( i_value );
+		put( 0xfc );
+	}
+}
+
+void Writer::write_key( const std::string_view &i_key )
+{
+	auto size = i_key.size();
+	if ( size == 0 )
+	{
+		put( 0x20 );
+		return;
+	}
+	bool ascii = is_ascii( i_key );
+	if ( ( ascii and size <= kMaxShortAscii ) or
+	     ( not ascii and size >= 2 and size <= kMaxShortUnicodeName ) )
+	{
+		int ref = _names.find_or_add( i_key );
+		if ( ref >= 0 )
+		{
+			if ( ref < 64 )
+				put( static_cast<uint8_t>( 0x40 + ref ) );
+			else
+			{
+				put( static_cast<uint8_t>( 0x30 | ( ref >> 8 ) ) );
+				put( static_cast<uint8_t>( ref & 0xff ) );
+			}
+			return;
+		}
+		put( static_cast<uint8_t>( ascii ? 0x80 + ( size - 1 )
+		                                 : 0xc0 + ( size - 2 ) ) );
+		put( i_key );
+	}
+	else
+	{
+		put( 0x34 );
+		put( i_key );
+		put( 0xfc );
+	}
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Reading
+ */
+
+class Reader
+{
+public:
+	Reader( const uint8_t *i_data, size_t i_size, std::string &o_err ) :
+	    _ptr( i_data ),
+	    _end( i_data + i_size ),
+	    _err( o_err )
+	{
+	}
+
+	void read_header();
+	su::Json read( int i_depth );
+	bool at_end()
+	{
+		// optional end of content marker
+		if ( _ptr != _end and *_ptr == 0xff )
+			++_ptr;
+		return _ptr == _end;
+	}
+	bool failed() const { return _failed; }
+
+	su::Json fail( std::string &&i_msg )
+	{
+		if ( not _failed )
+			_err = std::move( i_msg );
+		_failed = true;
+		return su::Json();
+	}
+
+private:
+	const uint8_t *_ptr;
+	const uint8_t *_end;
+	std::string &_err;
+	bool _failed = false;
+	uint8_t _flags = kSharedNames;
+
+	// back-references, views on the input
+	std::string_view _names[kMaxShared];
+	std::string_view _values[kMaxShared];
+	int _nameCount = 0;
+	int _valueCount = 0;
+
+	bool has( size_t i_size )
+	{
+		if ( static_cast<size_t>( _end - _ptr ) >= i_size )
+			return true;
+		fail( "unexpected end of input" );
+		return false;
+	}
+	std::string_view bytes( size_t i_size )
+	{
+		std::string_view result( reinterpret_cast<const char *>( _ptr ),
+		                         i_size );
+		_ptr += i_size;
+		return result;
+	}
+	static void add( std::string_view *io_table,
+	                 int &io_count,
+	                 const std::string_view &i_value )
+	{
+		if ( io_count == kMaxShared )
+			io_count = 0;
+		io_table[io_count++] = i_value;
+	}
+
+	bool read_vint( uint64_t &o_value );
+	bool read_terminated( std::string_view &o_value );
+	bool read_reference( const std::string_view *i_table,
+	                     int i_count,
+	                     int i_index,
+	                     std::string_view &o_value );
+	su::Json read_bits( int i_count );
+	su::Json read_binary( bool i_raw );
+	su::Json read_array( int i_depth );
+	su::Json read_object( int i_depth );
+};
+
+void Reader::read_header()
+{
+	if ( _end - _ptr >= 4 and _ptr[0] == ':' and _ptr[1] == ')' and
+	     _ptr[2] == '\n' )
+	{
+		_flags = _ptr[3];
+		if ( ( _flags >> 4 ) != 0 )
+			fail( "unsupported smile version" );
+		_ptr += 4;
+	}
+}
+
+su::Json Reader::read( int i_depth )
+{
+	if ( i_depth > max_depth )
+		return fail( "exceeded maximum nesting depth" );
+	if ( not has( 1 ) )
+		return su::Json();
+
+	uint8_t b = *_ptr++;
+	std::string_view s;
+	if ( b < 0x20 )
+	{
+		if ( b == 0 or not read_reference( _values, _valueCount, b - 1, s ) )
+			return fail( "invalid shared string reference" );
+		return std::string( s );
+	}
+	if ( b >= 0x40 and b < 0xc0 )
+	{
+		size_t size = 0;
+		if ( b < 0x60 )
+			size = ( b & 0x1f ) + 1;
+		else if ( b < 0x80 )
+			size = ( b & 0x1f ) + 33;
+		else if ( b < 0xa0 )
+			size = ( b & 0x1f ) + 2;
+		else
+			size = ( b & 0x1f ) + 34;
+		if ( not has( size ) )
+			return su::Json();
+		s = bytes( size );
+		if ( _flags & kSharedValues )
+			add( _values, _valueCount, s );
+		return std::string( s );
+	}
+	if ( b >= 0xc0 and b < 0xe0 )
+		return int( unzigzag( b & 0x1f ) );
+
+	switch ( b )
+	{
+		case 0x20:
+			return std::string();
+		case 0x21:
+			return su::Json();
+		case 0x22:
+			return false;
+		case 0x23:
+			return true;
+		case 0x24:
+		case 0x25:
+		{
+			uint64_t v = 0;
+			if ( not read_vint( v ) )
+				return su::Json();
+			int64_t i = unzigzag( v );
+			if ( i >= std::numeric_limits<int32_t>::min() and
+			     i <= std::numeric_limits<int32_t>::max() )
+				return static_cast<int32_t>( i );
+			return i;
+		}
+		case 0x28:
+			return read_bits( 5 );
+		case 0x29:
+			return read_bits( 10 );
+		case 0xe0:
+		case 0xe4:
+			if ( not read_terminated( s ) )
+				return su::Json();
+			return std::string( s );
+		case 0xe8:
+			return read_binary( false );
+		case 0xec:
+		case 0xed:
+		case 0xee:
+		case 0xef:
+			if ( not has( 1 ) or
+			     not read_reference(
+			         _values, _valueCount, ( ( b & 0x03 ) << 8 ) | *_ptr++, s ) )
+				return fail( "invalid shared string reference" );
+			return std::string( s );
+		case 0xf8:
+			return read_array( i_depth );
+		case 0xfa:
+			return read_object( i_depth );
+		case 0xfd:
+			if ( not( _flags & kRawBinary ) )
+				return fail( "raw binary not enabled" );
+			return read_binary( true );
+		case 0x26:
+		case 0x2a:
+			return fail( "big numbers are not supported" );
+		default:
+			return fail( "invalid token " + std::to_string( b ) );
+	}
+}
+
+bool Reader::read_vint( uint64_t &o_value )
+{
+	o_value = 0;
+	for ( int i = 0; i < 10; ++i )
+	{
+		if ( not has( 1 ) )
+			return false;
+		uint8_t b = *_ptr++;
+		if ( b & 0x80 )
+		{
+			o_value = ( o_value << 6 ) | ( b & 0x3f );
+			return true;
+		}
+		o_value = ( o_value << 7 ) | b;
+	}
+	fail( "invalid variable length integer" );
+	return false;
+}
+
+bool Reader::read_terminated( std::string_view &o_value )
+{
+	auto marker = std::find( _ptr, _end, 0xfc );
+	if ( marker == _end )
+	{
+		fail( "unexpected end of input in string" );
+		return false;
+	}
+	o_value = bytes( marker - _ptr );
+	++_ptr;
+	return true;
+}
+
+bool Reader::read_reference( const std::string_view *i_table,
+                             int i_count,
+                             int i_index,
+                             std::string_view &o_value )
+{
+	if ( i_index >= i_count )
+		return false;
+	o_value = i_table[i_index];
+	return true;
+}
+
+// float (5) or double (10) from 7 bits bytes
+su::Json Reader::read_bits( int i_count )
+{
+	if ( not has( i_count ) )
+		return su::Json();
+	uint64_t bits = 0;
+	for ( int i = 0; i < i_count; ++i )
+		bits = ( bits << 7 ) | ( *_ptr++ & 0x7f );
+	if ( i_count == 5 )
+	{
+		float f;
+		auto b32 = static_cast<uint32_t>( bits );
+		std::memcpy( &f, &b32, 4 );
+		return static_cast<double>( f );
+	}
+	double d;
+	std::memcpy( &d, &bits, 8 );
+	return d;
+}
+
+su::Json Reader::read_binary( bool i_raw )
+{
+	uint64_t size = 0;
+	if ( not read_vint( size ) )
+		return su::Json();
+	if ( i_raw )
+	{
+		if ( not has( size ) )
+			return su::Json();
+		return std::string( bytes( size ) );
+	}
+
+	// 7 bytes in 8, then n bytes in n + 1
+	uint64_t encoded = size / 7 * 8 + ( size % 7 ? size % 7 + 1 : 0 );
+	if ( not has( encoded ) )
+		return su::Json();
+	std::string result;
+	result.reserve( size );
+	while ( size >= 7 )
+	{
+		uint64_t v = 0;
+		for ( int i = 0; i < 8; ++i )
+			v = ( v << 7 ) | ( *_ptr++ & 0x7f );
+		for ( int shift = 48; shift >= 0; shift -= 8 )
+			result.push_back( static_cast<char>( v >> shift ) );
+		size -= 7;
+	}
+	if ( size > 0 )
+	{
+		// the last byte holds the remaining bits, right aligned
+		uint64_t v = 0;
+		for ( uint64_t i = 0; i < size; ++i )
+			v = ( v << 7 ) | ( *_ptr++ & 0x7f );
+		v = ( v << size ) | ( *_ptr++ & 0x7f );
+		for ( int shift = int( size - 1 ) * 8; shift >= 0; shift -= 8 )
+			result.push_back( static_cast<char>( v >> shift ) );
+	}
+	return result;
+}
+
+su::Json Reader::read_array( int i_depth )
+{
+	su::Json::array items;
+	for ( ;; )
+	{
+		if ( not has( 1 ) )
+			return su::Json();
+		if ( *_ptr == 0xf9 )
+		{
+			++_ptr;
+			break;
+		}
+		items.push_back( read( i_depth + 1 ) );
+		if ( _failed )
+			return su::Json();
+	}
+	return items;
+}
+
+su::Json Reader::read_object( int i_depth )
+{
+	su::Json::object items;
+	for ( ;; )
+	{
+		if ( not has( 1 ) )
+			return su::Json();
+		uint8_t b = *_ptr++;
+		if ( b == 0xfb )
+			break;
+
+		std::string_view key;
+		if ( b == 0x20 )
+			;
+		else if ( b >= 0x30 and b <= 0x33 )
+		{
+			if ( not has( 1 ) or
+			     not read_reference(
+			         _names, _nameCount, ( ( b & 0x03 ) << 8 ) | *_ptr++, key ) )
+				return fail( "invalid shared name reference" );
+		}
+		else if ( b == 0x34 )
+		{
+			if ( not read_terminated( key ) )
+				return su::Json();
+		}
+		else if ( b >= 0x40 and b < 0x80 )
+		{
+			if ( not read_reference( _names, _nameCount, b & 0x3f, key ) )
+				return fail( "invalid shared name reference" );
+		}
+		else if ( b >= 0x80 and b < 0xf8 )
+		{
+			size_t size = b < 0xc0 ? ( b & 0x3f ) + 1 : ( b - 0xc0 ) + 2;
+			if ( not has( size ) )
+				return su::Json();
+			key = bytes( size );
+			if ( _flags & kSharedNames )
+				add( _names, _nameCount, key );
+		}
+		else
+			return fail( "invalid key token " + std::to_string( b ) );
+
+		auto value = read( i_depth + 1 );
+		if ( _failed )
+			return su::Json();
+		// keys are written sorted, append without searching
+		if ( items.empty() or items.storage().back().first < key )
+			items.storage().emplace_back( std::string( key ),
+			                              std::move( value ) );
+		else
+			items[std::string( key )] = std::move( value );
+	}
+	return items;
+}
+
+}
+
+namespace su {
+namespace smile {
+
+void write( const Json &i_json, std::vector<uint8_t> &o_buffer )
+{
+	o_buffer.clear();
+	Writer writer( o_buffer );
+	writer.write_header();
+	writer.write( i_json );
+}
+
+std::vector<uint8_t> write( const Json &i_json )
+{
+	std::vector<uint8_t> result;
+	write( i_json, result );
+	return result;
+}
+
+Json read( const uint8_t *i_data, size_t i_size, std::string &o_err )
+{
+	// the back-reference tables are large, keep them off the stack
+	auto reader = std::make_unique<Reader>( i_data, i_size, o_err );
+	reader->read_header();
+	auto result = reader->failed() ? Json() : reader->read( 0 );
+	if ( reader->failed() )
+		return Json();
+	if ( not reader->at_end() )
+		return reader->fail( "unexpected trailing data" );
+	return result;
+}
+
+Json read( const uint8_t *i_data, size_t i_size )
+{
+	std::string err;
+	return read( i_data, i_size, err );
+}
+
+}
+}
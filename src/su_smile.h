@@ -0,0 +1,47 @@
+/*
+ *  su_smile.h
+ *  sutils
+ *
+ *  Created by Sandy Martel on 2026/10/18.
+ *  Copyright (c) 2026年 Sandy Martel. All rights reserved.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software for any
+ * purpose is hereby granted without fee. The sotware is provided "AS-IS" and
+ * without warranty of any kind, express, implied or otherwise.
+ */
+
+#ifndef H_SU_SMILE
+#define H_SU_SMILE
+
+#include "su_json.h"
+#include <cstdint>
+#include <vector>
+
+namespace su {
+namespace smile {
+
+/*!
+   @brief Serialize to Smile,
+   https://github.com/FasterXML/smile-format-specification
+
+   Written with the header and with both shared property names and shared
+   string values: a repeated key or short string value is written as a one or
+   two bytes back-reference. Strings are expected to be valid UTF-8.
+   o_buffer is cleared first, its capacity is kept for re-use.
+*/
+void write( const Json &i_json, std::vector<uint8_t> &o_buffer );
+std::vector<uint8_t> write( const Json &i_json );
+
+/*!
+   @brief Deserialize Smile.
+
+   Binary data is read as a string, big integers and big decimals are not
+   supported. On error, return Json() and assign an error message to o_err.
+*/
+Json read( const uint8_t *i_data, size_t i_size, std::string &o_err );
+Json read( const uint8_t *i_data, size_t i_size );
+
+}
+}
+
+#endif
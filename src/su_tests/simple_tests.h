@@ -28,6 +28,16 @@
 
 namespace su {
 
+/*!
+	A measure reported by a test, besides its duration.
+*/
+struct TestMetric
+{
+	std::string name;
+	double value;
+	bool higherIsBetter; //!< for regression detection
+};
+
 /*!
 	Simple nanoseconds timer.
 */
@@ -48,9 +58,16 @@ public:
 	//! return the time elapsed, ending the timer if needed
 	std::int64_t nanoseconds();
 	
+	//! record a measure (throughput, allocations...), tracked like the
+	//! duration for timed tests, the last value of a repeated test is kept
+	void metric( const std::string_view &i_name, double i_value,
+					bool i_higherIsBetter = false );
+	const std::vector<TestMetric> &metrics() const { return _metrics; }
+	
 private:
 	std::chrono::high_resolution_clock::time_point _start{};
 	std::chrono::high_resolution_clock::time_point _end{};
+	std::vector<TestMetric> _metrics;
 };
 
 struct TestOptions
@@ -450,6 +467,8 @@ struct TestTimer
 	void start(){ assert( false ); }
 	void end(){ assert( false ); }
 	std::int64_t nanoseconds() { assert( false ); return 0; }
+	template<typename ...ARGS>
+	void metric( ARGS... args ){ assert( false ); }
 };
 
 namespace su {
@@ -16,6 +16,7 @@
 #include <algorithm>
 #include <map>
 #include <memory>
+#include <limits>
 #include <string.h>
 
 #if __has_include(<sqlite3.h>)
@@ -112,6 +113,13 @@ public:
 					int64_t i_duration );
 	int64_t mostRecentDuration( const std::string_view &i_testSuiteName,
 								const std::string_view &i_testName );
+	void addMetric( const std::string_view &i_testSuiteName,
+					const std::string_view &i_testName,
+					const su::TestMetric &i_metric );
+	//! NaN if never recorded
+	double mostRecentMetric( const std::string_view &i_testSuiteName,
+								const std::string_view &i_testName,
+								const std::string_view &i_metricName );
 
 private:
 	std::string _processName;
@@ -186,6 +194,14 @@ SimpleTestDB::SimpleTestDB( const std::string_view &i_processName )
 								"duration INT,"
 								"datetime TEXT"
 								");" );
+			sqlite3_exec( "CREATE TABLE IF NOT EXISTS test_metrics ("
+								"process_name TEXT,"
+								"test_suite TEXT,"
+								"test_case TEXT,"
+								"metric TEXT,"
+								"value REAL,"
+								"datetime TEXT"
+								");" );
 			auto result = sqlite3_exec( "SELECT datetime('now','utc');" );
 			if ( not result.empty() )
 				_datetime = result.begin()->second;
@@ -264,6 +280,67 @@ int64_t SimpleTestDB::mostRecentDuration( const std::string_view &i_testSuiteNam
 	return std::numeric_limits<int64_t>::max();
 }
 
+void SimpleTestDB::addMetric( const std::string_view &i_testSuiteName,
+								const std::string_view &i_testName,
+								const su::TestMetric &i_metric )
+{
+#ifdef HAS_SQLITE3
+	try
+	{
+		std::ostringstream value;
+		value.precision( 17 );
+		value << i_metric.value;
+		std::string cmd( "INSERT INTO test_metrics (process_name,test_suite,"
+							"test_case,metric,value,datetime) VALUES (" );
+		cmd += "'" + _processName + "','";
+		cmd += i_testSuiteName;
+		cmd += "','";
+		cmd += i_testName;
+		cmd += "','";
+		cmd += i_metric.name;
+		cmd += "',";
+		cmd += value.str() + ",";
+		cmd += "'" + _datetime;
+		cmd += "');";
+		sqlite3_exec( cmd );
+	}
+	catch ( std::exception &ex )
+	{
+		std::cerr << "ERROR: inserting in database failed: "
+					<< ex.what() << "\n";
+	}
+#endif
+}
+
+double SimpleTestDB::mostRecentMetric( const std::string_view &i_testSuiteName,
+										const std::string_view &i_testName,
+										const std::string_view &i_metricName )
+{
+#ifdef HAS_SQLITE3
+	try
+	{
+		std::string cmd( "SELECT value FROM test_metrics WHERE " );
+		cmd += "process_name='" + _processName + "' AND ";
+		cmd += "test_suite='";
+		cmd += i_testSuiteName;
+		cmd += "' AND test_case='";
+		cmd += i_testName;
+		cmd += "' AND metric='";
+		cmd += i_metricName;
+		cmd += "' ORDER BY datetime DESC LIMIT 1";
+		auto result = sqlite3_exec( cmd );
+		if ( not result.empty() )
+			return std::stod( result.begin()->second );
+	}
+	catch ( std::exception &ex )
+	{
+		std::cerr << "ERROR: reading database failed: "
+					<< ex.what() << "\n";
+	}
+#endif
+	return std::numeric_limits<double>::quiet_NaN();
+}
+
 }
 
 namespace su {
@@ -320,6 +397,21 @@ int64_t TestTimer::nanoseconds()
 	return duration_cast<std::chrono::nanoseconds>(_end - _start).count();
 }
 
+void TestTimer::metric( const std::string_view &i_name, double i_value,
+						bool i_higherIsBetter )
+{
+	for ( auto &it : _metrics )
+	{
+		if ( it.name == i_name )
+		{
+			it.value = i_value;
+			it.higherIsBetter = i_higherIsBetter;
+			return;
+		}
+	}
+	_metrics.push_back( TestMetric{ std::string( i_name ), i_value, i_higherIsBetter } );
+}
+
 }
 
 int main( int argc, char **argv )
@@ -436,6 +528,18 @@ int main( int argc, char **argv )
 						std::cout << styleTTY{ttyRed} << " regression: "
 										<< duration - prev << "ns slower"
 										<< styleTTY{};
+					for ( auto &metric : timer.metrics() )
+					{
+						auto prevValue = db->mostRecentMetric( testSuite->name(), test.name(), metric.name );
+						std::cout << ", " << metric.name << ": " << metric.value;
+						// metrics are flagged beyond 5%
+						bool worse = metric.higherIsBetter ? metric.value < prevValue * 0.95 :
+																metric.value > prevValue * 1.05;
+						if ( worse )
+							std::cout << styleTTY{ttyRed} << " regression: was "
+										<< prevValue << styleTTY{};
+						db->addMetric( testSuite->name(), test.name(), metric );
+					}
 					std::cout << ")";
 				}
 			}
@@ -0,0 +1,648 @@
+/*
+ *  su_ubjson.cpp
+ *  sutils
+ *
+ *  Created by Sandy Martel on 2026/10/18.
+ *  Copyright (c) 2026年 Sandy Martel. All rights reserved.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software for any
+ * purpose is hereby granted without fee. The sotware is provided "AS-IS" and
+ * without warranty of any kind, express, implied or otherwise.
+ */
+
+#include "su_ubjson.h"
+#include "su_endian.h"
+#include <ciso646>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const int max_depth = 200;
+
+char int_marker( int64_t i_min, int64_t i_max )
+{
+	if ( i_min >= 0 and i_max <= std::numeric_limits<uint8_t>::max() )
+		return 'U';
+	if ( i_min >= std::numeric_limits<int8_t>::min() and
+	     i_max <= std::numeric_limits<int8_t>::max() )
+		return 'i';
+	if ( i_min >= std::numeric_limits<int16_t>::min() and
+	     i_max <= std::numeric_limits<int16_t>::max() )
+		return 'I';
+	if ( i_min >= std::numeric_limits<int32_t>::min() and
+	     i_max <= std::numeric_limits<int32_t>::max() )
+		return 'l';
+	return 'L';
+}
+
+bool is_float( double i_value )
+{
+	return static_cast<double>( static_cast<float>( i_value ) ) == i_value;
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Writing
+ */
+
+class Writer
+{
+public:
+	Writer( std::vector<uint8_t> &o_buffer ) : _out( o_buffer ) {}
+
+	void write( const su::Json &i_json );
+
+private:
+	std::vector<uint8_t> &_out;
+
+	void put( uint8_t i_byte ) { _out.push_back( i_byte ); }
+	template<typename T>
+	void put_big( T i_value )
+	{
+		i_value = su::native_to_big( i_value );
+		auto pos = _out.size();
+		_out.resize( pos + sizeof( T ) );
+		std::memcpy( _out.data() + pos, &i_value, sizeof( T ) );
+	}
+
+	char marker( const su::Json &i_json ) const;
+	template<typename C>
+	char container_marker( const C &i_items ) const;
+	void payload( char i_marker, const su::Json &i_json );
+	void write_int( char i_marker, int64_t i_value );
+	void write_length( size_t i_size );
+	void write_string( const std::string_view &i_value );
+	template<typename C>
+	void write_header( const C &i_items );
+};
+
+void Writer::write( const su::Json &i_json )
+{
+	char m = marker( i_json );
+	put( m );
+	payload( m, i_json );
+}
+
+char Writer::marker( const su::Json &i_json ) const
+{
+	switch ( i_json.type() )
+	{
+		case su::Json::Type::NUL:
+			return 'Z';
+		case su::Json::Type::BOOL:
+			return i_json.bool_value() ? 'T' : 'F';
+		case su::Json::Type::NUMBER:
+			if ( i_json.is_double() )
+				return is_float( i_json.number_value() ) ? 'd' : 'D';
+			return int_marker( i_json.int64_value(), i_json.int64_value() );
+		case su::Json::Type::STRING:
+		{
+			const auto &s = i_json.string_view();
+			return s.size() == 1 and static_cast<uint8_t>( s[0] ) < 0x80
+			           ? 'C'
+			           : 'S';
+		}
+		case su::Json::Type::ARRAY:
+			return '[';
+		case su::Json::Type::OBJECT:
+			return '{';
+	}
+	return 'Z';
+}
+
+// the type shared by all items if they are all numbers of the same kind, or
+// all strings, 0 otherwise
+template<typename C>
+char Writer::container_marker( const C &i_items ) const
+{
+	if ( i_items.size() < 2 )
+		return 0;
+
+	auto value = []( const auto &it ) -> const su::Json & {
+		if constexpr ( std::is_same_v<C, su::Json::object> )
+			return it.second;
+		else
+			return it;
+	};
+
+	const su::Json &first = value( *i_items.begin() );
+	if ( first.is_string() )
+	{
+		for ( auto &it : i_items )
+		{
+			if ( not value( it ).is_string() )
+				return 0;
+		}
+		return 'S';
+	}
+	if ( not first.is_number() )
+		return 0;
+	if ( first.is_double() )
+	{
+		bool allFloat = true;
+		for ( auto &it : i_items )
+		{
+			const su::Json &v = value( it );
+			if ( not v.is_double() )
+				return 0;
+			allFloat = allFloat and is_float( v.number_value() );
+		}
+		return allFloat ? 'd' : 'D';
+	}
+	int64_t minValue = std::numeric_limits<int64_t>::max();
+	int64_t maxValue = std::numeric_limits<int64_t>::min();
+	for ( auto &it : i_items )
+	{
+		const su::Json &v = value( it );
+		if ( not v.is_number() or v.is_double() )
+			return 0;
+		auto i = v.int64_value();
+		minValue = std::min( minValue, i );
+		maxValue = std::max( maxValue, i );
+	}
+	return int_marker( minValue, maxValue );
+}
+
+void Writer::payload( char i_marker, const su::Json &i_json )
+{
+	switch ( i_marker )
+	{
+		case 'U':
+		case 'i':
+		case 'I':
+		case 'l':
+		case 'L':
+			write_int( i_marker, i_json.int64_value() );
+			break;
+		case 'd':
+			put_big( static_cast<float>( i_json.number_value() ) );
+			break;
+		case 'D':
+			put_big( i_json.number_value() );
+			break;
+		case 'C':
+			put( static_cast<uint8_t>( i_json.string_view()[0] ) );
+			break;
+		case 'S':
+			write_string( i_json.string_view() );
+			break;
+		case '[':
+		{
+			const auto &items = i_json.array_items();
+			write_header( items );
+			if ( char m = container_marker( items ) )
+			{
+				for ( auto &it : items )
+					payload( m, it );
+			}
+			else
+			{
+				for ( auto &it : items )
+					write( it );
+			}
+			break;
+		}
+		case '{':
+		{
+			const auto &items = i_json.object_items();
+			write_header( items );
+			char m = container_marker( items );
+			for ( auto &it : items )
+			{
+				write_string( it.first );
+				if ( m )
+					payload( m, it.second );
+				else
+					write( it.second );
+			}
+			break;
+		}
+	}
+}
+
+void Writer::write_int( char i_marker, int64_t i_value )
+{
+	switch ( i_marker )
+	{
+		case 'U':
+			put( static_cast<uint8_t>( i_value ) );
+			break;
+		case 'i':
+			put( static_cast<uint8_t>( static_cast<int8_t>( i_value ) ) );
+			break;
+		case 'I':
+			put_big( static_cast<int16_t>( i_value ) );
+			break;
+		case 'l':
+			put_big( static_cast<int32_t>( i_value ) );
+			break;
+		default:
+			put_big( i_value );
+			break;
+	}
+}
+
+void Writer::write_length( size_t i_size )
+{
+	char m = int_marker( 0, static_cast<int64_t>( i_size ) );
+	put( m );
+	write_int( m, static_cast<int64_t>( i_size ) );
+}
+
+void Writer::write_string( const std::string_view &i_value )
+{
+	write_length( i_value.size() );
+	_out.insert( _out.end(), i_value.begin(), i_value.end() );
+}
+
+template<typename C>
+void Writer::write_header( const C &i_items )
+{
+	if ( char m = container_marker( i_items ) )
+	{
+		put( '$' );
+		put( m );
+	}
+	put( '#' );
+	write_length( i_items.size() );
+}
+
+/* * * * * * * * * * * * * * * * * * * *
+ * Reading
+ */
+
+class Reader
+{
+public:
+	Reader( const uint8_t *i_data,
+	        size_t i_size,
+	        std::string &o_err,
+	        size_t i_maxItems ) :
+	    _ptr( i_data ),
+	    _end( i_data + i_size ),
+	    _err( o_err ),
+	    _maxItems( i_maxItems )
+	{
+	}
+
+	su::Json read( int i_depth );
+	bool at_end() const { return _ptr == _end; }
+	bool failed() const { return _failed; }
+
+	su::Json fail( std::string &&i_msg )
+	{
+		if ( not _failed )
+			_err = std::move( i_msg );
+		_failed = true;
+		return su::Json();
+	}
+
+private:
+	const uint8_t *_ptr;
+	const uint8_t *_end;
+	std::string &_err;
+	size_t _maxItems;
+	bool _failed = false;
+
+	bool has( size_t i_size )
+	{
+		if ( static_cast<size_t>( _end - _ptr ) >= i_size )
+			return true;
+		fail( "unexpected end of input" );
+		return false;
+	}
+	template<typename T>
+	T get()
+	{
+		T v;
+		std::memcpy( &v, _ptr, sizeof( T ) );
+		_ptr += sizeof( T );
+		return su::big_to_native( v );
+	}
+	char next_marker()
+	{
+		// skip no-op
+		while ( _ptr != _end and *_ptr == 'N' )
+			++_ptr;
+		return has( 1 ) ? static_cast<char>( *_ptr++ ) : 0;
+	}
+
+	su::Json read_value( char i_marker, int i_depth );
+	bool read_int( char i_marker, int64_t &o_value );
+	bool read_length( size_t &o_size );
+	bool read_string( std::string &o_value );
+	bool read_header( char &o_type, size_t &o_count );
+	template<typename T>
+	void read_packed( size_t i_count, su::Json::array &o_items );
+	su::Json read_array( int i_depth );
+	su::Json read_object( int i_depth );
+};
+
+su::Json Reader::read( int i_depth )
+{
+	char m = next_marker();
+	return _failed ? su::Json() : read_value( m, i_depth );
+}
+
+su::Json Reader::read_value( char i_marker, int i_depth )
+{
+	if ( i_depth > max_depth )
+		return fail( "exceeded maximum nesting depth" );
+
+	switch ( i_marker )
+	{
+		case 'Z':
+			return su::Json();
+		case 'T':
+			return true;
+		case 'F':
+			return false;
+		case 'U':
+		case 'i':
+		case 'I':
+		case 'l':
+		case 'L':
+		{
+			int64_t v = 0;
+			if ( not read_int( i_marker, v ) )
+				return su::Json();
+			if ( v >= std::numeric_limits<int32_t>::min() and
+			     v <= std::numeric_limits<int32_t>::max() )
+				return static_cast<int32_t>( v );
+			return v;
+		}
+		case 'd':
+			return has( 4 ) ? su::Json( static_cast<double>( get<float>() ) )
+			                : su::Json();
+		case 'D':
+			return has( 8 ) ? su::Json( get<double>() ) : su::Json();
+		case 'C':
+			return has( 1 ) ? su::Json( std::string( 1, char( *_ptr++ ) ) )
+			                : su::Json();
+		case 'S':
+		{
+			std::string s;
+			return read_string( s ) ? su::Json( std::move( s ) ) : su::Json();
+		}
+		case 'H':
+		{
+			std::string s, err;
+			if ( not read_string( s ) )
+				return su::Json();
+			auto number = su::Json::parse( s, err );
+			if ( not number.is_number() )
+				return fail( "invalid high-precision number" );
+			return number;
+		}
+		case '[':
+			return read_array( i_depth );
+		case '{':
+			return read_object( i_depth );
+		default:
+			return fail( "invalid type marker '" + std::string( 1, i_marker ) +
+			             "'" );
+	}
+}
+
+bool Reader::read_int( char i_marker, int64_t &o_value )
+{
+	switch ( i_marker )
+	{
+		case 'U':
+			if ( not has( 1 ) )
+				return false;
+			o_value = get<uint8_t>();
+			return true;
+		case 'i':
+			if ( not has( 1 ) )
+				return false;
+			o_value = get<int8_t>();
+			return true;
+		case 'I':
+			if ( not has( 2 ) )
+				return false;
+			o_value = get<int16_t>();
+			return true;
+		case 'l':
+			if ( not has( 4 ) )
+				return false;
+			o_value = get<int32_t>();
+			return true;
+		case 'L':
+			if ( not has( 8 ) )
+				return false;
+			o_value = get<int64_t>();
+			return true;
+	}
+	fail( "expected an integer type marker" );
+	return false;
+}
+
+bool Reader::read_length( size_t &o_size )
+{
+	int64_t v = 0;
+	if ( not read_int( next_marker(), v ) )
+		return false;
+	if ( v < 0 )
+	{
+		fail( "negative length" );
+		return false;
+	}
+	o_size = static_cast<size_t>( v );
+	return true;
+}
+
+bool Reader::read_string( std::string &o_value )
+{
+	size_t size = 0;
+	if ( not read_length( size ) or not has( size ) )
+		return false;
+	o_value.assign( reinterpret_cast<const char *>( _ptr ), size );
+	_ptr += size;
+	return true;
+}
+
+// optional $type and #count after [ or {, o_count is npos if not counted
+bool Reader::read_header( char &o_type, size_t &o_count )
+{
+	o_type = 0;
+	o_count = std::string::npos;
+	if ( _ptr != _end and *_ptr == '$' )
+	{
+		++_ptr;
+		if ( not has( 2 ) )
+			return false;
+		o_type = static_cast<char>( *_ptr++ );
+		if ( *_ptr != '#' )
+		{
+			fail( "expected '#' after container type" );
+			return false;
+		}
+	}
+	if ( _ptr != _end and *_ptr == '#' )
+	{
+		++_ptr;
+		if ( not read_length( o_count ) )
+			return false;
+		if ( o_count > _maxItems )
+		{
+			fail( "container count " + std::to_string( o_count ) +
+			      " over the limit of " + std::to_string( _maxItems ) );
+			return false;
+		}
+	}
+	return true;
+}
+
+// untagged numbers, back to back
+template<typename T>
+void Reader::read_packed( size_t i_count, su::Json::array &o_items )
+{
+	if ( i_count > static_cast<size_t>( _end - _ptr ) / sizeof( T ) )
+	{
+		fail( "unexpected end of input" );
+		return;
+	}
+	o_items.reserve( i_count );
+	for ( size_t i = 0; i < i_count; ++i )
+	{
+		if constexpr ( std::is_floating_point_v<T> )
+			o_items.emplace_back( static_cast<double>( get<T>() ) );
+		else
+			o_items.emplace_back( static_cast<int32_t>( get<T>() ) );
+	}
+}
+
+su::Json Reader::read_array( int i_depth )
+{
+	char type;
+	size_t count;
+	if ( not read_header( type, count ) )
+		return su::Json();
+
+	su::Json::array items;
+	if ( count != std::string::npos )
+	{
+		switch ( type )
+		{
+			case 'U':
+				read_packed<uint8_t>( count, items );
+				break;
+			case 'i':
+				read_packed<int8_t>( count, items );
+				break;
+			case 'I':
+				read_packed<int16_t>( count, items );
+				break;
+			case 'l':
+				read_packed<int32_t>( count, items );
+				break;
+			case 'd':
+				read_packed<float>( count, items );
+				break;
+			case 'D':
+				read_packed<double>( count, items );
+				break;
+			default:
+				// every item takes at least one byte, unless typed
+				if ( type == 0 )
+					items.reserve(
+					    std::min<size_t>( count, _end - _ptr ) );
+				for ( size_t i = 0; i < count and not _failed; ++i )
+				{
+					items.push_back( read_value(
+					    type ? type : next_marker(), i_depth + 1 ) );
+				}
+				break;
+		}
+	}
+	else
+	{
+		for ( ;; )
+		{
+			char m = next_marker();
+			if ( _failed or m == ']' )
+				break;
+			items.push_back( read_value( m, i_depth + 1 ) );
+		}
+	}
+	return _failed ? su::Json() : su::Json( std::move( items ) );
+}
+
+su::Json Reader::read_object( int i_depth )
+{
+	char type;
+	size_t count;
+	if ( not read_header( type, count ) )
+		return su::Json();
+
+	su::Json::object items;
+	if ( count != std::string::npos and type == 0 )
+		items.reserve( std::min<size_t>( count, ( _end - _ptr ) / 2 ) );
+	std::string key;
+	for ( size_t i = 0; i < count and not _failed; ++i )
+	{
+		if ( count == std::string::npos )
+		{
+			while ( _ptr != _end and *_ptr == 'N' )
+				++_ptr;
+			if ( _ptr != _end and *_ptr == '}' )
+			{
+				++_ptr;
+				break;
+			}
+		}
+		if ( not read_string( key ) )
+			break;
+		auto value =
+		    read_value( type ? type : next_marker(), i_depth + 1 );
+		// keys are written sorted, append without searching
+		if ( items.empty() or items.storage().back().first < key )
+			items.storage().emplace_back( std::move( key ), std::move( value ) );
+		else
+			items[std::move( key )] = std::move( value );
+	}
+	return _failed ? su::Json() : su::Json( std::move( items ) );
+}
+
+}
+
+namespace su {
+namespace ubjson {
+
+void write( const Json &i_json, std::vector<uint8_t> &o_buffer )
+{
+	o_buffer.clear();
+	Writer writer( o_buffer );
+	writer.write( i_json );
+}
+
+std::vector<uint8_t> write( const Json &i_json )
+{
+	std::vector<uint8_t> result;
+	write( i_json, result );
+	return result;
+}
+
+Json read( const uint8_t *i_data,
+           size_t i_size,
+           std::string &o_err,
+           size_t i_maxItems )
+{
+	Reader reader( i_data, i_size, o_err, i_maxItems );
+	auto result = reader.read( 0 );
+	if ( reader.failed() )
+		return Json();
+	if ( not reader.at_end() )
+		return reader.fail( "unexpected trailing data" );
+	return result;
+}
+
+Json read( const uint8_t *i_data, size_t i_size )
+{
+	std::string err;
+	return read( i_data, i_size, err );
+}
+
+}
+}
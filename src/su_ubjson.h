@@ -0,0 +1,54 @@
+/*
+ *  su_ubjson.h
+ *  sutils
+ *
+ *  Created by Sandy Martel on 2026/10/18.
+ *  Copyright (c) 2026年 Sandy Martel. All rights reserved.
+ *
+ * Permission to use, copy, modify, distribute, and sell this software for any
+ * purpose is hereby granted without fee. The sotware is provided "AS-IS" and
+ * without warranty of any kind, express, implied or otherwise.
+ */
+
+#ifndef H_SU_UBJSON
+#define H_SU_UBJSON
+
+#include "su_json.h"
+#include <cstdint>
+#include <vector>
+
+namespace su {
+namespace ubjson {
+
+/*!
+   @brief Serialize to Universal Binary JSON, http://ubjson.org
+
+   Containers are always written with a count (#). When all the values of a
+   container share a numeric or string type, the type is written once ($) and
+   the values follow untagged, numbers packed back to back.
+   o_buffer is cleared first, its capacity is kept for re-use.
+*/
+void write( const Json &i_json, std::vector<uint8_t> &o_buffer );
+std::vector<uint8_t> write( const Json &i_json );
+
+//! default limit on the count of a container, see read()
+constexpr size_t kMaxItems = size_t( 1 ) << 24;
+
+/*!
+   @brief Deserialize Universal Binary JSON.
+
+   Accepts all containers forms, optimized or not. On error, return Json()
+   and assign an error message to o_err. A container counted (#) with more
+   than i_maxItems items is an error: null and boolean items take no bytes
+   once typed ($), their count is the only bound on memory.
+*/
+Json read( const uint8_t *i_data,
+           size_t i_size,
+           std::string &o_err,
+           size_t i_maxItems = kMaxItems );
+Json read( const uint8_t *i_data, size_t i_size );
+
+}
+}
+
+#endif
@@ -19,6 +19,11 @@
 
 #include "su_tests/simple_tests.h"
 #include "su_json.h"
+#include "su_bson.h"
+#include "su_flatjson.h"
+#include "su_messagepack.h"
+#include "su_smile.h"
+#include "su_ubjson.h"
 #include "su_resource_access.h"
 #include <iostream>
 
@@ -77,50 +82,306 @@ binary_json_tests::binary_json_tests()
 
 void binary_json_tests::test_case_bson()
 {
-	// TEST_ASSERT( not kCanada.is_null() );
-	// auto data = su::bson::write( kCanada );
-	// std::cout << data.size() << std::endl;
-	// TEST_ASSERT( not data.empty() );
-	// auto other = su::bson::read( { data.data(), data.size() } );
-	// TEST_ASSERT_EQUAL( kCanada, other );
+	std::string data;
+	for ( auto &json : { kCanada, kCITM, kTwitter } )
+	{
+		TEST_ASSERT( not json.is_null() );
+		su::bson::write( json, data );
+		TEST_ASSERT( not data.empty() );
+		auto other = su::bson::read( { data.data(), data.size() } );
+		TEST_ASSERT_EQUAL( json, other );
+	}
+
+	// example from bsonspec.org
+	su::bson::write( su::Json::object{ { "hello", "world" } }, data );
+	TEST_ASSERT_EQUAL( data, std::string( "\x16\0\0\0\x02hello\0\x06\0\0\0world\0\0", 22 ) );
+	TEST_ASSERT( su::bson::write( su::Json::array{ 1 } ).empty() );
+
+	// lookup by path
+	su::bson::write( kTwitter, data );
+	TEST_ASSERT_EQUAL( su::bson::find( data, "statuses.3.user" ), kTwitter["statuses"][3]["user"] );
+	TEST_ASSERT_EQUAL( su::bson::find( data, "search_metadata.count" ).int_value(), 100 );
+	TEST_ASSERT( su::bson::find( data, "statuses.100" ).is_null() );
+	TEST_ASSERT( su::bson::find( data, "statuses.3.user.id.x" ).is_null() );
+	TEST_ASSERT( su::bson::find( data.substr( 0, 1000 ), "search_metadata" ).is_null() );
+
+	// other element types
+	const char other[] = "\x3c\0\0\0"
+		"\x07id\0\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\xff"
+		"\x05" "b\0\x02\0\0\0\0xy"
+		"\x09" "d\0\x01\0\0\0\0\0\0\x01"
+		"\x0An\0"
+		"\x04" "a\0\x0c\0\0\0\x10" "0\0\x07\0\0\0\0"
+		"\0";
+	auto json = su::bson::read( { other, sizeof( other ) - 1 } );
+	TEST_ASSERT_EQUAL( json.dump(), R"({"a":[7],"b":"xy","d":72057594037927937,"id":"0102030405060708090a0bff","n":null})" );
+
+	std::string err;
+	TEST_ASSERT( su::bson::read( { data.data(), data.size() - 1 }, err ).is_null() );
+	TEST_ASSERT_EQUAL( err, "unexpected end of input" );
+	const char decimal[] = "\x18\0\0\0\x13x\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0";
+	TEST_ASSERT( su::bson::read( { decimal, sizeof( decimal ) - 1 }, err ).is_null() );
+	TEST_ASSERT_EQUAL( err, "unsupported element type 19" );
 }
 
 void binary_json_tests::test_case_ubjson()
 {
-	// TEST_ASSERT( not kCanada.is_null() );
-	// auto data = su::ubjson::write( kCanada );
-	// std::cout << data.size() << std::endl;
-	// TEST_ASSERT( not data.empty() );
-	// auto other = su::ubjson::read( data.data(), data.size() );
-	// TEST_ASSERT_EQUAL( kCanada, other );
+	std::vector<uint8_t> data;
+	for ( auto &json : { kCanada, kCITM, kTwitter } )
+	{
+		TEST_ASSERT( not json.is_null() );
+		su::ubjson::write( json, data );
+		TEST_ASSERT( not data.empty() );
+		auto other = su::ubjson::read( data.data(), data.size() );
+		TEST_ASSERT_EQUAL( json, other );
+	}
+
+	// packed numbers
+	su::Json values = su::Json::array{ 0.1, -2.5 };
+	su::ubjson::write( values, data );
+	const uint8_t packed[] = { '[', '$', 'D', '#', 'U', 2, 0x3f, 0xb9, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a,
+		0xc0, 0x04, 0, 0, 0, 0, 0, 0 };
+	TEST_ASSERT( data == std::vector<uint8_t>( std::begin( packed ), std::end( packed ) ) );
+	values = su::Json::object{ { "a", 1 }, { "b", -300 }, { "c", 200 } };
+	su::ubjson::write( values, data );
+	const uint8_t ints[] = { '{', '$', 'I', '#', 'U', 3, 'U', 1, 'a', 0, 1, 'U', 1, 'b', 0xfe, 0xd4, 'U', 1, 'c', 0, 200 };
+	TEST_ASSERT( data == std::vector<uint8_t>( std::begin( ints ), std::end( ints ) ) );
+	TEST_ASSERT_EQUAL( su::ubjson::read( data.data(), data.size() ), values );
+
+	// not optimized, with no-ops, char and high precision
+	const char other[] = "[N{U\x01" "bSU\x02" "xyU\x01" "aC!}NTZHU\x04" "-1e2]";
+	auto json = su::ubjson::read( reinterpret_cast<const uint8_t *>( other ), sizeof( other ) - 1 );
+	TEST_ASSERT_EQUAL( json.dump(), R"([{"a":"!","b":"xy"},true,null,-100.0])" );
+
+	std::string err;
+	TEST_ASSERT( su::ubjson::read( data.data(), data.size() - 1, err ).is_null() );
+	TEST_ASSERT_EQUAL( err, "unexpected end of input" );
+	const uint8_t badType[] = { '[', '$', 'D', 'U' };
+	TEST_ASSERT( su::ubjson::read( badType, sizeof( badType ), err ).is_null() );
+	TEST_ASSERT_EQUAL( err, "expected '#' after container type" );
+
+	// typed nulls take no bytes, only the count limit stops them
+	const uint8_t nulls[] = { '[', '$', 'Z', '#', 'L', 0, 0, 0, 0x10, 0, 0, 0, 0 };
+	err.clear();
+	TEST_ASSERT( su::ubjson::read( nulls, sizeof( nulls ), err ).is_null() );
+	TEST_ASSERT( not err.empty() );
+	const uint8_t trues[] = { '[', '$', 'T', '#', 'U', 3 };
+	TEST_ASSERT_EQUAL( su::ubjson::read( trues, sizeof( trues ), err ).dump(),
+	                   "[true,true,true]" );
+	err.clear();
+	TEST_ASSERT( su::ubjson::read( trues, sizeof( trues ), err, 2 ).is_null() );
+	TEST_ASSERT( not err.empty() );
 }
 
 void binary_json_tests::test_case_smile()
 {
-	// TEST_ASSERT( not kCanada.is_null() );
-	// auto data = su::smile::write( kCanada );
-	// std::cout << data.size() << std::endl;
-	// TEST_ASSERT( not data.empty() );
-	// auto other = su::smile::read( data.data(), data.size() );
-	// TEST_ASSERT_EQUAL( kCanada, other );
+	std::vector<uint8_t> data;
+	for ( auto &json : { kCanada, kCITM, kTwitter } )
+	{
+		TEST_ASSERT( not json.is_null() );
+		su::smile::write( json, data );
+		TEST_ASSERT( not data.empty() );
+		auto other = su::smile::read( data.data(), data.size() );
+		TEST_ASSERT_EQUAL( json, other );
+	}
+
+	// shared names and values
+	su::Json values = su::Json::array{ su::Json::object{ { "a", "xy" }, { "b", -1 } },
+		su::Json::object{ { "a", "xy" }, { "b", 300 } }, 0.5, "" };
+	su::smile::write( values, data );
+	const uint8_t expected[] = { ':', ')', '\n', 0x03, 0xf8,
+		0xfa, 0x80, 'a', 0x41, 'x', 'y', 0x80, 'b', 0xc1, 0xfb,
+		0xfa, 0x40, 0x01, 0x41, 0x24, 0x09, 0x98, 0xfb,
+		0x28, 0x03, 0x78, 0x00, 0x00, 0x00, 0x20, 0xf9 };
+	TEST_ASSERT( data == std::vector<uint8_t>( std::begin( expected ), std::end( expected ) ) );
+
+	// long references and tables reset
+	su::Json::array items;
+	for ( int i = 0; i < 3000; ++i )
+	{
+		auto s = std::to_string( i % 1500 );
+		items.push_back( su::Json::object{ { "k" + s, s }, { "é" + s, "é" + s } } );
+	}
+	su::smile::write( items, data );
+	TEST_ASSERT_EQUAL( su::smile::read( data.data(), data.size() ), su::Json( items ) );
+
+	// 7 bits binary, from the spec
+	const uint8_t binary[] = { 0xe8, 0x88, 0x00, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01, 0x7f, 0x01 };
+	auto json = su::smile::read( binary, sizeof( binary ) );
+	TEST_ASSERT_EQUAL( json.string_value(), std::string( "\x01\x01\x01\x01\x01\x01\x01\xff", 8 ) );
+
+	std::string err;
+	TEST_ASSERT( su::smile::read( data.data(), data.size() - 1, err ).is_null() );
+	TEST_ASSERT_EQUAL( err, "unexpected end of input" );
+	const uint8_t badRef[] = { 0xfa, 0x41, 0x21, 0xfb };
+	TEST_ASSERT( su::smile::read( badRef, sizeof( badRef ), err ).is_null() );
+	TEST_ASSERT_EQUAL( err, "invalid shared name reference" );
 }
 
 void binary_json_tests::test_case_messagepack()
 {
-	// TEST_ASSERT( not kCanada.is_null() );
-	// auto data = su::messagepack::write( kCanada );
-	// std::cout << data.size() << std::endl;
-	// TEST_ASSERT( not data.empty() );
-	// auto other = su::messagepack::read( data.data(), data.size() );
-	// TEST_ASSERT_EQUAL( kCanada, other );
+	std::vector<uint8_t> data;
+	for ( auto &json : { kCanada, kCITM, kTwitter } )
+	{
+		TEST_ASSERT( not json.is_null() );
+		su::messagepack::write( json, data );
+		TEST_ASSERT( not data.empty() );
+		auto other = su::messagepack::read( data.data(), data.size() );
+		TEST_ASSERT_EQUAL( json, other );
+	}
+
+	// encodings from the spec
+	su::Json values = su::Json::array{ nullptr, true, -1, -33, 127, 128, 65536, int64_t( -5000000000 ), 0.5, 0.1, "abc" };
+	su::messagepack::write( values, data );
+	const uint8_t expected[] = { 0x9b, 0xc0, 0xc3, 0xff, 0xd0, 0xdf, 0x7f, 0xcc, 0x80, 0xce, 0x00, 0x01, 0x00, 0x00,
+		0xd3, 0xff, 0xff, 0xff, 0xfe, 0xd5, 0xfa, 0x0e, 0x00, 0xca, 0x3f, 0x00, 0x00, 0x00,
+		0xcb, 0x3f, 0xb9, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a, 0xa3, 'a', 'b', 'c' };
+	TEST_ASSERT( data == std::vector<uint8_t>( std::begin( expected ), std::end( expected ) ) );
+	TEST_ASSERT_EQUAL( su::messagepack::read( data.data(), data.size() ), values );
+
+	// unsorted keys, bin and uint64
+	const uint8_t other[] = { 0x83, 0xa1, 'b', 0x01, 0xa1, 'a', 0xc4, 0x02, 'x', 'y', 0xa1, 'b', 0xcf, 0xff, 0, 0, 0, 0, 0, 0, 0 };
+	auto json = su::messagepack::read( other, sizeof( other ) );
+	TEST_ASSERT_EQUAL( json.object_items().size(), 2 );
+	TEST_ASSERT_EQUAL( json["a"].string_value(), "xy" );
+	TEST_ASSERT( json["b"].is_double() );
+
+	std::string err;
+	TEST_ASSERT( su::messagepack::read( data.data(), data.size() - 1, err ).is_null() );
+	TEST_ASSERT_EQUAL( err, "unexpected end of input" );
+	const uint8_t badKey[] = { 0x81, 0x01, 0x02 };
+	TEST_ASSERT( su::messagepack::read( badKey, sizeof( badKey ), err ).is_null() );
+	TEST_ASSERT_EQUAL( err, "map key is not a string" );
 }
 
 void binary_json_tests::test_case_flat()
 {
-	// TEST_ASSERT( not kCanada.is_null() );
-	// auto data = su::flat::write( kCanada );
-	// std::cout << data.size() << std::endl;
-	// TEST_ASSERT( not data.empty() );
-	// auto other = su::flat::read( data.data(), data.size() );
-	// TEST_ASSERT_EQUAL( kCanada, other );
+	std::vector<uint8_t> data;
+	for ( auto &json : { kCanada, kCITM, kTwitter } )
+	{
+		TEST_ASSERT( not json.is_null() );
+		su::flat::write( json, data );
+		TEST_ASSERT( not data.empty() );
+		auto other = su::flat::read( data.data(), data.size() );
+		TEST_ASSERT_EQUAL( json, other );
+	}
+
+	// in place access
+	auto view = su::flat::root( data.data(), data.size() );
+	TEST_ASSERT( view.is_object() );
+	auto user = view["statuses"][3]["user"];
+	TEST_ASSERT( user.is_object() );
+	TEST_ASSERT_EQUAL( user.to_json(), kTwitter["statuses"][3]["user"] );
+	TEST_ASSERT_EQUAL( user["screen_name"].string_value(),
+	                   kTwitter["statuses"][3]["user"]["screen_name"].string_value() );
+	auto s = user["screen_name"].string_value();
+	TEST_ASSERT( reinterpret_cast<const uint8_t *>( s.data() ) > data.data() and
+	             reinterpret_cast<const uint8_t *>( s.data() ) < data.data() + data.size() );
+	TEST_ASSERT_EQUAL( view["statuses"].size(), kTwitter["statuses"].array_items().size() );
+	TEST_ASSERT( view["statuses"][100000].is_null() );
+	TEST_ASSERT( view["no such key"].is_null() );
+	TEST_ASSERT( view[0].is_null() );
+
+	su::Json values = su::Json::object{ { "b", su::Json::array{ nullptr, true, -1, int64_t( -5000000000 ), 0.5, "abc" } },
+		{ "a", "abc" } };
+	su::flat::write( values, data );
+	TEST_ASSERT_EQUAL( su::flat::read( data.data(), data.size() ), values );
+	view = su::flat::root( data.data(), data.size() );
+	TEST_ASSERT_EQUAL( view.size(), 2 );
+	auto b = view["b"];
+	TEST_ASSERT( b[0].is_null() and b[0].type() == su::Json::Type::NUL );
+	TEST_ASSERT( b[1].bool_value() );
+	TEST_ASSERT_EQUAL( b[2].int_value(), -1 );
+	TEST_ASSERT_EQUAL( b[3].int64_value(), int64_t( -5000000000 ) );
+	TEST_ASSERT_EQUAL( b[4].number_value(), 0.5 );
+	// identical strings are stored once
+	TEST_ASSERT( b[5].string_value().data() == view["a"].string_value().data() );
+	std::string keys;
+	view.for_each_member( [&]( const std::string_view &k, const su::flat::View & ) {
+		keys += k;
+		return true;
+	} );
+	TEST_ASSERT_EQUAL( keys, "ab" );
+	int count = 0;
+	b.for_each_item( [&]( const su::flat::View & ) { return ++count < 3; } );
+	TEST_ASSERT_EQUAL( count, 3 );
+
+	std::string err;
+	TEST_ASSERT( su::flat::read( data.data(), data.size() - 1, err ).is_null() );
+	TEST_ASSERT_EQUAL( err, "invalid offset" );
+	TEST_ASSERT( su::flat::root( data.data(), data.size() - 1 )["b"].is_null() );
+	const uint8_t badMagic[] = { 'S', 'U', 'F', 'K', 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+	TEST_ASSERT( su::flat::read( badMagic, sizeof( badMagic ), err ).is_null() );
+	TEST_ASSERT_EQUAL( err, "not a flat Json buffer" );
+	TEST_ASSERT( su::flat::root( badMagic, sizeof( badMagic ) ).is_null() );
+	// an array containing itself
+	const uint8_t cycle[] = { 'S', 'U', 'F', 'J', 1, 0, 0, 0, 6, 0, 0, 0, 16, 0, 0, 0,
+		1, 0, 0, 0, 0, 0, 0, 0, 6, 0, 0, 0, 16, 0, 0, 0 };
+	TEST_ASSERT( su::flat::read( cycle, sizeof( cycle ), err ).is_null() );
+	TEST_ASSERT_EQUAL( err, "too many values for the buffer size" );
+	TEST_ASSERT( su::flat::root( cycle, sizeof( cycle ) )[0][0][0].is_array() );
+	// 40 levels of [ next, next ]: 976 bytes for 2^40 values
+	std::vector<uint8_t> doubling = { 'S', 'U', 'F', 'J', 1, 0, 0, 0, 6, 0, 0, 0, 16, 0, 0, 0 };
+	auto put = []( std::vector<uint8_t> &io_out, uint32_t v ) {
+		for ( int i = 0; i < 4; ++i )
+			io_out.push_back( uint8_t( v >> ( i * 8 ) ) );
+	};
+	for ( int level = 0; level < 40; ++level )
+	{
+		// the last level holds 2 nulls
+		uint32_t next = level < 39 ? uint32_t( doubling.size() + 24 ) : 0;
+		put( doubling, 2 );
+		put( doubling, 0 );
+		for ( int i = 0; i < 2; ++i )
+		{
+			put( doubling, next != 0 ? 6 : 0 );
+			put( doubling, next );
+		}
+	}
+	TEST_ASSERT_EQUAL( doubling.size(), 976 );
+	TEST_ASSERT( su::flat::read( doubling.data(), doubling.size(), err ).is_null() );
+	TEST_ASSERT_EQUAL( err, "too many values for the buffer size" );
+	auto top = su::flat::root( doubling.data(), doubling.size() );
+	TEST_ASSERT( top[1][0][1].is_array() );
+	TEST_ASSERT( top.to_json().is_null() );
+	// objects with all their keys on the same long string
+	std::vector<uint8_t> longKeys = { 'S', 'U', 'F', 'J' };
+	put( longKeys, 1 );
+	put( longKeys, 7 );
+	put( longKeys, 1040 );
+	put( longKeys, 1020 );
+	longKeys.resize( 1040, 'k' );
+	put( longKeys, 100 );
+	put( longKeys, 0 );
+	for ( int i = 0; i < 100; ++i )
+		put( longKeys, 16 );
+	for ( int i = 0; i < 100; ++i )
+	{
+		put( longKeys, 0 );
+		put( longKeys, 0 );
+	}
+	TEST_ASSERT( su::flat::read( longKeys.data(), longKeys.size(), err ).is_null() );
+	TEST_ASSERT_EQUAL( err, "object keys are not sorted" );
+	// and in many objects, 100 KB of keys from a 4 KB buffer
+	longKeys.resize( 1040 );
+	put( longKeys, 100 );
+	put( longKeys, 0 );
+	for ( int i = 0; i < 100; ++i )
+	{
+		put( longKeys, 7 );
+		put( longKeys, uint32_t( 1040 + 8 + 100 * 8 + i * 24 ) );
+	}
+	for ( int i = 0; i < 100; ++i )
+	{
+		put( longKeys, 1 );
+		put( longKeys, 0 );
+		put( longKeys, 16 );
+		put( longKeys, 0 );
+		put( longKeys, 0 );
+		put( longKeys, 0 );
+	}
+	longKeys[8] = 6;
+	TEST_ASSERT( su::flat::read( longKeys.data(), longKeys.size(), err ).is_null() );
+	TEST_ASSERT_EQUAL( err, "too many keys for the buffer size" );
+	TEST_ASSERT( su::flat::root( longKeys.data(), longKeys.size() )[99].is_object() );
 }
@@ -0,0 +1,115 @@
+/*
+ *  dtoa_tests.cpp
+ *  sutils_tests
+ *
+ *  Created by Sandy Martel on 2026/10/18.
+ *  Copyright 2026 Sandy Martel. All rights reserved.
+ *
+ *  quick reference:
+ *
+ *      TEST_ASSERT( condition )
+ *          Assertions that a condition is true.
+ *
+ *      TEST_ASSERT_EQUAL( expected, actual )
+ *          Asserts that two values are equals.
+ *
+ *      TEST_ASSERT_NOT_EQUAL( not expected, actual )
+ *          Asserts that two values are NOT equals.
+ */
+
+#include "su_tests/simple_tests.h"
+#include "su_dtoa.h"
+#include "su_format.h"
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+
+struct dtoa_tests
+{
+	//	declare all test cases here...
+	void test_case_notation();
+	void test_case_shortest();
+	void test_case_round_trip();
+	void test_case_format();
+};
+
+REGISTER_TEST_SUITE( dtoa_tests,
+	&dtoa_tests::test_case_notation,
+	&dtoa_tests::test_case_shortest,
+	&dtoa_tests::test_case_round_trip,
+	&dtoa_tests::test_case_format );
+
+// MARK: -
+// MARK:  === test cases ===
+
+void dtoa_tests::test_case_notation()
+{
+	TEST_ASSERT_EQUAL( su::dtoa( 0.0 ), "0.0" );
+	TEST_ASSERT_EQUAL( su::dtoa( -0.0 ), "-0.0" );
+	TEST_ASSERT_EQUAL( su::dtoa( 1.0 ), "1.0" );
+	TEST_ASSERT_EQUAL( su::dtoa( -123456.0 ), "-123456.0" );
+	TEST_ASSERT_EQUAL( su::dtoa( 1.5 ), "1.5" );
+	TEST_ASSERT_EQUAL( su::dtoa( 0.001234 ), "0.001234" );
+	TEST_ASSERT_EQUAL( su::dtoa( 1e20 ), "100000000000000000000.0" );
+	TEST_ASSERT_EQUAL( su::dtoa( 1e21 ), "1e21" );
+	TEST_ASSERT_EQUAL( su::dtoa( 1.25e-7 ), "1.25e-7" );
+	TEST_ASSERT_EQUAL( su::dtoa( std::numeric_limits<double>::infinity() ), "inf" );
+	TEST_ASSERT_EQUAL( su::dtoa( -std::numeric_limits<double>::infinity() ), "-inf" );
+	TEST_ASSERT_EQUAL( su::dtoa( std::numeric_limits<double>::quiet_NaN() ), "nan" );
+
+	// the longest outputs
+	char buffer[su::kDtoaBufferSize];
+	TEST_ASSERT_EQUAL( su::dtoa( -0.0000012345678901234567, buffer ) - buffer, 25 );
+	TEST_ASSERT_EQUAL( su::dtoa( -2.2250738585072014e-308, buffer ) - buffer, 24 );
+}
+
+void dtoa_tests::test_case_shortest()
+{
+	TEST_ASSERT_EQUAL( su::dtoa( 0.1 ), "0.1" );
+	TEST_ASSERT_EQUAL( su::dtoa( 0.3 ), "0.3" );
+	TEST_ASSERT_EQUAL( su::dtoa( 0.1 + 0.2 ), "0.30000000000000004" );
+	TEST_ASSERT_EQUAL( su::dtoa( 5e-324 ), "5e-324" );
+	TEST_ASSERT_EQUAL( su::dtoa( 1.7976931348623157e308 ), "1.7976931348623157e308" );
+	TEST_ASSERT_EQUAL( su::dtoa( 2.2250738585072014e-308 ), "2.2250738585072014e-308" );
+	TEST_ASSERT_EQUAL( su::dtoa( 9007199254740993.0 ), "9007199254740992.0" );
+	TEST_ASSERT_EQUAL( su::dtoa( 12345678901.345678 ), "12345678901.345678" );
+	// 2^-44, 16 digits are enough
+	TEST_ASSERT_EQUAL( su::dtoa( 5.6843418860808015e-14 ), "5.684341886080802e-14" );
+	TEST_ASSERT_EQUAL( su::dtoa( 1.0e23 ), "1e23" );
+
+	uint64_t digits;
+	int exponent;
+	su::dtoa_decimal( 1500.0, digits, exponent );
+	TEST_ASSERT_EQUAL( digits, 15u );
+	TEST_ASSERT_EQUAL( exponent, 2 );
+	su::dtoa_decimal( 0.0625, digits, exponent );
+	TEST_ASSERT_EQUAL( digits, 625u );
+	TEST_ASSERT_EQUAL( exponent, -4 );
+}
+
+void dtoa_tests::test_case_round_trip()
+{
+	std::mt19937_64 rng( 2018 );
+	char buffer[su::kDtoaBufferSize + 1];
+	for ( int i = 0; i < 100000; ++i )
+	{
+		uint64_t bits = rng();
+		double d;
+		std::memcpy( &d, &bits, sizeof( d ) );
+		if ( d != d or d - d != 0 )
+			continue; // nan or inf
+		*su::dtoa( d, buffer ) = 0;
+		double r = std::strtod( buffer, nullptr );
+		TEST_ASSERT( std::memcmp( &r, &d, sizeof( d ) ) == 0, buffer );
+	}
+}
+
+void dtoa_tests::test_case_format()
+{
+	TEST_ASSERT_EQUAL( su::format( "%@", 0.1 ), "0.1" );
+	TEST_ASSERT_EQUAL( su::format( "%+@", 2.0 ), "+2.0" );
+	TEST_ASSERT_EQUAL( su::format( "%8@|%-8@|", 1.5, -1.5 ), "     1.5|-1.5    |" );
+	TEST_ASSERT_EQUAL( su::format( "%08@", -1.5 ), "-00001.5" );
+	TEST_ASSERT_EQUAL( su::format( "%@ %d", 1e300, 3 ), "1e300 3" );
+}
@@ -0,0 +1,252 @@
+/*
+ *  json_bench.cpp
+ *  sutils_bench
+ *
+ *  Created by Sandy Martel on 2026/10/18.
+ *  Copyright 2026 Sandy Martel. All rights reserved.
+ *
+ *  Each benchmark is a timed test of the sutils_bench runner: durations
+ *  and metrics are recorded in the tests database and compared to the
+ *  previous run.
+ *
+ *      MB/s         json text processed per second (higher is better)
+ *      allocations  calls to operator new per document
+ *      peak RSS KB  of the process so far
+ *      memory KB    held by a parsed document
+ */
+
+#include "su_tests/simple_tests.h"
+#include "su_json.h"
+#include "su_messagepack.h"
+#include "su_ubjson.h"
+#include "su_bson.h"
+#include "su_smile.h"
+#include "su_flatjson.h"
+#include "su_resource_access.h"
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+
+#if __has_include(<sys/resource.h>)
+#define HAS_GETRUSAGE
+#include <sys/resource.h>
+#endif
+
+struct json_bench;
+
+// MARK: -
+// MARK:  === allocation counting ===
+
+namespace {
+std::atomic<size_t> g_allocations{ 0 };
+}
+
+void *operator new( size_t i_size )
+{
+	g_allocations.fetch_add( 1, std::memory_order_relaxed );
+	if ( auto p = std::malloc( i_size > 0 ? i_size : 1 ) )
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete( void *i_ptr ) noexcept
+{
+	std::free( i_ptr );
+}
+
+void operator delete( void *i_ptr, size_t ) noexcept
+{
+	std::free( i_ptr );
+}
+
+namespace {
+
+std::string loadFile( const std::string &i_name )
+{
+	auto fpath = su::resource_access::get( i_name );
+
+	std::ifstream f;
+	fpath.fsopen( f );
+	std::string s;
+	while ( f )
+	{
+		char buf[4096];
+		f.read( buf, 4096 );
+		s.append( buf, f.gcount() );
+	}
+	return s;
+}
+
+double peakRSS()
+{
+#ifdef HAS_GETRUSAGE
+	rusage usage;
+	getrusage( RUSAGE_SELF, &usage );
+#ifdef __APPLE__
+	return double( usage.ru_maxrss / 1024 );
+#else
+	return double( usage.ru_maxrss );
+#endif
+#else
+	return 0;
+#endif
+}
+
+struct Fixture
+{
+	std::string name;
+	std::string text;
+	su::Json json;
+};
+
+const std::vector<Fixture> &fixtures()
+{
+	static std::vector<Fixture> s_fixtures = []
+	{
+		std::vector<Fixture> result;
+		for ( auto name : { "canada", "citm_catalog", "twitter" } )
+		{
+			Fixture fixture{ name, loadFile( std::string( name ) + ".json" ), {} };
+			std::string err;
+			fixture.json = su::Json::parse( fixture.text, err );
+			TEST_ASSERT( err.empty(), err );
+			result.push_back( std::move( fixture ) );
+		}
+		return result;
+	}();
+	return s_fixtures;
+}
+
+/* run(timer, fixture, op)
+ *
+ * Time enough iterations of op for about 32 MB of json text, after a warm
+ * up, and report the metrics per document.
+ */
+template<typename OP>
+void run( su::TestTimer &io_timer, const Fixture &i_fixture, const OP &i_op )
+{
+	int iterations = std::max( 3, int( ( 32 << 20 ) / i_fixture.text.size() ) );
+	i_op();
+	auto allocations = g_allocations.load();
+	io_timer.start();
+	for ( int i = 0; i < iterations; ++i )
+		i_op();
+	io_timer.end();
+	allocations = g_allocations.load() - allocations;
+
+	double seconds = io_timer.nanoseconds() / 1e9;
+	double mbs = i_fixture.text.size() * double( iterations ) / seconds / 1e6;
+	io_timer.metric( "MB/s", std::round( mbs * 10 ) / 10, true );
+	io_timer.metric( "allocations", double( allocations / iterations ) );
+	io_timer.metric( "peak RSS KB", peakRSS() );
+}
+
+/* addCodec<BUFFER>(suite, codec, fixture, write, read)
+ *
+ * Benchmark write and read of a binary format.
+ */
+template<typename BUFFER, typename WRITE, typename READ>
+void addCodec( su::TestSuite<json_bench> &io_suite,
+               const std::string &i_codec,
+               size_t i_fixture,
+               const WRITE &i_write,
+               const READ &i_read )
+{
+	auto name = fixtures()[i_fixture].name;
+	io_suite.registerTestCase( i_codec + "_write_" + name, su::timed_test( 1 ),
+	    [=]( su::TestTimer &io_timer )
+		{
+			auto &fixture = fixtures()[i_fixture];
+			BUFFER buffer;
+			run( io_timer, fixture, [&]{ buffer.clear(); i_write( fixture.json, buffer ); } );
+			TEST_ASSERT( not buffer.empty() );
+		} );
+	io_suite.registerTestCase( i_codec + "_read_" + name, su::timed_test( 1 ),
+	    [=]( su::TestTimer &io_timer )
+		{
+			auto &fixture = fixtures()[i_fixture];
+			BUFFER buffer;
+			i_write( fixture.json, buffer );
+			su::Json copy;
+			run( io_timer, fixture, [&]{ copy = i_read( buffer ); } );
+			TEST_ASSERT( copy == fixture.json );
+		} );
+}
+
+}
+
+struct json_bench
+{
+	static void registerBenchmarks( su::TestSuite<json_bench> &io_suite )
+	{
+		for ( size_t i = 0; i < fixtures().size(); ++i )
+		{
+			auto &name = fixtures()[i].name;
+			io_suite.registerTestCase( "parse_" + name, su::timed_test( 1 ),
+			    [i]( su::TestTimer &io_timer )
+				{
+					auto &fixture = fixtures()[i];
+					std::string err;
+					su::Json json;
+					run( io_timer, fixture, [&]{ json = su::Json::parse( fixture.text, err ); } );
+					TEST_ASSERT( err.empty(), err );
+					io_timer.metric( "memory KB", double( json.memory_usage() / 1024 ) );
+				} );
+			io_suite.registerTestCase( "parse_arena_" + name, su::timed_test( 1 ),
+			    [i]( su::TestTimer &io_timer )
+				{
+					auto &fixture = fixtures()[i];
+					std::string err;
+					su::JsonArena arena;
+					su::Json json;
+					run( io_timer, fixture, [&]{
+						json = su::Json();
+						arena.reset();
+						json = su::Json::parse( fixture.text, err, arena );
+					} );
+					TEST_ASSERT( err.empty(), err );
+					TEST_ASSERT( json == fixture.json );
+				} );
+			io_suite.registerTestCase( "dump_" + name, su::timed_test( 1 ),
+			    [i]( su::TestTimer &io_timer )
+				{
+					auto &fixture = fixtures()[i];
+					std::string out;
+					run( io_timer, fixture, [&]{ out.clear(); fixture.json.dump( out ); } );
+					TEST_ASSERT( not out.empty() );
+				} );
+			io_suite.registerTestCase( "equal_" + name, su::timed_test( 1 ),
+			    [i]( su::TestTimer &io_timer )
+				{
+					auto &fixture = fixtures()[i];
+					// a separate tree, nothing is shared
+					std::string err;
+					auto other = su::Json::parse( fixture.text, err );
+					bool equal = true;
+					run( io_timer, fixture, [&]{ equal = equal and fixture.json == other; } );
+					TEST_ASSERT( equal );
+				} );
+
+			using bytes = std::vector<uint8_t>;
+			addCodec<bytes>( io_suite, "messagepack", i,
+			    []( const su::Json &j, bytes &b ) { su::messagepack::write( j, b ); },
+			    []( const bytes &b ) { return su::messagepack::read( b.data(), b.size() ); } );
+			addCodec<bytes>( io_suite, "ubjson", i,
+			    []( const su::Json &j, bytes &b ) { su::ubjson::write( j, b ); },
+			    []( const bytes &b ) { return su::ubjson::read( b.data(), b.size() ); } );
+			addCodec<std::string>( io_suite, "bson", i,
+			    []( const su::Json &j, std::string &b ) { su::bson::write( j, b ); },
+			    []( const std::string &b ) { return su::bson::read( b ); } );
+			addCodec<bytes>( io_suite, "smile", i,
+			    []( const su::Json &j, bytes &b ) { su::smile::write( j, b ); },
+			    []( const bytes &b ) { return su::smile::read( b.data(), b.size() ); } );
+			addCodec<bytes>( io_suite, "flat", i,
+			    []( const su::Json &j, bytes &b ) { su::flat::write( j, b ); },
+			    []( const bytes &b ) { return su::flat::read( b.data(), b.size() ); } );
+		}
+	}
+};
+
+REGISTER_TEST_SUITE( json_bench, &json_bench::registerBenchmarks );
@@ -19,15 +19,28 @@
 
 #include "su_tests/simple_tests.h"
 #include "su_json.h"
+#include "su_jsonpath.h"
+#include "su_jsonbind.h"
+#include "su_jobdispatcher.h"
+#include "su_thread.h"
 #include "su_platform.h"
 #include "su_resource_access.h"
+#include "su_filepath.h"
 #include <list>
 #include <set>
 #include <map>
+#include <optional>
 #include <fstream>
+#include <sstream>
+#include <stdexcept>
 #include <unordered_map>
+#include <unordered_set>
 #include <cstring>
+#include <cmath>
+#include <limits>
+#include <cstdlib>
 #include <iostream>
+#include <thread>
 
 using namespace su;
 using std::string;
@@ -54,12 +67,48 @@ struct json_tests
 	void test_case_1();
 	void test_case_2();
 	void test_case_3();
+	void test_case_arena();
+	void test_case_whitespace();
+	void test_case_view();
+	void test_case_reader();
+	void test_case_push();
+	void test_case_threads();
+	void test_case_inline_string();
+	void test_case_mutation();
+	void test_case_parallel_multi();
+	void test_case_dump();
+	void test_case_numbers();
+	void test_case_intern();
+	void test_case_path();
+	void test_case_bind();
+	void test_case_strings();
+	void test_case_hash();
+	void test_case_memory();
+	void test_case_parse_file();
 };
 
 REGISTER_TEST_SUITE( json_tests,
 			   su::timed_test(), &json_tests::test_case_1,
 			   su::timed_test(), &json_tests::test_case_2,
-			   su::timed_test(), &json_tests::test_case_3 );
+			   su::timed_test(), &json_tests::test_case_3,
+			   su::timed_test(), &json_tests::test_case_arena,
+			   su::timed_test(), &json_tests::test_case_whitespace,
+			   su::timed_test(), &json_tests::test_case_view,
+			   su::timed_test(), &json_tests::test_case_reader,
+			   su::timed_test(), &json_tests::test_case_push,
+			   su::timed_test(), &json_tests::test_case_threads,
+			   su::timed_test(), &json_tests::test_case_inline_string,
+			   su::timed_test(), &json_tests::test_case_mutation,
+			   su::timed_test(), &json_tests::test_case_parallel_multi,
+			   su::timed_test(), &json_tests::test_case_dump,
+			   su::timed_test(), &json_tests::test_case_numbers,
+			   su::timed_test(), &json_tests::test_case_intern,
+			   su::timed_test(), &json_tests::test_case_path,
+			   su::timed_test(), &json_tests::test_case_bind,
+			   su::timed_test(), &json_tests::test_case_strings,
+			   su::timed_test(), &json_tests::test_case_hash,
+			   su::timed_test(), &json_tests::test_case_memory,
+			   su::timed_test(), &json_tests::test_case_parse_file );
 
 namespace {
 std::string loadFile( const std::string &i_name )
@@ -261,6 +310,11 @@ void json_tests::test_case_1()
 
 struct Stat
 {
+	bool operator==( const Stat &rhs ) const
+	{
+		return std::memcmp( this, &rhs, sizeof( Stat ) ) == 0;
+	}
+
 	size_t arrayCount = 0;
 	size_t elementCount = 0;
 	size_t stringLength = 0;
@@ -392,3 +446,1211 @@ void json_tests::test_case_3()
 	TEST_ASSERT_EQUAL( s, roundtrip10 );
 }
 
+
+void json_tests::test_case_arena()
+{
+	std::string err;
+	su::JsonArena arena;
+
+	for ( auto &input : { kTwitter, kCITM, kCanada } )
+	{
+		auto expected = su::Json::parse( input, err );
+		TEST_ASSERT( err.empty(), err );
+
+		auto json = su::Json::parse( input, err, arena );
+		TEST_ASSERT( err.empty(), err );
+		TEST_ASSERT_EQUAL( json, expected );
+		TEST_ASSERT( arena.capacity() > 0 );
+
+		// copies share the arena nodes
+		auto copy = json;
+		TEST_ASSERT_EQUAL( copy.dump(), expected.dump() );
+
+		copy.clear();
+		json.clear();
+		arena.reset();
+	}
+
+	auto json = su::Json::parse( R"({"a":[1,"two",{}],"b":"three"})", err, arena );
+	TEST_ASSERT( err.empty(), err );
+	TEST_ASSERT_EQUAL( json["a"][1].string_value(), "two" );
+	TEST_ASSERT_EQUAL( json["b"].string_value(), "three" );
+	TEST_ASSERT_EQUAL( json.dump(), R"({"a":[1,"two",{}],"b":"three"})" );
+
+	// long strings have their characters in the arena
+	json = su::Json::parse( R"(["a string too long to be inline"])", err, arena );
+	TEST_ASSERT( err.empty(), err );
+	su::Json heap( "a string too long to be inline" );
+	TEST_ASSERT_EQUAL( json[0], heap );
+	TEST_ASSERT_EQUAL( std::hash<su::Json>()( json[0] ), std::hash<su::Json>()( heap ) );
+	TEST_ASSERT_EQUAL( json[0].memory_breakdown().string_bytes, heap.string_view().size() );
+	TEST_ASSERT_EQUAL( json.shrink_to_fit(), 0 );
+	auto edited = json;
+	TEST_ASSERT( edited.push_back( json[0] ) );
+	TEST_ASSERT_EQUAL( edited.dump(), R"(["a string too long to be inline","a string too long to be inline"])" );
+	edited.clear();
+
+	json = su::Json::parse( R"({"a":[1,"two",)", err, arena );
+	TEST_ASSERT( not err.empty() );
+	TEST_ASSERT( json.is_null() );
+}
+
+void json_tests::test_case_whitespace()
+{
+	// the comments strategy does not use the structural index
+	std::string err1, err2;
+	for ( auto &input : { kTwitter, kCITM, kCanada } )
+	{
+		auto json = su::Json::parse( input, err1 );
+		TEST_ASSERT( err1.empty(), err1 );
+		TEST_ASSERT_EQUAL( json, su::Json::parse( input, err2, JsonParse::COMMENTS ) );
+		TEST_ASSERT( err2.empty(), err2 );
+	}
+
+	// escapes, quotes and whitespace straddling 64 bytes blocks
+	std::string input = "[";
+	for ( int i = 0; i < 200; ++i )
+	{
+		input += std::string( i % 70, ' ' ) + "\"" + std::string( i % 5, '\\' );
+		if ( i % 5 % 2 )
+			input += '\\';
+		input += std::string( i % 67, ' ' ) + "\\\" , ]\"" +
+		         std::string( i % 3, '\n' ) + ( i == 199 ? "" : "," );
+	}
+	input += std::string( 100, ' ' ) + "]  \t\r\n ";
+	auto json = su::Json::parse( input, err1 );
+	TEST_ASSERT( err1.empty(), err1 );
+	TEST_ASSERT_EQUAL( json.array_items().size(), 200 );
+	TEST_ASSERT_EQUAL( json, su::Json::parse( input, err2, JsonParse::COMMENTS ) );
+	TEST_ASSERT_EQUAL( json[199].string_value().back(), ']' );
+
+	su::Json::parse( "[1,   2    x]", err1 );
+	TEST_ASSERT( not err1.empty() );
+	err1.clear();
+	su::Json::parse( "[\"a  \"    \"b\"]", err1 );
+	TEST_ASSERT( not err1.empty() );
+}
+
+void json_tests::test_case_view()
+{
+	su::JsonDocumentView doc( R"( { "k1" : "v1", "k2":42, "k3":["a",123,true,false,null],
+		"k\"4" : { "a" : [ {}, [] ], "b" : "x\tyé" }, "k5": -1.5e3 } )" );
+
+	auto root = doc.root();
+	TEST_ASSERT( root.is_object() );
+	TEST_ASSERT_EQUAL( root.size(), 5 );
+	TEST_ASSERT_EQUAL( doc["k1"].string_value(), "v1" );
+	TEST_ASSERT_EQUAL( doc["k2"].int_value(), 42 );
+	TEST_ASSERT_EQUAL( doc["k5"].number_value(), -1500.0 );
+	TEST_ASSERT_EQUAL( doc["k3"].size(), 5 );
+	TEST_ASSERT_EQUAL( doc["k3"][0].string_value(), "a" );
+	TEST_ASSERT_EQUAL( doc["k3"][1].int64_value(), 123 );
+	TEST_ASSERT( doc["k3"][2].bool_value() );
+	TEST_ASSERT( doc["k3"][3].is_bool() );
+	TEST_ASSERT( not doc["k3"][3].bool_value() );
+	TEST_ASSERT( doc["k3"][4].is_null() );
+	TEST_ASSERT( doc["k3"][5].is_null() );
+	TEST_ASSERT( doc["nope"].is_null() );
+	// missing values answer like null
+	auto missing = doc["nope"];
+	TEST_ASSERT( not missing.bool_value() );
+	TEST_ASSERT( not su::JsonView().bool_value() );
+	TEST_ASSERT( not doc["k1"].bool_value() );
+	TEST_ASSERT_EQUAL( missing.int_value(), 0 );
+	TEST_ASSERT_EQUAL( missing.number_value(), 0.0 );
+	TEST_ASSERT_EQUAL( missing.string_value(), "" );
+	TEST_ASSERT_EQUAL( missing.size(), 0 );
+	TEST_ASSERT( missing.raw().empty() );
+	TEST_ASSERT( missing["a"][0].is_null() );
+	TEST_ASSERT( doc["k\"4"]["a"][0].is_object() );
+	TEST_ASSERT( doc["k\"4"]["a"][1].is_array() );
+	TEST_ASSERT_EQUAL( doc["k\"4"]["b"].string_value(), "x\ty\xc3\xa9" );
+	TEST_ASSERT_EQUAL( doc["k\"4"]["a"].raw(), "[ {}, [] ]" );
+
+	// zero-copy when there is nothing to unescape
+	std::string buffer;
+	auto v1 = doc["k1"].string_value( buffer );
+	TEST_ASSERT( buffer.empty() );
+	TEST_ASSERT_EQUAL( v1, "v1" );
+
+	std::string err;
+	TEST_ASSERT_EQUAL( doc["k3"].to_json(),
+	                   su::Json::parse( R"(["a",123,true,false,null])", err ) );
+
+	// same answers as the full parse
+	su::JsonDocumentView twitter( kTwitter );
+	auto json = su::Json::parse( kTwitter, err );
+	auto statuses = twitter["statuses"];
+	TEST_ASSERT_EQUAL( statuses.size(), json["statuses"].array_items().size() );
+	for ( size_t i = 0; i < statuses.size(); i += 7 )
+	{
+		TEST_ASSERT_EQUAL( statuses[i]["user"]["id"].int64_value(),
+		                   json["statuses"][i]["user"]["id"].int64_value() );
+		TEST_ASSERT_EQUAL( statuses[i]["text"].string_value(),
+		                   json["statuses"][i]["text"].string_value() );
+		TEST_ASSERT_EQUAL( statuses[i].to_json(), json["statuses"][i] );
+	}
+	su::JsonDocumentView canada( kCanada );
+	auto coords = canada["features"][0]["geometry"]["coordinates"][0][3];
+	TEST_ASSERT_EQUAL(
+	    coords[1].number_value(),
+	    su::Json::parse( kCanada, err )["features"][0]["geometry"]["coordinates"][0][3][1].number_value() );
+
+	// malformed input gives null views
+	su::JsonDocumentView bad( R"({"a":[1,2,{"b":)" );
+	TEST_ASSERT( bad["a"][2]["b"].is_null() );
+	TEST_ASSERT( bad["a"].is_null() );
+	TEST_ASSERT_EQUAL( su::JsonDocumentView( "[1,2,[" )[1].int_value(), 2 );
+}
+
+namespace {
+struct StatReader : su::json_reader
+{
+	StatReader( su::JsonParse i_strategy = su::JsonParse::STANDARD,
+	            bool i_multiple = false ) :
+	    su::json_reader( i_strategy, i_multiple )
+	{
+	}
+
+	Stat stat;
+	double sum = 0;
+
+	bool start_object() override
+	{
+		stat.objectCount++;
+		return true;
+	}
+	bool key( const std::string_view &i_key ) override
+	{
+		stat.memberCount++;
+		stat.stringCount++;
+		stat.stringLength += i_key.size();
+		return true;
+	}
+	bool start_array() override
+	{
+		stat.arrayCount++;
+		return true;
+	}
+	bool string( const std::string_view &i_value ) override
+	{
+		stat.stringCount++;
+		stat.stringLength += i_value.size();
+		return true;
+	}
+	bool number( const su::Json &i_value ) override
+	{
+		stat.numberCount++;
+		sum += i_value.number_value();
+		return true;
+	}
+	bool boolean( bool i_value ) override
+	{
+		if ( i_value )
+			stat.trueCount++;
+		else
+			stat.falseCount++;
+		return true;
+	}
+	bool null() override
+	{
+		stat.nullCount++;
+		return true;
+	}
+};
+
+double sumNumbers( const su::Json &i_json )
+{
+	double sum = i_json.number_value();
+	for ( auto &it : i_json.array_items() )
+		sum += sumNumbers( it );
+	for ( auto &it : i_json.object_items() )
+		sum += sumNumbers( it.second );
+	return sum;
+}
+}
+
+void json_tests::test_case_reader()
+{
+	std::string err;
+	for ( auto &input : { kTwitter, kCITM, kCanada } )
+	{
+		auto json = su::Json::parse( input, err );
+		Stat expected;
+		getStat( json, expected );
+		expected.elementCount = 0;
+
+		// odd sized chunks to split tokens everywhere
+		StatReader reader;
+		for ( size_t pos = 0, chunk = 1; pos < input.size(); pos += chunk, chunk = ( chunk * 7 ) % 97 + 1 )
+			TEST_ASSERT( reader.feed( std::string_view( input ).substr( pos, chunk ) ), reader.error() );
+		TEST_ASSERT( reader.finish(), reader.error() );
+		TEST_ASSERT( reader.stat == expected );
+		// not summed in the same order
+		TEST_ASSERT( std::abs( reader.sum - sumNumbers( json ) ) <= std::abs( reader.sum ) * 1e-12 );
+
+		// from a stream
+		std::istringstream stream( input );
+		StatReader streamReader;
+		TEST_ASSERT( streamReader.parse( stream ), streamReader.error() );
+		TEST_ASSERT( streamReader.stat == expected );
+	}
+
+	const char *bad[] = { "", "[1,2", "{\"a\" 1}", "[1 2]", "[tru]", "[\"a\\x\"]", "[01]", "{} {}", "[1,]x" };
+	for ( auto input : bad )
+	{
+		StatReader reader;
+		TEST_ASSERT( not ( reader.feed( input ) and reader.finish() ), input );
+		TEST_ASSERT( not reader.error().empty() );
+	}
+
+	// multiple values and comments
+	StatReader multi( JsonParse::COMMENTS, true );
+	TEST_ASSERT( multi.feed( "{\"a\":[1,2]} /* x */ [3]\n// y\n \"b\"4 nu" ) );
+	TEST_ASSERT( multi.feed( "ll" ) );
+	TEST_ASSERT( multi.finish(), multi.error() );
+	TEST_ASSERT_EQUAL( multi.stat.objectCount, 1 );
+	TEST_ASSERT_EQUAL( multi.stat.arrayCount, 2 );
+	TEST_ASSERT_EQUAL( multi.stat.numberCount, 4 );
+	TEST_ASSERT_EQUAL( multi.stat.nullCount, 1 );
+	TEST_ASSERT_EQUAL( multi.sum, 10 );
+
+	// stopped by a callback
+	struct FirstKey : su::json_reader
+	{
+		std::string found;
+		bool key( const std::string_view &i_key ) override
+		{
+			found = i_key;
+			return false;
+		}
+	} first;
+	TEST_ASSERT( not first.feed( R"({"k\u00e9y":1,"other":2})" ) );
+	TEST_ASSERT( first.error().empty() );
+	TEST_ASSERT_EQUAL( first.found, "k\xc3\xa9y" );
+}
+
+void json_tests::test_case_push()
+{
+	std::string err;
+	for ( auto &input : { kTwitter, kCITM, kCanada } )
+	{
+		auto expected = su::Json::parse( input, err );
+
+		su::JsonPushParser parser( JsonParse::STANDARD, false );
+		for ( size_t pos = 0, chunk = 1; pos < input.size(); pos += chunk, chunk = ( chunk * 7 ) % 97 + 1 )
+			TEST_ASSERT( parser.feed( std::string_view( input ).substr( pos, chunk ) ), parser.error() );
+		TEST_ASSERT( parser.finish(), parser.error() );
+		TEST_ASSERT( parser.has_value() );
+		TEST_ASSERT( parser.next_value() == expected );
+		TEST_ASSERT( not parser.has_value() );
+	}
+
+	// a stream of values, yielded as they close
+	std::string_view stream = R"({"b":1,"a":[true,"x\u00e9"]}[ ] "s" {"a":null,"a":2} 12 -3.5)";
+	std::string_view::size_type stopPos;
+	auto expected = su::Json::parse_multi( stream, stopPos, err );
+	TEST_ASSERT_EQUAL( expected.size(), 6 );
+
+	su::JsonPushParser parser;
+	std::vector<su::Json> values;
+	for ( size_t i = 0; i < stream.size(); ++i )
+	{
+		TEST_ASSERT( parser.feed( stream.substr( i, 1 ) ), parser.error() );
+		while ( parser.has_value() )
+			values.push_back( parser.next_value() );
+		if ( i == stream.find( '}' ) )
+			TEST_ASSERT_EQUAL( values.size(), 1 );
+	}
+	TEST_ASSERT_EQUAL( values.size(), 5 ); // -3.5 might continue
+	TEST_ASSERT( parser.finish(), parser.error() );
+	values.push_back( parser.next_value() );
+	TEST_ASSERT( values == expected );
+
+	// errors, then reset
+	TEST_ASSERT( not parser.feed( "[1,}" ) );
+	TEST_ASSERT( not parser.error().empty() );
+	parser.reset();
+	TEST_ASSERT( parser.feed( "[1,{\"k\":[2]}]" ) and parser.finish(), parser.error() );
+	TEST_ASSERT_EQUAL( parser.next_value().dump(), R"([1,{"k":[2]}])" );
+}
+
+void json_tests::test_case_threads()
+{
+	std::string err;
+	auto json = su::Json::parse( kTwitter, err );
+	TEST_ASSERT( err.empty(), err );
+
+	// copies and releases from several threads at once, no deep copy
+	std::vector<std::thread> threads;
+	std::vector<size_t> counts( 4 );
+	for ( size_t t = 0; t < counts.size(); ++t )
+	{
+		threads.emplace_back( [&json, &counts, t] {
+			for ( int i = 0; i < 200; ++i )
+			{
+				su::Json copy = json;
+				std::vector<su::Json> statuses = copy["statuses"].array_items();
+				counts[t] += statuses.size();
+			}
+		} );
+	}
+	for ( auto &t : threads )
+		t.join();
+	for ( auto count : counts )
+		TEST_ASSERT_EQUAL( count, 200 * json["statuses"].array_items().size() );
+	TEST_ASSERT_EQUAL( json, su::Json::parse( kTwitter, err ) );
+}
+
+void json_tests::test_case_inline_string()
+{
+	// up to 14 bytes inline, longer on the heap
+	su::Json empty( "" ), small( "abcdefghijklmn" ), large( "abcdefghijklmno" );
+	TEST_ASSERT( empty.is_string() and empty.string_value().empty() );
+	TEST_ASSERT_EQUAL( small.string_value(), "abcdefghijklmn" );
+	TEST_ASSERT_EQUAL( large.string_value(), "abcdefghijklmno" );
+	TEST_ASSERT( not small.is_number() and not small.is_int() and not small.is_double() );
+	TEST_ASSERT( small.number_type() == su::Json::NumberType::NOTANUMBER );
+	su::Json nul( std::string( "a\0b", 3 ) );
+	TEST_ASSERT_EQUAL( nul.string_value().size(), 3 );
+	TEST_ASSERT_EQUAL( nul.dump(), R"("a\u0000b")" );
+
+	// copies, moves and assignments between inline and heap strings
+	su::Json copy( small );
+	TEST_ASSERT_EQUAL( copy, small );
+	copy = large;
+	TEST_ASSERT_EQUAL( copy, large );
+	copy = small;
+	TEST_ASSERT_EQUAL( copy.string_value(), "abcdefghijklmn" );
+	su::Json moved( std::move( copy ) );
+	TEST_ASSERT( copy.is_null() );
+	TEST_ASSERT_EQUAL( moved, small );
+	moved = su::Json( "xyz" );
+	TEST_ASSERT_EQUAL( moved.string_value(), "xyz" );
+	moved = su::Json( 1.5 );
+	TEST_ASSERT_EQUAL( moved.number_value(), 1.5 );
+	TEST_ASSERT( small < large and small != large );
+	TEST_ASSERT_EQUAL( su::Json( std::string_view( "abcdefghijklmno" ) ), large );
+	TEST_ASSERT_EQUAL( small.string_view(), "abcdefghijklmn" );
+	TEST_ASSERT_EQUAL( large.string_view(), "abcdefghijklmno" );
+	TEST_ASSERT( su::Json( 1 ).string_view().empty() );
+
+	// string_value() is a copy, still valid when the array grows
+	su::Json::array items{ "abc" };
+	std::string first = items[0].string_value();
+	items.resize( 100, "xyz" );
+	TEST_ASSERT_EQUAL( first, "abc" );
+
+	std::string err;
+	auto json = su::Json::parse( R"({"id":"en","text":"a longer string value","n":1})", err );
+	TEST_ASSERT( err.empty(), err );
+	TEST_ASSERT_EQUAL( json["id"].string_value(), "en" );
+	TEST_ASSERT_EQUAL( json["text"].string_value(), "a longer string value" );
+	TEST_ASSERT_EQUAL( json.dump(), R"({"id":"en","n":1,"text":"a longer string value"})" );
+	su::JsonArena arena;
+	TEST_ASSERT_EQUAL( su::Json::parse( kTwitter, err, arena ), su::Json::parse( kTwitter, err ) );
+}
+
+void json_tests::test_case_mutation()
+{
+	std::string err;
+	auto doc = su::Json::parse( R"({"a":{"b":[1,2,3]},"c":"x"})", err );
+	TEST_ASSERT( err.empty(), err );
+
+	// unique, changed in place
+	auto items = &doc.object_items();
+	TEST_ASSERT( doc.set( "d", 4 ) );
+	TEST_ASSERT( doc.set( "c", "y" ) );
+	TEST_ASSERT( items == &doc.object_items() );
+	TEST_ASSERT_EQUAL( doc.dump(), R"({"a":{"b":[1,2,3]},"c":"y","d":4})" );
+
+	// shared, detached on the first change only
+	auto copy = doc;
+	TEST_ASSERT( copy.mutable_item( "a" )->set_path( "b.1", "two" ) );
+	TEST_ASSERT( items == &doc.object_items() );
+	TEST_ASSERT( items != &copy.object_items() );
+	TEST_ASSERT_EQUAL( doc.dump(), R"({"a":{"b":[1,2,3]},"c":"y","d":4})" );
+	TEST_ASSERT_EQUAL( copy.dump(), R"({"a":{"b":[1,"two",3]},"c":"y","d":4})" );
+	items = &copy.object_items();
+	TEST_ASSERT( copy.erase( "d" ) );
+	TEST_ASSERT( not copy.erase( "d" ) );
+	TEST_ASSERT( items == &copy.object_items() );
+
+	// arrays
+	su::Json array;
+	TEST_ASSERT( array.push_back( 1 ) and array.push_back( "a" ) );
+	TEST_ASSERT( array.erase( size_t( 0 ) ) );
+	TEST_ASSERT( not array.erase( size_t( 5 ) ) );
+	TEST_ASSERT( not array.set( "k", 1 ) );
+	TEST_ASSERT( array.mutable_item( 1 ) == nullptr );
+	*array.mutable_item( 0 ) = true;
+	TEST_ASSERT_EQUAL( array.dump(), "[true]" );
+	su::Json number( 1 );
+	TEST_ASSERT( not number.push_back( 1 ) and number.mutable_item( "a" ) == nullptr );
+
+	// paths
+	su::Json root;
+	TEST_ASSERT( root.set_path( "a.b.c", 1 ) );
+	TEST_ASSERT( root.set_path( "a.l", su::Json::array{ 1, su::Json::object{} } ) );
+	TEST_ASSERT( root.set_path( "a.l.1.k", "v" ) );
+	TEST_ASSERT( not root.set_path( "a.l.2", 0 ) );
+	TEST_ASSERT( not root.set_path( "a.l.x", 0 ) );
+	TEST_ASSERT( not root.set_path( "a.b.c.d", 0 ) );
+	TEST_ASSERT_EQUAL( root.dump(), R"({"a":{"b":{"c":1},"l":[1,{"k":"v"}]}})" );
+
+	// arena nodes are never changed in place
+	su::JsonArena arena;
+	auto parsed = su::Json::parse( R"({"a":[1]})", err, arena );
+	auto shared = parsed;
+	TEST_ASSERT( parsed.mutable_item( "a" )->push_back( 2 ) );
+	TEST_ASSERT_EQUAL( parsed.dump(), R"({"a":[1,2]})" );
+	TEST_ASSERT_EQUAL( shared.dump(), R"({"a":[1]})" );
+
+	// clean() copies shared, interned and arena nodes first
+	const char *dirty = R"({"x":null,"y":"a long string value here","b":[1,2],"o":{"p":{"q":null}}})";
+	auto original = su::Json::parse( dirty, err );
+	auto cleaned = original;
+	cleaned.clean();
+	TEST_ASSERT_EQUAL( cleaned.dump(), R"({"b":[1,2],"o":{"p":{}},"y":"a long string value here"})" );
+	TEST_ASSERT_EQUAL( original, su::Json::parse( dirty, err ) );
+	su::JsonInternTable table;
+	auto d1 = su::Json::parse( dirty, err, table );
+	auto d2 = su::Json::parse( dirty, err, table );
+	d1.clean();
+	TEST_ASSERT_EQUAL( d1, cleaned );
+	TEST_ASSERT_EQUAL( d2, original );
+	auto inArena = su::Json::parse( dirty, err, arena );
+	shared = inArena;
+	inArena.clean();
+	TEST_ASSERT_EQUAL( inArena, cleaned );
+	TEST_ASSERT_EQUAL( shared, original );
+}
+
+void json_tests::test_case_parallel_multi()
+{
+	su::this_thread::set_as_main();
+	su::jobdispatcher dispatcher;
+
+	// a few MB of records, one per line
+	std::string err;
+	auto twitter = su::Json::parse( kTwitter, err );
+	std::string input;
+	for ( int i = 0; i < 30; ++i )
+	{
+		for ( auto &it : twitter["statuses"].array_items() )
+		{
+			it.dump( input );
+			input += "\n";
+		}
+		input += "\n \n"; // blank lines are fine
+	}
+	auto expected = su::Json::parse_multi( input, err );
+	TEST_ASSERT( err.empty(), err );
+	auto records = su::Json::parse_multi( input, dispatcher, err );
+	TEST_ASSERT( err.empty(), err );
+	TEST_ASSERT_EQUAL( records.size(), 30 * twitter["statuses"].array_items().size() );
+	TEST_ASSERT( records == expected );
+
+	// stop early
+	size_t count = 0;
+	TEST_ASSERT( not su::Json::parse_multi( input, dispatcher, [&count]( su::Json && ) {
+		return ++count < 10;
+	}, err ) );
+	TEST_ASSERT_EQUAL( count, 10 );
+	TEST_ASSERT( err.empty() );
+
+	// a throwing callback waits for the chunks in flight before unwinding
+	bool thrown = false;
+	try
+	{
+		su::Json::parse_multi( input, dispatcher, []( su::Json && ) -> bool {
+			throw std::runtime_error( "stop" );
+		}, err );
+	}
+	catch ( const std::runtime_error & )
+	{
+		thrown = true;
+	}
+	TEST_ASSERT( thrown );
+	TEST_ASSERT( su::Json::parse_multi( input, dispatcher, err ) == expected );
+
+	// an invalid record, reported with its number
+	input.insert( input.find( '\n', input.size() / 2 ) + 1, "{\"a\":}\n" );
+	count = 0;
+	TEST_ASSERT( not su::Json::parse_multi( input, dispatcher, [&count]( su::Json && ) {
+		++count;
+		return true;
+	}, err ) );
+	TEST_ASSERT_EQUAL( err.substr( 0, err.find( ':' ) ), "record " + std::to_string( count + 1 ) );
+	TEST_ASSERT( count > 0 and count < records.size() );
+	TEST_ASSERT( su::Json::parse_multi( "", dispatcher, err ).empty() and err.empty() );
+}
+
+void json_tests::test_case_dump()
+{
+	std::string err;
+	for ( auto &text : { kTwitter, kCITM, kCanada } )
+	{
+		auto json = su::Json::parse( text, err );
+		TEST_ASSERT( err.empty(), err );
+		for ( auto style : { su::JsonDump::COMPACT, su::JsonDump::PRETTY } )
+		{
+			auto expected = json.dump( style );
+			TEST_ASSERT_EQUAL( json.dump_size( style ), expected.size() );
+			TEST_ASSERT_EQUAL( su::Json::parse( expected, err ), json );
+
+			// written in pieces through a bounded buffer
+			std::string output;
+			size_t writes = 0, largest = 0;
+			TEST_ASSERT( json.dump( [&]( const char *i_str, size_t i_len ) {
+				output.append( i_str, i_len );
+				++writes;
+				largest = std::max( largest, i_len );
+				return true;
+			}, style ) );
+			TEST_ASSERT_EQUAL( output, expected );
+			TEST_ASSERT( writes > 1 and largest <= 16 * 1024 );
+
+			std::ostringstream stream;
+			json.dump( stream, style );
+			TEST_ASSERT( stream.good() );
+			TEST_ASSERT_EQUAL( stream.str(), expected );
+		}
+	}
+
+	su::Json json = su::Json::object{ { "a", su::Json::array{ 1, "x", su::Json::array{}, su::Json::object{} } },
+		{ "b", su::Json::object{ { "c", nullptr } } } };
+	TEST_ASSERT_EQUAL( json.dump( su::JsonDump::PRETTY ), R"({
+  "a": [
+    1,
+    "x",
+    [],
+    {}
+  ],
+  "b": {
+    "c": null
+  }
+})" );
+	TEST_ASSERT_EQUAL( su::Json( 1 ).dump( su::JsonDump::PRETTY ), "1" );
+	TEST_ASSERT_EQUAL( su::Json( "\xe2\x80" ).dump(), "\"\xe2\x80\"" );
+	TEST_ASSERT_EQUAL( su::Json( "a\xe2\x80\xa8" ).dump_size(), 9 );
+
+	// errors stop the output
+	size_t writes = 0;
+	auto big = su::Json::parse( kCanada, err );
+	TEST_ASSERT( not big.dump( [&writes]( const char *, size_t ) {
+		++writes;
+		return false;
+	} ) );
+	TEST_ASSERT_EQUAL( writes, 1 );
+	std::ofstream closed;
+	big.dump( closed );
+	TEST_ASSERT( closed.bad() or closed.fail() );
+}
+
+void json_tests::test_case_numbers()
+{
+	std::string err;
+	auto number = [&err]( const char *i_text ) {
+		err.clear();
+		return su::Json::parse( i_text, err );
+	};
+
+	// integer ranges
+	TEST_ASSERT( number( "2147483647" ).is_int() );
+	TEST_ASSERT_EQUAL( number( "2147483648" ).int64_value(), 2147483648LL );
+	TEST_ASSERT( number( "-2147483648" ).is_int() );
+	TEST_ASSERT_EQUAL( number( "-2147483648" ).int_value(), INT32_MIN );
+	TEST_ASSERT_EQUAL( number( "-2147483649" ).int64_value(), -2147483649LL );
+	TEST_ASSERT_EQUAL( number( "9223372036854775807" ).int64_value(), INT64_MAX );
+	TEST_ASSERT_EQUAL( number( "-9223372036854775808" ).int64_value(), INT64_MIN );
+	TEST_ASSERT( number( "9223372036854775808" ).is_double() );
+	TEST_ASSERT_EQUAL( number( "9223372036854775808" ).number_value(), 9223372036854775808.0 );
+	TEST_ASSERT_EQUAL( number( "18446744073709551615" ).number_value(), 18446744073709551615.0 );
+	TEST_ASSERT_EQUAL( number( "123456789012345678901234567890" ).number_value(), 1.2345678901234568e29 );
+
+	// zeros and limits
+	TEST_ASSERT_EQUAL( number( "0e-31" ).number_value(), 0.0 );
+	TEST_ASSERT( err.empty(), err );
+	TEST_ASSERT( std::signbit( number( "-0.0" ).number_value() ) );
+	TEST_ASSERT_EQUAL( number( "1e-400" ).number_value(), 0.0 );
+	TEST_ASSERT_EQUAL( number( "4.9e-324" ).number_value(), 4.9406564584124654e-324 );
+	TEST_ASSERT_EQUAL( number( "2.2250738585072011e-308" ).number_value(), 2.2250738585072009e-308 );
+	TEST_ASSERT_EQUAL( number( "1.7976931348623157e308" ).number_value(), 1.7976931348623157e308 );
+	number( "1.7976931348623159e308" );
+	TEST_ASSERT_EQUAL( err, "number is too big" );
+	number( "1." );
+	TEST_ASSERT_EQUAL( err, "missing fraction for number" );
+	number( "1e+" );
+	TEST_ASSERT_EQUAL( err, "missing exponent for number" );
+
+	// halfway cases, decided past the 19th digit
+	TEST_ASSERT_EQUAL( number( "9007199254740993" ).number_value(), 9007199254740992.0 );
+	TEST_ASSERT_EQUAL( number( "1.00000000000000011102230246251565404236316680908203125" ).number_value(), 1.0 );
+	TEST_ASSERT_EQUAL( number( "1.00000000000000011102230246251565404236316680908203126" ).number_value(), 1.0000000000000002 );
+	TEST_ASSERT_EQUAL( number( "14734741197622.7333942924099077102183164513269040670098850793840369491531857087542871621173854182782518" ).number_value(), 14734741197622.732 );
+
+	// same as strtod, digits parsed 8 at a time or not
+	const char *samples[] = { "3.141592653589793", "0.1", "123456.789e-20", "1.2345678901234567e+300",
+		"0.000000000000000000000000000000012345678", "98765432109876543210.123456789e-5", "5e-324",
+		"2.4703282292062328e-324", "7.2057594037927933e16", "-8.98846567431158e307" };
+	for ( auto s : samples )
+	{
+		TEST_ASSERT_EQUAL( number( s ).number_value(), std::strtod( s, nullptr ) );
+		TEST_ASSERT( err.empty(), err );
+	}
+}
+
+void json_tests::test_case_intern()
+{
+	std::string err;
+	su::JsonInternTable table;
+	auto citm = su::Json::parse( kCITM, err, table );
+	TEST_ASSERT( err.empty(), err );
+	TEST_ASSERT_EQUAL( citm, su::Json::parse( kCITM, err ) );
+	TEST_ASSERT( table.size() > 0 );
+
+	// identical values share their node, within and across documents
+	auto text = R"({"a":{"k":[1,2.5,"a string too long to be inline"]},
+	               "b":{"k":[1,2.5,"a string too long to be inline"]},
+	               "c":{"k":[1,2.5,"a string too long to be inline",null]}})";
+	auto doc = su::Json::parse( text, err, table );
+	TEST_ASSERT( err.empty(), err );
+	TEST_ASSERT_EQUAL( &doc["a"].object_items(), &doc["b"].object_items() );
+	TEST_ASSERT_NOT_EQUAL( &doc["a"].object_items(), &doc["c"].object_items() );
+	TEST_ASSERT_EQUAL( doc["a"]["k"][2].string_view().data(),
+	                   doc["c"]["k"][2].string_view().data() );
+	auto again = su::Json::parse( text, err, table );
+	TEST_ASSERT_EQUAL( &again["c"].object_items(), &doc["c"].object_items() );
+	TEST_ASSERT_EQUAL( &su::Json::parse( "[]", err, table ).array_items(),
+	                   &su::Json::parse( "[ ]", err, table ).array_items() );
+
+	// not the same numbers
+	auto numbers = su::Json::parse( "[[1],[1.0],[-0.0],[0.0]]", err, table );
+	TEST_ASSERT_NOT_EQUAL( &numbers[0].array_items(), &numbers[1].array_items() );
+	TEST_ASSERT_NOT_EQUAL( &numbers[2].array_items(), &numbers[3].array_items() );
+
+	// a change copies the shared value first
+	TEST_ASSERT( doc.mutable_item( "a" )->set( "k", 0 ) );
+	TEST_ASSERT_EQUAL( doc["a"]["k"], su::Json( 0 ) );
+	TEST_ASSERT_EQUAL( doc["b"]["k"].array_items().size(), 3 );
+	TEST_ASSERT_EQUAL( again["a"]["k"].array_items().size(), 3 );
+
+	// the values outlive the table
+	table.clear();
+	TEST_ASSERT_EQUAL( table.size(), 0 );
+	TEST_ASSERT_EQUAL( doc["c"]["k"][2].string_value(), "a string too long to be inline" );
+	su::Json survivor;
+	{
+		su::JsonInternTable scoped( 0 );
+		survivor = su::Json::parse( text, err, scoped );
+		// only the strings are shared
+		TEST_ASSERT_EQUAL( scoped.size(), 1 );
+	}
+	TEST_ASSERT_EQUAL( survivor["b"]["k"][2].string_value(), "a string too long to be inline" );
+}
+
+void json_tests::test_case_path()
+{
+	std::string err;
+	auto twitter = su::Json::parse( kTwitter, err );
+	TEST_ASSERT( err.empty(), err );
+
+	// a wildcard against a plain loop
+	std::vector<int64_t> ids;
+	for ( auto &status : twitter["statuses"].array_items() )
+		ids.push_back( status["user"]["id"].int64_value() );
+	su::JsonPath userIds( "/statuses/*/user/id", err );
+	TEST_ASSERT( userIds.is_valid() and err.empty(), err );
+	TEST_ASSERT_EQUAL( userIds.count( twitter ), ids.size() );
+	auto matches = userIds.select( twitter );
+	TEST_ASSERT_EQUAL( matches.size(), ids.size() );
+	for ( size_t i = 0; i < ids.size(); ++i )
+		TEST_ASSERT_EQUAL( matches[i].int64_value(), ids[i] );
+	TEST_ASSERT_EQUAL( su::JsonPath( "statuses.*.user.id" ).count( twitter ), ids.size() );
+
+	// the same path on a lazy view
+	su::JsonDocumentView doc( kTwitter );
+	size_t i = 0;
+	userIds.for_each( doc.root(), [&]( const su::JsonView &id ) {
+		TEST_ASSERT_EQUAL( id.int64_value(), ids[i] );
+		return ++i < 3;
+	} );
+	TEST_ASSERT_EQUAL( i, 3 );
+
+	// pointers, the hints are reused from one status to the next
+	su::JsonPointer screenName( "/user/screen_name" );
+	for ( auto &status : twitter["statuses"].array_items() )
+	{
+		auto name = screenName.find( status );
+		TEST_ASSERT( name != nullptr );
+		TEST_ASSERT_EQUAL( *name, status["user"]["screen_name"] );
+	}
+	su::JsonPointer first( "/statuses/0/id" );
+	TEST_ASSERT_EQUAL( first.get( twitter ), twitter["statuses"][0]["id"] );
+	TEST_ASSERT_EQUAL( first.find( doc.root() ).int64_value(),
+	                   twitter["statuses"][0]["id"].int64_value() );
+	TEST_ASSERT_EQUAL( su::JsonPointer().find( twitter ), &twitter );
+
+	// RFC 6901 examples
+	auto rfc = su::Json::parse( R"({"foo":["bar","baz"],"":0,"a/b":1,"c%d":2,
+	                              "e^f":3,"g|h":4,"i\\j":5,"k\"l":6," ":7,"m~n":8,"*":9})",
+	                            err );
+	TEST_ASSERT( err.empty(), err );
+	TEST_ASSERT_EQUAL( su::JsonPointer( "/foo/0" ).get( rfc ), su::Json( "bar" ) );
+	TEST_ASSERT_EQUAL( su::JsonPointer( "/" ).get( rfc ), su::Json( 0 ) );
+	TEST_ASSERT_EQUAL( su::JsonPointer( "/a~1b" ).get( rfc ), su::Json( 1 ) );
+	TEST_ASSERT_EQUAL( su::JsonPointer( "/i\\j" ).get( rfc ), su::Json( 5 ) );
+	TEST_ASSERT_EQUAL( su::JsonPointer( "/ " ).get( rfc ), su::Json( 7 ) );
+	TEST_ASSERT_EQUAL( su::JsonPointer( "/m~0n" ).get( rfc ), su::Json( 8 ) );
+	TEST_ASSERT_EQUAL( su::JsonPointer( "/*" ).get( rfc ), su::Json( 9 ) );
+	TEST_ASSERT_EQUAL( su::JsonPath( "/foo/*" ).count( rfc ), 2 );
+	TEST_ASSERT_EQUAL( su::JsonPath( "/*" ).count( rfc ), 11 );
+
+	// missing values and invalid paths match nothing
+	TEST_ASSERT( su::JsonPointer( "/foo/2" ).find( rfc ) == nullptr );
+	TEST_ASSERT( su::JsonPointer( "/foo/01" ).find( rfc ) == nullptr );
+	TEST_ASSERT( su::JsonPointer( "/foo/-" ).find( rfc ) == nullptr );
+	TEST_ASSERT( su::JsonPointer( "/foo/bar" ).find( rfc ) == nullptr );
+	su::JsonPointer bad( "/m~2n", err );
+	TEST_ASSERT( not bad.is_valid() and not err.empty() );
+	TEST_ASSERT( bad.find( rfc ) == nullptr );
+	err.clear();
+	su::JsonPointer relative( "foo", err );
+	TEST_ASSERT( not relative.is_valid() and not err.empty() );
+	TEST_ASSERT( su::JsonPath( "/foo~" ).find_first( rfc ) == nullptr );
+
+	// a null leaf is a match, on a tree and on a view
+	const char *nulls = R"({"s":[{"id":null},{"id":2},{"id":null},{}]})";
+	su::JsonPath sIds( "/s/*/id" );
+	TEST_ASSERT_EQUAL( sIds.count( su::Json::parse( nulls, err ) ), 3 );
+	su::JsonDocumentView nullsDoc( nulls );
+	size_t viewMatches = 0;
+	sIds.for_each( nullsDoc.root(), [&]( const su::JsonView & ) {
+		++viewMatches;
+		return true;
+	} );
+	TEST_ASSERT_EQUAL( viewMatches, 3 );
+	auto nullId = su::JsonPointer( "/s/0/id" ).find( nullsDoc.root() );
+	TEST_ASSERT( nullId.is_null() and not nullId.is_missing() );
+	TEST_ASSERT( su::JsonPointer( "/s/3/id" ).find( nullsDoc.root() ).is_missing() );
+	TEST_ASSERT( su::JsonPointer( "/s/0/id/x" ).find( nullsDoc.root() ).is_missing() );
+	TEST_ASSERT( nullsDoc.root()["nope"].is_missing() and su::JsonView().is_missing() );
+}
+
+namespace {
+
+struct TwitterUser
+{
+	int64_t id = 0;
+	std::string screen_name;
+	std::optional<std::string> url;
+	int followers_count = 0;
+	bool verified = false;
+
+	static constexpr auto json_fields()
+	{
+		return std::make_tuple(
+		    su::json_field( "id", &TwitterUser::id ),
+		    su::json_field( "screen_name", &TwitterUser::screen_name ),
+		    su::json_field( "url", &TwitterUser::url ),
+		    su::json_field( "followers_count", &TwitterUser::followers_count ),
+		    su::json_field( "verified", &TwitterUser::verified ) );
+	}
+};
+
+struct TwitterStatus
+{
+	int64_t id = 0;
+	std::string text;
+	TwitterUser user;
+	double retweet_count = 0;
+	su::Json entities;
+
+	static constexpr auto json_fields()
+	{
+		return std::make_tuple(
+		    su::json_field( "id", &TwitterStatus::id ),
+		    su::json_field( "text", &TwitterStatus::text ),
+		    su::json_field( "user", &TwitterStatus::user ),
+		    su::json_field( "retweet_count", &TwitterStatus::retweet_count ),
+		    su::json_field( "entities", &TwitterStatus::entities ) );
+	}
+};
+
+struct TwitterSearch
+{
+	std::vector<TwitterStatus> statuses;
+	std::map<std::string, su::Json> search_metadata;
+
+	static constexpr auto json_fields()
+	{
+		return std::make_tuple(
+		    su::json_field( "statuses", &TwitterSearch::statuses ),
+		    su::json_field( "search_metadata", &TwitterSearch::search_metadata ) );
+	}
+};
+
+// converts through a Json, like types that already had a to_json()
+struct Point
+{
+	int x = 0, y = 0;
+	Point() = default;
+	explicit Point( const su::Json &i_json ) :
+	    x( i_json[0].int_value() ),
+	    y( i_json[1].int_value() )
+	{
+	}
+	su::Json to_json() const { return su::Json::array{ x, y }; }
+};
+
+// a struct bound from outside
+struct Shape
+{
+	std::string name;
+	std::list<Point> points;
+	std::optional<int> layer;
+};
+
+}
+
+template<>
+struct su::json_binding<Shape>
+{
+	static constexpr auto fields()
+	{
+		return std::make_tuple( su::json_field( "name", &Shape::name ),
+		                        su::json_field( "points", &Shape::points ),
+		                        su::json_field( "layer", &Shape::layer ) );
+	}
+};
+
+void json_tests::test_case_bind()
+{
+	std::string err;
+	TwitterSearch search;
+	TEST_ASSERT( su::json_read( kTwitter, search, err ), err );
+	auto twitter = su::Json::parse( kTwitter, err );
+	TEST_ASSERT( err.empty(), err );
+	auto &statuses = twitter["statuses"].array_items();
+	TEST_ASSERT_EQUAL( search.statuses.size(), statuses.size() );
+	for ( size_t i = 0; i < statuses.size(); ++i )
+	{
+		auto &bound = search.statuses[i];
+		auto &status = statuses[i];
+		TEST_ASSERT_EQUAL( bound.id, status["id"].int64_value() );
+		TEST_ASSERT_EQUAL( bound.text, status["text"].string_value() );
+		TEST_ASSERT_EQUAL( bound.user.id, status["user"]["id"].int64_value() );
+		TEST_ASSERT_EQUAL( bound.user.screen_name, status["user"]["screen_name"].string_value() );
+		TEST_ASSERT_EQUAL( bound.user.url.has_value(), not status["user"]["url"].is_null() );
+		TEST_ASSERT_EQUAL( bound.user.followers_count, status["user"]["followers_count"].int_value() );
+		TEST_ASSERT_EQUAL( bound.user.verified, status["user"]["verified"].bool_value() );
+		TEST_ASSERT_EQUAL( bound.retweet_count, status["retweet_count"].number_value() );
+		TEST_ASSERT_EQUAL( bound.entities, status["entities"] );
+	}
+	TEST_ASSERT_EQUAL( su::Json( search.search_metadata ), twitter["search_metadata"] );
+
+	// and back, through a Json for the comparison
+	auto copy = su::Json::parse( su::json_write( search ), err );
+	TEST_ASSERT( err.empty(), err );
+	TEST_ASSERT_EQUAL( copy["statuses"].array_items().size(), statuses.size() );
+	TEST_ASSERT_EQUAL( copy["statuses"][3]["text"], statuses[3]["text"] );
+	TEST_ASSERT_EQUAL( copy["statuses"][3]["user"]["screen_name"], statuses[3]["user"]["screen_name"] );
+	TEST_ASSERT_EQUAL( copy["statuses"][3]["entities"], statuses[3]["entities"] );
+	TEST_ASSERT_EQUAL( copy["search_metadata"], twitter["search_metadata"] );
+	// empty optionals are left out
+	auto &user = copy["statuses"][0]["user"].object_items();
+	TEST_ASSERT( user.find( "url" ) == user.end() );
+
+	// to_json types, unknown and missing keys
+	Shape shape;
+	shape.layer = 3;
+	TEST_ASSERT( su::json_read( R"( {"points":[[1,2],[3,4]],"color":{"r":[1]},"name":"tri\u00e9"} )",
+	                            shape, err ), err );
+	TEST_ASSERT_EQUAL( shape.name, "tri\xc3\xa9" );
+	TEST_ASSERT_EQUAL( shape.points.size(), 2 );
+	TEST_ASSERT_EQUAL( shape.points.back().y, 4 );
+	TEST_ASSERT_EQUAL( shape.layer.value_or( 0 ), 3 );
+	TEST_ASSERT_EQUAL( su::json_write( shape ),
+	                   std::string( R"({"name":"tri)" ) + "\xc3\xa9" + R"(","points":[[1,2],[3,4]],"layer":3})" );
+	TEST_ASSERT( su::json_read( R"({"layer":null,"points":[]})", shape, err ), err );
+	TEST_ASSERT( not shape.layer.has_value() and shape.points.empty() );
+	TEST_ASSERT_EQUAL( su::json_write( shape ), std::string( R"({"name":"tri)" ) + "\xc3\xa9" + R"(","points":[]})" );
+
+	// plain values
+	std::vector<std::optional<double>> numbers;
+	TEST_ASSERT( su::json_read( "[1, 2.5, null, -1e3]", numbers, err ), err );
+	TEST_ASSERT_EQUAL( su::json_write( numbers ), "[1.0,2.5,null,-1000.0]" );
+	uint64_t big = 0;
+	TEST_ASSERT( su::json_read( "18446744073709549568", big, err ), err );
+	TEST_ASSERT_EQUAL( big, 18446744073709549568ull );
+	TEST_ASSERT_EQUAL( su::json_write( big ), "18446744073709549568" );
+	// above 2^63 the digits are read exactly, not through a double
+	big = std::numeric_limits<uint64_t>::max();
+	TEST_ASSERT( su::json_read( su::json_write( big ), big, err ), err );
+	TEST_ASSERT_EQUAL( big, std::numeric_limits<uint64_t>::max() );
+	TEST_ASSERT( su::json_read( "9223372036854775809", big, err ), err );
+	TEST_ASSERT_EQUAL( big, 9223372036854775809ull );
+	TEST_ASSERT( su::json_read( "1e19", big, err ), err );
+	TEST_ASSERT_EQUAL( big, 10000000000000000000ull );
+	TEST_ASSERT( not su::json_read( "18446744073709551616", big, err ) and not err.empty() );
+	err.clear();
+	TEST_ASSERT( not su::json_read( "-1", big, err ) and not err.empty() );
+	err.clear();
+	int64_t most = 0;
+	TEST_ASSERT( su::json_read( "-9223372036854775808", most, err ), err );
+	TEST_ASSERT_EQUAL( most, std::numeric_limits<int64_t>::min() );
+
+	// errors
+	int small = 0;
+	TEST_ASSERT( not su::json_read( "3000000000", small, err ) and not err.empty() );
+	err.clear();
+	TEST_ASSERT( not su::json_read( "1.5", small, err ) and not err.empty() );
+	err.clear();
+	TEST_ASSERT( not su::json_read( R"({"name":1})", shape, err ) and not err.empty() );
+	err.clear();
+	TEST_ASSERT( not su::json_read( R"({"name":"a",})", shape, err ) and not err.empty() );
+	err.clear();
+	// skipped values are checked too
+	TEST_ASSERT( not su::json_read( R"({"color":{"r":[1,]}})", shape, err ) and not err.empty() );
+	err.clear();
+	TEST_ASSERT( not su::json_read( "[1,2] 3", numbers, err ) and not err.empty() );
+	err.clear();
+	TEST_ASSERT( not su::json_read( "[1,2", numbers, err ) and not err.empty() );
+	err.clear();
+	TEST_ASSERT( su::json_read( "/* c */ [1] // c", numbers, err, su::JsonParse::COMMENTS ), err );
+}
+
+void json_tests::test_case_strings()
+{
+	// special characters at every position of the 16 and 32 bytes blocks
+	const std::pair<std::string, std::string> specials[] = {
+	    { "\"", "\\\"" },
+	    { "\\", "\\\\" },
+	    { "\n", "\\n" },
+	    { std::string( 1, '\0' ), "\\u0000" },
+	    { "\x1f", "\\u001f" },
+	    { "\xe2\x80\xa8", "\\u2028" },
+	    { "\xe2\x80\xa9", "\\u2029" },
+	    { "\xe2\x82\xac", "\xe2\x82\xac" },
+	    { "\x7f", "\x7f" } };
+	std::string err;
+	for ( auto &special : specials )
+	{
+		for ( size_t i = 0; i < 70; ++i )
+		{
+			std::string value( i, 'a' );
+			value += special.first;
+			value.append( 70 - i, 'b' );
+			std::string expected( "\"" + std::string( i, 'a' ) );
+			expected += special.second;
+			expected.append( 70 - i, 'b' );
+			expected += '"';
+			auto dumped = su::Json( value ).dump();
+			TEST_ASSERT_EQUAL( dumped, expected );
+			TEST_ASSERT_EQUAL( su::Json( value ).dump_size(), expected.size() );
+			TEST_ASSERT_EQUAL( su::Json::parse( dumped, err ).string_value(), value );
+			TEST_ASSERT( err.empty(), err );
+		}
+	}
+
+	// unescaped control characters and unterminated strings
+	for ( size_t i = 0; i < 40; ++i )
+	{
+		std::string text( "\"" + std::string( i, 'x' ) );
+		su::Json::parse( text + "\t\"", err );
+		TEST_ASSERT( not err.empty() );
+		err.clear();
+		su::Json::parse( text, err );
+		TEST_ASSERT( not err.empty() );
+		err.clear();
+	}
+
+	// longer than the parser's buffer
+	std::string big( 5000, 'z' );
+	big[4000] = '\n';
+	TEST_ASSERT_EQUAL( su::Json::parse( su::Json( big ).dump(), err ).string_value(), big );
+}
+
+void json_tests::test_case_hash()
+{
+	// consistent with operator==
+	TEST_ASSERT_EQUAL( su::Json( 1 ).hash(), su::Json( 1.0 ).hash() );
+	TEST_ASSERT_EQUAL( su::Json( int64_t( 1 ) << 40 ).hash(),
+	                   su::Json( double( int64_t( 1 ) << 40 ) ).hash() );
+	TEST_ASSERT_EQUAL( su::Json( 0.0 ).hash(), su::Json( -0.0 ).hash() );
+	std::string err;
+	auto parsed = su::Json::parse(
+	    R"({"b":[1,"a long string, not inline",{"c":null}],"a":true})", err );
+	auto built = su::Json( su::Json::object{
+	    { "a", true },
+	    { "b",
+	      su::Json::array{ 1.0,
+	                       std::string( "a long string, not inline" ),
+	                       su::Json::object{ { "c", nullptr } } } } } );
+	TEST_ASSERT( parsed == built );
+	TEST_ASSERT_EQUAL( parsed.hash(), built.hash() );
+	TEST_ASSERT( parsed.hash() != su::Json::parse( R"({"a":true})", err ).hash() );
+
+	std::unordered_set<su::Json> set{ parsed, built, su::Json( "x" ), su::Json( 1 ) };
+	TEST_ASSERT_EQUAL( set.size(), 3 );
+	TEST_ASSERT( set.find( su::Json( 1.0 ) ) != set.end() );
+
+	// large objects are indexed on first lookup
+	su::Json::object items;
+	for ( int i = 0; i < 1000; ++i )
+		items["key" + std::to_string( i )] = i;
+	su::Json big( items );
+	auto copy = big;
+	for ( int i = 0; i < 1000; ++i )
+		TEST_ASSERT_EQUAL( big["key" + std::to_string( i )].int_value(), i );
+	TEST_ASSERT( big["key1000"].is_null() );
+	TEST_ASSERT( big[""].is_null() );
+
+	// the copy shares the index until it changes
+	TEST_ASSERT( copy.set( "new", "value" ) );
+	TEST_ASSERT( copy.erase( "key10" ) );
+	TEST_ASSERT_EQUAL( copy["new"].string_value(), "value" );
+	TEST_ASSERT( copy["key10"].is_null() );
+	TEST_ASSERT_EQUAL( copy["key11"].int_value(), 11 );
+	TEST_ASSERT_EQUAL( big["key10"].int_value(), 10 );
+	TEST_ASSERT( big["new"].is_null() );
+	*copy.mutable_item( "key999" ) = -1;
+	TEST_ASSERT_EQUAL( copy["key999"].int_value(), -1 );
+	TEST_ASSERT( copy.erase( "new" ) );
+	TEST_ASSERT( copy.set( "key10", 10 ) );
+	TEST_ASSERT( copy != big );
+	TEST_ASSERT( copy.set( "key999", 999 ) );
+	TEST_ASSERT( copy == big );
+	TEST_ASSERT_EQUAL( copy.hash(), big.hash() );
+
+	// from several threads at once
+	auto shared = su::Json::parse( big.dump(), err );
+	std::vector<std::thread> threads;
+	std::atomic<int> errors{ 0 };
+	for ( int t = 0; t < 4; ++t )
+	{
+		threads.emplace_back( [&shared, &errors, t] {
+			for ( int i = t; i < 1000; i += 4 )
+			{
+				if ( shared["key" + std::to_string( i )].int_value() != i )
+					++errors;
+			}
+		} );
+	}
+	for ( auto &thread : threads )
+		thread.join();
+	TEST_ASSERT_EQUAL( errors.load(), 0 );
+	TEST_ASSERT( shared == big );
+}
+
+void json_tests::test_case_memory()
+{
+	// inline values hold nothing
+	TEST_ASSERT_EQUAL( su::Json( 12.5 ).memory_usage(), 0 );
+	TEST_ASSERT_EQUAL( su::Json( "short" ).memory_usage(), 0 );
+	auto s = su::Json( std::string( 100, 'x' ) ).memory_breakdown();
+	TEST_ASSERT_EQUAL( s.nodes, 1 );
+	TEST_ASSERT( s.string_bytes >= 101 );
+	TEST_ASSERT_EQUAL( s.shared_bytes, 0 );
+
+	// growing leaves slack behind
+	su::Json array;
+	for ( int i = 0; i < 100; ++i )
+		array.push_back( std::string( 20, 'a' + ( i % 26 ) ) );
+	su::Json doc( su::Json::object{ { "items", array } } );
+	array.clear();
+	auto before = doc.memory_breakdown();
+	TEST_ASSERT_EQUAL( before.nodes, 102 );
+	TEST_ASSERT_EQUAL( before.container_bytes,
+	                   100 * sizeof( su::Json ) +
+	                       sizeof( su::Json::object::value_type ) );
+	TEST_ASSERT( before.slack_bytes > 0 );
+	TEST_ASSERT_EQUAL( before.shared_bytes, 0 );
+	auto copy = doc;
+	TEST_ASSERT_EQUAL( doc.shrink_to_fit(), 0 );
+	TEST_ASSERT_EQUAL( doc.memory_breakdown().shared_bytes, before.total() );
+	copy.clear();
+	auto released = doc.shrink_to_fit();
+	TEST_ASSERT_EQUAL( released, before.slack_bytes );
+	auto after = doc.memory_breakdown();
+	TEST_ASSERT_EQUAL( after.slack_bytes, 0 );
+	TEST_ASSERT_EQUAL( after.total(), before.total() - released );
+	TEST_ASSERT_EQUAL( doc["items"].array_items().size(), 100 );
+	TEST_ASSERT_EQUAL( doc["items"][27].string_value(), std::string( 20, 'b' ) );
+
+	// a node reachable twice is counted once, shared only if referenced
+	// from outside
+	std::string err;
+	auto item = su::Json::parse( R"({"name":"a long enough string value"})", err );
+	auto itemSize = item.memory_usage();
+	su::Json twice( su::Json::array{ item, item } );
+	auto usage = twice.memory_breakdown();
+	TEST_ASSERT_EQUAL( usage.total(),
+	                   itemSize +
+	                       su::Json( su::Json::array{ 1, 2 } ).memory_usage() );
+	TEST_ASSERT_EQUAL( usage.shared_bytes, itemSize );
+	item.clear();
+	TEST_ASSERT_EQUAL( twice.memory_breakdown().shared_bytes, 0 );
+	TEST_ASSERT_EQUAL( twice.memory_usage(), usage.total() );
+
+	// parsed documents have no slack
+	auto citm = su::Json::parse( kCITM, err );
+	TEST_ASSERT( err.empty(), err );
+	auto parsed = citm.memory_breakdown();
+	TEST_ASSERT_EQUAL( parsed.slack_bytes, 0 );
+	TEST_ASSERT_EQUAL( citm.shrink_to_fit(), 0 );
+	su::JsonInternTable table;
+	auto interned = su::Json::parse( kCITM, err, table );
+	TEST_ASSERT( interned.memory_usage() < parsed.total() / 2 );
+}
+
+void json_tests::test_case_parse_file()
+{
+	std::string err;
+	for ( auto prefetch : { false, true } )
+	{
+		auto json = su::Json::parse_file(
+		    su::resource_access::get( "citm_catalog.json" ), err,
+		    su::JsonParse::STANDARD, prefetch );
+		TEST_ASSERT( err.empty(), err );
+		TEST_ASSERT( json == su::Json::parse( kCITM, err ) );
+	}
+
+	// a number up to the end of a file of exactly one page, the parser looks
+	// one byte past it
+	su::filepath path( su::filepath::location::kNewTempSpec );
+	{
+		std::ofstream f;
+		path.fsopen( f );
+		f << std::string( 4096 - 6, ' ' ) << "123456";
+	}
+	TEST_ASSERT_EQUAL( su::Json::parse_file( path, err ).int_value(), 123456 );
+	TEST_ASSERT( err.empty(), err );
+	{
+		std::ofstream f;
+		path.fsopen( f );
+	}
+	su::Json::parse_file( path, err );
+	TEST_ASSERT( not err.empty() );
+	err.clear();
+	path.unlink();
+	TEST_ASSERT( su::Json::parse_file( path, err ).is_null() );
+	TEST_ASSERT( not err.empty() );
+	err.clear();
+
+	// views keep the mapping alive
+	su::JsonView view;
+	{
+		su::JsonDocumentView doc( su::resource_access::get( "twitter.json" ), err );
+		TEST_ASSERT( err.empty(), err );
+		view = doc["statuses"];
+	}
+	std::string buffer;
+	TEST_ASSERT_EQUAL( view.size(), 100 );
+	TEST_ASSERT_EQUAL( view[0]["user"]["screen_name"].string_value( buffer ),
+	                   "ayuu0123" );
+	su::JsonDocumentView missing( path, err );
+	TEST_ASSERT( not err.empty() );
+	TEST_ASSERT( missing.root().is_null() );
+}